@@ -37,7 +37,9 @@ JNIEXPORT void
 JNICALL
 Java_com_ollix_moui_View_handleEventFromJNI(
     JNIEnv* env, jobject, jlong moui_view_ptr, jint action,
-    jfloatArray raw_locations) {
+    jfloatArray raw_locations, jintArray raw_pointer_ids, jlong event_time,
+    jfloatArray raw_historical_locations, jlongArray raw_historical_times,
+    jlong uptime) {
   // Converts the received MotionEvent action to moui event type.
   moui::Event::Type event_type;
   switch (action) {
@@ -52,16 +54,48 @@ Java_com_ollix_moui_View_handleEventFromJNI(
     default:
       event_type = moui::Event::Type::kUnknown;
   }
+  // Converts the event times in milliseconds of the system uptime to the time
+  // base of `moui::Clock`.
+  const double kTimeOffset = moui::Clock::GetTimestamp() - uptime / 1000.0;
+
   // Initializes the event object and asks moui view to handle the event.
-  moui::Event moui_event(event_type);
+  auto moui_view = reinterpret_cast<moui::View*>(moui_view_ptr);
+  moui::Event* moui_event = moui_view->platform_event();
+  moui_event->Reset(event_type, kTimeOffset + event_time / 1000.0);
   const int kNumberOfLocations = \
       static_cast<int>(env->GetArrayLength(raw_locations)) / 2;
   jfloat* locations = env->GetFloatArrayElements(raw_locations, 0);
+  jint* pointer_ids = env->GetIntArrayElements(raw_pointer_ids, 0);
   for (int i = 0; i < kNumberOfLocations; ++i) {
-    moui_event.locations()->push_back({*locations++, *locations++});
+    moui_event->locations()->push_back({locations[i * 2],
+                                        locations[i * 2 + 1]});
+    moui_event->pointer_ids()->push_back(pointer_ids[i]);
   }
-  auto moui_view = reinterpret_cast<moui::View*>(moui_view_ptr);
-  moui_view->HandleEvent(&moui_event);
+
+  // Adds the samples batched into the MotionEvent as historical samples.
+  const int kHistorySize = \
+      static_cast<int>(env->GetArrayLength(raw_historical_times));
+  jfloat* historical_locations = \
+      env->GetFloatArrayElements(raw_historical_locations, 0);
+  jlong* historical_times = env->GetLongArrayElements(raw_historical_times, 0);
+  for (int h = 0; h < kHistorySize; ++h) {
+    const double kTimestamp = kTimeOffset + historical_times[h] / 1000.0;
+    for (int i = 0; i < kNumberOfLocations; ++i) {
+      const int kIndex = (h * kNumberOfLocations + i) * 2;
+      moui_event->historical_samples()->push_back(
+          {pointer_ids[i],
+           {historical_locations[kIndex], historical_locations[kIndex + 1]},
+           kTimestamp});
+    }
+  }
+  env->ReleaseFloatArrayElements(raw_locations, locations, JNI_ABORT);
+  env->ReleaseIntArrayElements(raw_pointer_ids, pointer_ids, JNI_ABORT);
+  env->ReleaseFloatArrayElements(raw_historical_locations,
+                                 historical_locations, JNI_ABORT);
+  env->ReleaseLongArrayElements(raw_historical_times, historical_times,
+                                JNI_ABORT);
+
+  moui_view->HandleEvent(moui_event);
 }
 
 JNIEXPORT void
@@ -115,9 +115,31 @@ abstract class View(context: Context, mouiViewPtr: Long)
             return false
         }
 
+        /** Populates the pointer identifiers and the historical samples. */
+        val pointerIds = IntArray(event.pointerCount)
+        for (i in 0 until event.pointerCount) {
+            pointerIds[i] = event.getPointerId(i)
+        }
+        val historicalTimes = LongArray(event.historySize)
+        val historicalLocations =
+                FloatArray(event.historySize * event.pointerCount * 2)
+        index = 0
+        for (h in 0 until event.historySize) {
+            historicalTimes[h] = event.getHistoricalEventTime(h)
+            for (i in 0 until event.pointerCount) {
+                val x = event.getHistoricalX(i, h) + coords[0]
+                val y = event.getHistoricalY(i, h) + coords[1]
+                historicalLocations[index++] = x / displayDensity
+                historicalLocations[index++] = y / displayDensity
+            }
+        }
+
         handlingEvent = true
         /** Handles the event in corresponded moui view. */
-        handleEventFromJNI(mouiViewPtr, event.getAction(), locations)
+        handleEventFromJNI(mouiViewPtr, event.getAction(), locations,
+                           pointerIds, event.getEventTime(),
+                           historicalLocations, historicalTimes,
+                           SystemClock.uptimeMillis())
         /** Resets `handlingEvent` if the action is complete. */
         if (event.getAction() == MotionEvent.ACTION_UP ||
                 event.getAction() == MotionEvent.ACTION_CANCEL) {
@@ -237,7 +259,12 @@ abstract class View(context: Context, mouiViewPtr: Long)
 
     external fun handleEventFromJNI(mouiViewPtr: Long,
                                     action: Int,
-                                    locations: FloatArray)
+                                    locations: FloatArray,
+                                    pointerIds: IntArray,
+                                    eventTime: Long,
+                                    historicalLocations: FloatArray,
+                                    historicalTimes: LongArray,
+                                    uptime: Long)
 
     external fun shouldHandleEventFromJNI(mouiViewPtr: Long,
                                           x: Float,
@@ -24,6 +24,7 @@
 #include "jni.h"  // NOLINT
 
 #include "moui/core/base_application.h"
+#include "moui/core/clock.h"
 #include "moui/core/device.h"
 #include "moui/core/path.h"
 
@@ -55,6 +56,7 @@ void Application::InitJNI(JNIEnv* env, jobject activity,
   aasset_init(AAssetManager_fromJava(env, asset_manager));
 
   // Initializes classes.
+  Clock::Init();
   Device::Init();
   Path::Init();
 }
@@ -17,76 +17,40 @@
 
 #include "moui/core/clock.h"
 
-#include <functional>
-#include <map>
+#include <android/looper.h>
 
-#include "jni.h"  // NOLINT
-
-#include "moui/core/application.h"
 #include "moui/core/log.h"
+#include "moui/core/timer_queue.h"
 
 namespace {
 
-std::map<JNIEnv*, jobject> global_clocks;
-
-jobject GetJavaClock(JNIEnv* env) {
-  auto match = global_clocks.find(env);
-  if (match != global_clocks.end()) {
-    return match->second;
-  }
-  jclass clock_class = env->FindClass("com/ollix/moui/Clock");
-  jmethodID constructor = env->GetMethodID(clock_class, "<init>", "()V");
-  jobject clock_obj = env->NewObject(clock_class, constructor);
-  jobject global_clock = env->NewGlobalRef(clock_obj);
-  env->DeleteLocalRef(clock_class);
-  env->DeleteLocalRef(clock_obj);
-  global_clocks[env] = global_clock;
-  return global_clock;
+// Fires the due callbacks of the main thread timer queue when its wakeup
+// descriptor becomes readable. Returns 1 to keep receiving events.
+int FireMainThreadTimers(int fd, int events, void* data) {
+  auto queue = reinterpret_cast<moui::TimerQueue*>(data);
+  queue->FireDueTimers(moui::TimerQueue::GetCurrentTimestamp());
+  return 1;
 }
 
 }  // namespace
 
 namespace moui {
 
-void Clock::DispatchAfter(const float delay, std::function<void()> func) {
-  JNIEnv* env = Application::GetJNIEnv();
-  jobject java_clock = GetJavaClock(env);
-  jclass clock_class = env->GetObjectClass(java_clock);
-  jmethodID java_method = env->GetMethodID(
-      clock_class, "dispatchAfter", "(FJ)V");
-  env->DeleteLocalRef(clock_class);
-  env->CallVoidMethod(java_clock, java_method, delay,
-                      reinterpret_cast<jlong>(new Callback{func}));
-}
-
-void Clock::ExecuteCallbackOnMainThread(const float delay,
-                                        std::function<void()> func) {
-  JNIEnv* env = Application::GetJNIEnv();
-  jobject java_clock = GetJavaClock(env);
-  jclass clock_class = env->GetObjectClass(java_clock);
-  jmethodID java_method = env->GetMethodID(
-      clock_class, "executeCallbackOnMainThread", "(FJ)V");
-  env->DeleteLocalRef(clock_class);
-  env->CallVoidMethod(java_clock, java_method, delay,
-                      reinterpret_cast<jlong>(new Callback{func}));
-}
-
-void Clock::ExecuteCallbackOnMainThread(std::function<void()> callback) {
-  ExecuteCallbackOnMainThread(0, callback);
-}
-
-void Clock::Reset() {
-  for (auto& pair : global_clocks) {
-    JNIEnv* env = Application::GetJNIEnv();
-    jobject global_clock = pair.second;
-    jclass clock_class = env->GetObjectClass(global_clock);
-    jmethodID java_method = env->GetMethodID(
-        clock_class, "cancel", "()V");
-    env->DeleteLocalRef(clock_class);
-    env->CallVoidMethod(global_clock, java_method);
-    env->DeleteGlobalRef(global_clock);
+void Clock::Init() {
+  static ALooper* registered_looper = nullptr;
+  ALooper* looper = ALooper_forThread();
+  if (looper == nullptr) {
+    MO_LOG("Clock::Init() must be called on a looper thread.");
+    return;
   }
-  global_clocks.clear();
+  if (looper == registered_looper)
+    return;
+  TimerQueue* queue = GetMainThreadTimerQueue();
+  if (registered_looper != nullptr)
+    ALooper_removeFd(registered_looper, queue->wakeup_fd());
+  ALooper_addFd(looper, queue->wakeup_fd(), ALOOPER_POLL_CALLBACK,
+                ALOOPER_EVENT_INPUT, FireMainThreadTimers, queue);
+  registered_looper = looper;
 }
 
 }  // namespace moui
@@ -20,40 +20,91 @@
 #include <dispatch/dispatch.h>
 #import <Foundation/Foundation.h>
 #include <functional>
+#include <map>
+#include <mutex>  // NOLINT
 
 namespace {
 
 dispatch_queue_t queue = dispatch_get_global_queue(
     DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 
-}  // namespace
+// The handle of the last scheduled callback.
+moui::Clock::Handle last_handle = 0;
 
-namespace moui {
+// The blocks of the scheduled callbacks that have not executed yet, keyed by
+// their handles.
+std::map<moui::Clock::Handle, dispatch_block_t> pending_blocks;
+
+// Guards `last_handle` and `pending_blocks`.
+std::mutex pending_blocks_mutex;
 
-void Clock::DispatchAfter(const float delay, std::function<void()> callback) {
+// Executes the callback on the dispatch queue after the delay in seconds as a
+// cancelable block. Returns the handle of the callback.
+moui::Clock::Handle DispatchCancelableAfter(const float delay,
+                                            dispatch_queue_t dispatch_queue,
+                                            std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(pending_blocks_mutex);
+  const moui::Clock::Handle kHandle = ++last_handle;
+  dispatch_block_t block = dispatch_block_create(
+      static_cast<dispatch_block_flags_t>(0), ^{
+        {
+          // The block may already be running when it gets cancelled, in
+          // which case its handle is no longer pending.
+          std::lock_guard<std::mutex> lock(pending_blocks_mutex);
+          if (pending_blocks.erase(kHandle) == 0)
+            return;
+        }
+        callback();
+      });
+  pending_blocks[kHandle] = block;
   const dispatch_time_t kWhen = dispatch_time(DISPATCH_TIME_NOW,
                                               delay * NSEC_PER_SEC);
-  dispatch_after(kWhen, queue, ^{ callback(); });
+  dispatch_after(kWhen, dispatch_queue, block);
+  return kHandle;
+}
+
+}  // namespace
+
+namespace moui {
+
+bool Clock::CancelCallback(const Handle handle) {
+  std::lock_guard<std::mutex> lock(pending_blocks_mutex);
+  auto match = pending_blocks.find(handle);
+  if (match == pending_blocks.end())
+    return false;
+  dispatch_block_cancel(match->second);
+  pending_blocks.erase(match);
+  return true;
+}
+
+Clock::Handle Clock::DispatchAfter(const float delay,
+                                   std::function<void()> callback) {
+  return DispatchCancelableAfter(delay, queue, callback);
 }
 
-void Clock::ExecuteCallbackOnMainThread(const float delay,
-                                        std::function<void()> callback) {
+Clock::Handle Clock::ExecuteCallbackOnMainThread(
+    const float delay, std::function<void()> callback) {
   if ([NSThread isMainThread] && delay <= 0) {
     callback();
   } else if (delay > 0) {
-    const dispatch_time_t kWhen = dispatch_time(DISPATCH_TIME_NOW,
-                                                delay * NSEC_PER_SEC);
-    dispatch_after(kWhen, dispatch_get_main_queue(), ^{ callback(); });
+    return DispatchCancelableAfter(delay, dispatch_get_main_queue(),
+                                   callback);
   } else {
     dispatch_sync(dispatch_get_main_queue(), ^{ callback(); });
   }
+  return 0;
 }
 
-void Clock::ExecuteCallbackOnMainThread(std::function<void()> callback) {
-  ExecuteCallbackOnMainThread(0, callback);
+Clock::Handle Clock::ExecuteCallbackOnMainThread(
+    std::function<void()> callback) {
+  return ExecuteCallbackOnMainThread(0, callback);
 }
 
 void Clock::Reset() {
+  std::lock_guard<std::mutex> lock(pending_blocks_mutex);
+  for (auto& pair : pending_blocks)
+    dispatch_block_cancel(pair.second);
+  pending_blocks.clear();
 }
 
 }  // namespace moui
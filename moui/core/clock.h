@@ -23,46 +23,90 @@
 #include <utility>
 
 #include "moui/base.h"
+#include "moui/core/timer_queue.h"
 
 namespace moui {
 
 // The `Clock` class is used to schedule function calls. It is designed as a
 // place for static class methods so don't try instantiating this class.
+// On Android and Linux, scheduled callbacks are kept in native `TimerQueue`
+// instances so scheduling never crosses JNI.
 class Clock {
  public:
-  struct Callback {
-    std::function<void()> func;
-  };
+  // Identifies a scheduled callback that can be passed to `CancelCallback()`.
+  // 0 never identifies a callback.
+  typedef TimerQueue::Handle Handle;
 
   Clock() {}
   ~Clock() {}
 
-  // Executes the `callback` function at the specified `delay` time in seconds.
-  static void DispatchAfter(const float delay, std::function<void()> callback);
+  // Cancels the scheduled callback of the specified handle. Returns `false`
+  // if the callback already executed or was cancelled.
+  static bool CancelCallback(const Handle handle);
+
+  // Executes the `callback` function at the specified `delay` time in seconds
+  // on a background thread. Returns the handle of the callback.
+  static Handle DispatchAfter(const float delay,
+                              std::function<void()> callback);
 
   // Executes the specified callback on the main thread with a delay time
-  // in seconds.
-  static void ExecuteCallbackOnMainThread(const float delay,
-                                          std::function<void()> callback);
+  // in seconds. Returns the handle of the callback, or 0 if the callback
+  // already executed synchronously.
+  static Handle ExecuteCallbackOnMainThread(const float delay,
+                                            std::function<void()> callback);
 
   // Executes the specified callback on the main thread.
-  static void ExecuteCallbackOnMainThread(std::function<void()> callback);
+  static Handle ExecuteCallbackOnMainThread(std::function<void()> callback);
+
+#if defined(MOUI_ANDROID) || defined(MOUI_LINUX)
+  // Returns the queue of the callbacks executed on the main thread. On
+  // Android, `Init()` registers the queue's `wakeup_fd()` with the main
+  // looper. On Linux, the main loop must poll the descriptor and call
+  // `FireDueTimers()` with `TimerQueue::GetCurrentTimestamp()` when it
+  // becomes readable.
+  static TimerQueue* GetMainThreadTimerQueue();
+#endif  // MOUI_ANDROID || MOUI_LINUX
 
   // Returns a time point representing the current point in time. The time
   // point is not related to wall clock time and cannot decrease as physical
   // time moves forward. It is best suitable for measuring intervals.
   // In addition, the time point is represented in seconds but is accurate to
-  // nanoseconds.
+  // nanoseconds. The virtual timestamp is returned instead if one is set by
+  // `SetVirtualTimestamp()`.
   static double GetTimestamp() {
+    const double kVirtualTimestamp = *virtual_timestamp();
+    if (kVirtualTimestamp >= 0)
+      return kVirtualTimestamp;
     static auto start = std::chrono::steady_clock::now();
     return std::chrono::duration<double>(
         std::chrono::steady_clock::now() - start).count();
   }
 
-  // Resets the clock.
+#ifdef MOUI_ANDROID
+  // Registers the main thread timer queue with the looper of the calling
+  // thread, which must be the main thread.
+  static void Init();
+#endif  // MOUI_ANDROID
+
+  // Resets the clock and cancels all scheduled callbacks.
   static void Reset();
 
+  // Makes `GetTimestamp()` return the specified timestamp instead of the
+  // current point in time, so time-dependent code such as animations behaves
+  // deterministically when replaying recorded input. A negative value
+  // switches back to the real time.
+  static void SetVirtualTimestamp(const double timestamp) {
+    *virtual_timestamp() = timestamp;
+  }
+
  private:
+  // Returns the storage of the virtual timestamp. The stored value is
+  // negative if no virtual timestamp is set.
+  static double* virtual_timestamp() {
+    static double timestamp = -1;
+    return &timestamp;
+  }
+
   DISALLOW_COPY_AND_ASSIGN(Clock);
 };
 
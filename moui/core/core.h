@@ -22,7 +22,11 @@
 #include "moui/core/clock.h"
 #include "moui/core/device.h"
 #include "moui/core/event.h"
+#include "moui/core/input_recording.h"
+#include "moui/core/latency_histogram.h"
 #include "moui/core/log.h"
 #include "moui/core/path.h"
+#include "moui/core/timer_queue.h"
+#include "moui/core/touch_predictor.h"
 
 #endif  // MOUI_CORE_CORE_H_
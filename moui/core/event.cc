@@ -17,12 +17,66 @@
 
 #include "moui/core/event.h"
 
+#include <vector>
+
+#include "moui/core/clock.h"
+
 namespace moui {
 
-Event::Event(const Type type) : type_(type) {
+Event::Event(const Type type) : Event(type, Clock::GetTimestamp()) {
+}
+
+Event::Event(const Type type, const double timestamp)
+    : scroll_delta_({0, 0}), scroll_phase_(ScrollPhase::kNone),
+      timestamp_(timestamp), type_(type) {
 }
 
 Event::~Event() {
 }
 
+void Event::Coalesce(const Event& event) {
+  for (int i = 0; i < static_cast<int>(locations_.size()); ++i)
+    historical_samples_.push_back({GetPointerId(i), locations_[i], timestamp_});
+  historical_samples_.insert(historical_samples_.end(),
+                             event.historical_samples_.begin(),
+                             event.historical_samples_.end());
+  locations_ = event.locations_;
+  pointer_ids_ = event.pointer_ids_;
+  predicted_locations_ = event.predicted_locations_;
+  timestamp_ = event.timestamp_;
+}
+
+int Event::GetPointerId(const int index) const {
+  if (index < static_cast<int>(pointer_ids_.size()))
+    return pointer_ids_[index];
+  return index;
+}
+
+bool Event::GetSamples(const int pointer_id,
+                       std::vector<Sample>* samples) const {
+  samples->clear();
+  for (const Sample& sample : historical_samples_) {
+    if (sample.pointer_id == pointer_id)
+      samples->push_back(sample);
+  }
+  for (int i = 0; i < static_cast<int>(locations_.size()); ++i) {
+    if (GetPointerId(i) == pointer_id) {
+      samples->push_back({pointer_id, locations_[i], timestamp_});
+      return true;
+    }
+  }
+  return false;
+}
+
+void Event::Reset(const Type type, const double timestamp) {
+  historical_samples_.clear();
+  locations_.clear();
+  pointer_ids_.clear();
+  predicted_locations_.clear();
+  scroll_delta_ = {0, 0};
+  scroll_phase_ = ScrollPhase::kNone;
+  timestamp_ = timestamp;
+  type_ = type;
+}
+
 }  // namespace moui
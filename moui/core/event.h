@@ -24,6 +24,28 @@
 
 namespace moui {
 
+// An event carries the locations of all pointers at the time it happened.
+// Platforms sampling pointers faster than the display refreshes may deliver
+// several samples in one event, and `WidgetView` coalesces consecutive moves
+// into a single event per refresh cycle. The locations replaced by later ones
+// are kept in order as historical samples, so every sample is still
+// available without handling an event for each of them.
+//
+// Scroll events of `Type::kScroll` come from mouse wheels and trackpads.
+// They carry the location of the cursor as their single location, the
+// displacement the content under the cursor should move by, and the phase
+// of the scroll gesture they belong to.
+//
+// Hover events carry the location of the cursor moving over the view while
+// no button is pressed. Platforms report the cursor entering, moving over and
+// leaving the view, and `WidgetView` reports the same to the widgets under
+// the cursor.
+//
+// All timestamps are represented in seconds in the time base of
+// `Clock::GetTimestamp()`.
+//
+// Events are delivered on hot paths, so platforms and widget views reuse
+// event objects by `Reset()` rather than creating one for each event.
 class Event {
  public:
   // The available event types.
@@ -33,22 +55,119 @@ class Event {
     kMove,
     kUp,
     kCancel,
+    // Scroll wheel events
+    kScroll,
+    // Hover events
+    kHoverEnter,
+    kHoverMove,
+    kHoverLeave,
     kUnknown,
   };
 
+  // The phases of a scroll event.
+  enum class ScrollPhase {
+    // The event comes from a mouse wheel that scrolls in discrete steps, which
+    // has no phases.
+    kNone,
+    // The fingers touched the trackpad.
+    kBegan,
+    // The fingers moved on the trackpad.
+    kChanged,
+    // The fingers left the trackpad. Events in the `kMomentum` phase may
+    // follow.
+    kEnded,
+    // The scrolling continues by momentum after the fingers left.
+    kMomentum,
+    // The momentum scrolling ended.
+    kMomentumEnded,
+  };
+
+  // A location of a pointer sampled before the event's `locations()`.
+  struct Sample {
+    // The identifier of the pointer.
+    int pointer_id;
+    // The location of the pointer in the view.
+    Point location;
+    // The timestamp the location was sampled at.
+    double timestamp;
+  };
+
+  // Initializes an event happened at the current time.
   explicit Event(const Type type);
+
+  // Initializes an event happened at the specified timestamp.
+  Event(const Type type, const double timestamp);
+
   ~Event();
 
-  // Accessors.
+  // Merges the passed event that happened later into this event. The current
+  // locations of this event become historical samples, followed by the
+  // historical samples of the passed event, and the locations, pointer
+  // identifiers, predicted locations and timestamp are replaced by those of
+  // the passed event.
+  void Coalesce(const Event& event);
+
+  // Returns the identifier of the pointer at the specified index of
+  // `locations()`. The index itself is returned if no identifier was given.
+  int GetPointerId(const int index) const;
+
+  // Populates `samples` with all samples of the specified pointer ordered
+  // from the oldest, including its current location. Returns `false` if the
+  // pointer is not in the event.
+  bool GetSamples(const int pointer_id, std::vector<Sample>* samples) const;
+
+  // Reinitializes the event as a new event of the specified type happened at
+  // the specified timestamp. The storage of the pointers and samples is kept,
+  // so reusing an event for the same number of pointers allocates no memory.
+  void Reset(const Type type, const double timestamp);
+
+  // Accessors and setters.
+  std::vector<Sample>* historical_samples() { return &historical_samples_; }
   std::vector<Point>* locations() { return &locations_; }
+  std::vector<int>* pointer_ids() { return &pointer_ids_; }
+  std::vector<Point>* predicted_locations() { return &predicted_locations_; }
+  Point scroll_delta() const { return scroll_delta_; }
+  void set_scroll_delta(const Point scroll_delta) {
+    scroll_delta_ = scroll_delta;
+  }
+  ScrollPhase scroll_phase() const { return scroll_phase_; }
+  void set_scroll_phase(const ScrollPhase scroll_phase) {
+    scroll_phase_ = scroll_phase;
+  }
+  double timestamp() const { return timestamp_; }
+  void set_timestamp(const double timestamp) { timestamp_ = timestamp; }
   Type type() const { return type_; }
 
  private:
+  // The samples of all pointers replaced by later locations. Samples of the
+  // same pointer are ordered from the oldest.
+  std::vector<Sample> historical_samples_;
+
   // The locations in a View occurred for a mouse or touch based event.
   std::vector<Point> locations_;
 
+  // The identifiers of the pointers corresponded to `locations_`. The vector
+  // could be empty if the platform does not identify pointers.
+  std::vector<int> pointer_ids_;
+
+  // The estimated locations of the pointers corresponded to `locations_` at
+  // the time the frame reflecting the event is presented. The vector is empty
+  // unless `WidgetView::predicts_touches()` is `true`.
+  std::vector<Point> predicted_locations_;
+
+  // The displacement in points the content under the cursor should move by
+  // for a scroll event. Positive values move the content rightward and
+  // downward.
+  Point scroll_delta_;
+
+  // The phase of the scroll gesture a scroll event belongs to.
+  ScrollPhase scroll_phase_;
+
+  // The timestamp the event happened at.
+  double timestamp_;
+
   // The type of the event.
-  const Type type_;
+  Type type_;
 
   DISALLOW_COPY_AND_ASSIGN(Event);
 };
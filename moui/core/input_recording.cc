@@ -0,0 +1,205 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/core/input_recording.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+
+namespace {
+
+// The bytes every recording file starts with.
+const char kMagic[4] = {'M', 'O', 'I', 'R'};
+// The version of the recording format.
+const uint32_t kVersion = 3;
+
+// Reads a value of the specified type from the file. Returns `false` on
+// failure.
+template<typename Type>
+bool ReadValue(std::FILE* file, Type* value) {
+  return std::fread(value, sizeof(Type), 1, file) == 1;
+}
+
+// Reads a pointer identifier and a location from the file. Returns `false`
+// on failure.
+bool ReadPointer(std::FILE* file, int* pointer_id, moui::Point* location) {
+  int32_t id;
+  if (!ReadValue(file, &id) || !ReadValue(file, &location->x) ||
+      !ReadValue(file, &location->y)) {
+    return false;
+  }
+  *pointer_id = id;
+  return true;
+}
+
+// Writes a value of the specified type to the file. Returns `false` on
+// failure.
+template<typename Type>
+bool WriteValue(std::FILE* file, const Type value) {
+  return std::fwrite(&value, sizeof(Type), 1, file) == 1;
+}
+
+// Writes a pointer identifier and a location to the file. Returns `false` on
+// failure.
+bool WritePointer(std::FILE* file, const int pointer_id,
+                  const moui::Point location) {
+  return WriteValue(file, static_cast<int32_t>(pointer_id)) &&
+         WriteValue(file, location.x) && WriteValue(file, location.y);
+}
+
+}  // namespace
+
+namespace moui {
+
+InputRecording::InputRecording() {
+}
+
+InputRecording::~InputRecording() {
+}
+
+void InputRecording::Clear() {
+  records_.clear();
+}
+
+bool InputRecording::Load(const std::string& path) {
+  records_.clear();
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == NULL)
+    return false;
+
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t number_of_records;
+  bool succeeded = \
+      std::fread(magic, sizeof(magic), 1, file) == 1 &&
+      std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+      ReadValue(file, &version) && version == kVersion &&
+      ReadValue(file, &number_of_records);
+  for (uint32_t i = 0; succeeded && i < number_of_records; ++i) {
+    uint8_t kind;
+    uint8_t type;
+    uint16_t number_of_pointers;
+    uint32_t number_of_samples;
+    Record record;
+    succeeded = ReadValue(file, &kind) && ReadValue(file, &type) &&
+                ReadValue(file, &number_of_pointers) &&
+                ReadValue(file, &number_of_samples) &&
+                ReadValue(file, &record.timestamp) &&
+                kind <= static_cast<uint8_t>(Record::Kind::kHitTest) &&
+                type <= static_cast<uint8_t>(Event::Type::kUnknown);
+    if (!succeeded)
+      break;
+    record.kind = static_cast<Record::Kind>(kind);
+    record.type = static_cast<Event::Type>(type);
+    for (int j = 0; succeeded && j < number_of_pointers; ++j) {
+      int pointer_id;
+      Point location;
+      succeeded = ReadPointer(file, &pointer_id, &location);
+      record.pointer_ids.push_back(pointer_id);
+      record.locations.push_back(location);
+    }
+    for (uint32_t j = 0; succeeded && j < number_of_samples; ++j) {
+      Event::Sample sample;
+      succeeded = ReadPointer(file, &sample.pointer_id, &sample.location) &&
+                  ReadValue(file, &sample.timestamp);
+      record.historical_samples.push_back(sample);
+    }
+    record.scroll_delta = {0, 0};
+    record.scroll_phase = Event::ScrollPhase::kNone;
+    if (succeeded && record.type == Event::Type::kScroll) {
+      uint8_t scroll_phase;
+      succeeded = \
+          ReadValue(file, &scroll_phase) &&
+          ReadValue(file, &record.scroll_delta.x) &&
+          ReadValue(file, &record.scroll_delta.y) &&
+          scroll_phase <= static_cast<uint8_t>(
+                              Event::ScrollPhase::kMomentumEnded);
+      record.scroll_phase = static_cast<Event::ScrollPhase>(scroll_phase);
+    }
+    records_.push_back(record);
+  }
+  std::fclose(file);
+  if (!succeeded)
+    records_.clear();
+  return succeeded;
+}
+
+void InputRecording::RecordEvent(Event* event) {
+  Record record = {Record::Kind::kEvent, event->type(), event->timestamp(),
+                   *event->locations(), {}, *event->historical_samples(),
+                   event->scroll_delta(), event->scroll_phase()};
+  for (int i = 0; i < static_cast<int>(record.locations.size()); ++i)
+    record.pointer_ids.push_back(event->GetPointerId(i));
+  records_.push_back(record);
+}
+
+void InputRecording::RecordHitTest(const Point location,
+                                   const double timestamp) {
+  records_.push_back({Record::Kind::kHitTest, Event::Type::kUnknown,
+                      timestamp, {location}, {0}, {}, {0, 0},
+                      Event::ScrollPhase::kNone});
+}
+
+bool InputRecording::Save(const std::string& path) const {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == NULL)
+    return false;
+
+  bool succeeded = \
+      std::fwrite(kMagic, sizeof(kMagic), 1, file) == 1 &&
+      WriteValue(file, kVersion) &&
+      WriteValue(file, static_cast<uint32_t>(records_.size()));
+  for (const Record& record : records_) {
+    if (!succeeded)
+      break;
+    succeeded = \
+        WriteValue(file, static_cast<uint8_t>(record.kind)) &&
+        WriteValue(file, static_cast<uint8_t>(record.type)) &&
+        WriteValue(file, static_cast<uint16_t>(record.locations.size())) &&
+        WriteValue(file,
+                   static_cast<uint32_t>(record.historical_samples.size())) &&
+        WriteValue(file, record.timestamp);
+    for (int i = 0; succeeded && i < static_cast<int>(record.locations.size());
+         ++i) {
+      succeeded = WritePointer(file, record.pointer_ids[i],
+                               record.locations[i]);
+    }
+    for (const Event::Sample& sample : record.historical_samples) {
+      if (!succeeded)
+        break;
+      succeeded = WritePointer(file, sample.pointer_id, sample.location) &&
+                  WriteValue(file, sample.timestamp);
+    }
+    if (succeeded && record.type == Event::Type::kScroll) {
+      succeeded = \
+          WriteValue(file, static_cast<uint8_t>(record.scroll_phase)) &&
+          WriteValue(file, record.scroll_delta.x) &&
+          WriteValue(file, record.scroll_delta.y);
+    }
+  }
+  if (std::fclose(file) != 0)
+    succeeded = false;
+  return succeeded;
+}
+
+}  // namespace moui
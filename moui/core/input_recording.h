@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_CORE_INPUT_RECORDING_H_
+#define MOUI_CORE_INPUT_RECORDING_H_
+
+#include <string>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+
+namespace moui {
+
+// The `InputRecording` class keeps the input a view received in order, so
+// the exact input of a session, such as a fling reported as janky, could be
+// saved to a file and replayed later by `InputReplayer`. A `WidgetView`
+// appends to the recording set by `WidgetView::set_input_recording()`.
+//
+// Recordings are saved in a compact binary format in the byte order of the
+// recording machine. Predicted locations are not recorded because they are
+// computed again when replaying. The scroll delta and phase are only saved
+// for scroll events.
+class InputRecording {
+ public:
+  // A recorded input.
+  struct Record {
+    // The kinds of recorded input.
+    enum class Kind {
+      // An event passed to `BaseView::HandleEvent()`.
+      kEvent,
+      // A location passed to `BaseView::ShouldHandleEvent()`.
+      kHitTest,
+    };
+
+    // The kind of the input.
+    Kind kind;
+    // The type of the event. This value is `Event::Type::kUnknown` for hit
+    // tests.
+    Event::Type type;
+    // The timestamp the input happened at.
+    double timestamp;
+    // The locations of the pointers. Hit tests have a single location.
+    std::vector<Point> locations;
+    // The identifiers of the pointers corresponded to `locations`.
+    std::vector<int> pointer_ids;
+    // The historical samples of the event.
+    std::vector<Event::Sample> historical_samples;
+    // The displacement of a scroll event.
+    Point scroll_delta;
+    // The phase of a scroll event.
+    Event::ScrollPhase scroll_phase;
+  };
+
+  InputRecording();
+  ~InputRecording();
+
+  // Removes all records.
+  void Clear();
+
+  // Replaces the records with the ones saved in the specified file. Returns
+  // `false` if the file cannot be read or is not a recording, in which case
+  // the records are left empty.
+  bool Load(const std::string& path);
+
+  // Appends the passed event.
+  void RecordEvent(Event* event);
+
+  // Appends a hit test at the specified location and timestamp.
+  void RecordHitTest(const Point location, const double timestamp);
+
+  // Saves the records to the specified file. Returns `false` on failure.
+  bool Save(const std::string& path) const;
+
+  // Accessors and setters.
+  const std::vector<Record>* records() const { return &records_; }
+
+ private:
+  // The records ordered by the time they were recorded.
+  std::vector<Record> records_;
+
+  DISALLOW_COPY_AND_ASSIGN(InputRecording);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_CORE_INPUT_RECORDING_H_
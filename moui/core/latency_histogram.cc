@@ -0,0 +1,81 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/core/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// The duration in seconds covered by each bucket.
+const double kBucketWidth = 0.001;
+// The number of buckets.
+const int kNumberOfBuckets = 501;
+
+}  // namespace
+
+namespace moui {
+
+LatencyHistogram::LatencyHistogram()
+    : buckets_(kNumberOfBuckets, 0), maximum_(0), number_of_samples_(0),
+      sum_(0) {
+}
+
+LatencyHistogram::~LatencyHistogram() {
+}
+
+void LatencyHistogram::AddSample(const double latency) {
+  const double kLatency = std::max(0.0, latency);
+  const int kIndex = static_cast<int>(
+      std::min(kLatency / kBucketWidth, kNumberOfBuckets - 1.0));
+  ++buckets_[kIndex];
+  maximum_ = std::max(maximum_, kLatency);
+  ++number_of_samples_;
+  sum_ += kLatency;
+}
+
+double LatencyHistogram::GetMean() const {
+  if (number_of_samples_ == 0)
+    return 0;
+  return sum_ / number_of_samples_;
+}
+
+double LatencyHistogram::GetPercentile(const float fraction) const {
+  if (number_of_samples_ == 0)
+    return 0;
+  const int kRank = std::max(
+      1, static_cast<int>(std::ceil(fraction * number_of_samples_)));
+  // The last bucket has no upper boundary.
+  int count = 0;
+  for (int i = 0; i < kNumberOfBuckets - 1; ++i) {
+    count += buckets_[i];
+    if (count >= kRank)
+      return std::min((i + 1) * kBucketWidth, maximum_);
+  }
+  return maximum_;
+}
+
+void LatencyHistogram::Reset() {
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  maximum_ = 0;
+  number_of_samples_ = 0;
+  sum_ = 0;
+}
+
+}  // namespace moui
@@ -0,0 +1,75 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_CORE_LATENCY_HISTOGRAM_H_
+#define MOUI_CORE_LATENCY_HISTOGRAM_H_
+
+#include <vector>
+
+#include "moui/base.h"
+
+namespace moui {
+
+// The `LatencyHistogram` class accumulates latency samples in buckets of one
+// millisecond, so percentiles could be reported from any number of samples
+// in constant memory. The last bucket counts all samples of 500 milliseconds
+// or more.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  // Adds a latency in seconds. Negative latencies are counted as 0.
+  void AddSample(const double latency);
+
+  // Returns the average of all samples in seconds, or 0 if there is none.
+  double GetMean() const;
+
+  // Returns the latency in seconds that the specified fraction of samples
+  // are not greater than, such as 0.99 for the 99th percentile. The result is
+  // rounded up to the bucket boundary but never exceeds `maximum()`. Returns
+  // 0 if there is no sample.
+  double GetPercentile(const float fraction) const;
+
+  // Removes all samples.
+  void Reset();
+
+  // Accessors and setters.
+  const std::vector<int>* buckets() const { return &buckets_; }
+  double maximum() const { return maximum_; }
+  int number_of_samples() const { return number_of_samples_; }
+
+ private:
+  // The number of samples in each bucket. The bucket at index `i` counts
+  // the samples from `i` to `i + 1` milliseconds.
+  std::vector<int> buckets_;
+
+  // The maximum latency in seconds of all samples.
+  double maximum_;
+
+  // The total number of samples.
+  int number_of_samples_;
+
+  // The sum of all samples in seconds.
+  double sum_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_CORE_LATENCY_HISTOGRAM_H_
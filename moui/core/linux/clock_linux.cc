@@ -0,0 +1,86 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+// This implementation is shared by Android and Linux. Android additionally
+// compiles `clock_android.cc` to drive the main thread timer queue from its
+// looper.
+
+#include "moui/core/clock.h"
+
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "moui/core/timer_queue.h"
+
+namespace {
+
+// Returns the queue of the callbacks scheduled by `Clock::DispatchAfter()`.
+// The queue is served by a detached thread on first use. Both are leaked
+// intentionally so the thread never outlives the queue at exit.
+moui::TimerQueue* GetBackgroundTimerQueue() {
+  static moui::TimerQueue* queue = [] {
+    auto timer_queue = new moui::TimerQueue;
+    std::thread([timer_queue] {
+      while (true) {
+        timer_queue->WaitForDueTimers();
+        timer_queue->FireDueTimers(moui::TimerQueue::GetCurrentTimestamp());
+      }
+    }).detach();
+    return timer_queue;
+  }();
+  return queue;
+}
+
+}  // namespace
+
+namespace moui {
+
+bool Clock::CancelCallback(const Handle handle) {
+  // Handles are unique across queues so trying both is safe.
+  return GetMainThreadTimerQueue()->Cancel(handle) ||
+         GetBackgroundTimerQueue()->Cancel(handle);
+}
+
+Clock::Handle Clock::DispatchAfter(const float delay,
+                                   std::function<void()> callback) {
+  return GetBackgroundTimerQueue()->Schedule(
+      TimerQueue::GetCurrentTimestamp() + delay, std::move(callback));
+}
+
+Clock::Handle Clock::ExecuteCallbackOnMainThread(
+    const float delay, std::function<void()> callback) {
+  return GetMainThreadTimerQueue()->Schedule(
+      TimerQueue::GetCurrentTimestamp() + delay, std::move(callback));
+}
+
+Clock::Handle Clock::ExecuteCallbackOnMainThread(
+    std::function<void()> callback) {
+  return ExecuteCallbackOnMainThread(0, std::move(callback));
+}
+
+TimerQueue* Clock::GetMainThreadTimerQueue() {
+  static TimerQueue* queue = new TimerQueue(true);
+  return queue;
+}
+
+void Clock::Reset() {
+  GetMainThreadTimerQueue()->Clear();
+  GetBackgroundTimerQueue()->Clear();
+}
+
+}  // namespace moui
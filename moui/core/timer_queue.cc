@@ -0,0 +1,210 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/core/timer_queue.h"
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The mask of the slot index in a handle.
+const moui::TimerQueue::Handle kSlotIndexMask = 0xffffffff;
+
+// The process-wide sequence number of the next timer. Sharing it across
+// queues makes handles unique so a handle can be tried on several queues.
+std::atomic<uint64_t> next_sequence(1);
+
+}  // namespace
+
+namespace moui {
+
+TimerQueue::TimerQueue() : TimerQueue(false) {
+}
+
+TimerQueue::TimerQueue(const bool uses_wakeup_fd)
+    : is_firing_(false), wakeup_fd_(-1) {
+#if defined(__linux__)
+  if (uses_wakeup_fd)
+    wakeup_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif  // __linux__
+}
+
+TimerQueue::~TimerQueue() {
+#if defined(__linux__)
+  if (wakeup_fd_ >= 0)
+    close(wakeup_fd_);
+#endif  // __linux__
+}
+
+bool TimerQueue::Cancel(const Handle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t kIndex = handle & kSlotIndexMask;
+  if (handle == 0 || kIndex >= slots_.size() ||
+      slots_[kIndex].handle != handle) {
+    return false;
+  }
+  ReleaseSlot(kIndex);
+  // Only the earliest timer affects the wakeup.
+  if (!timers_.empty() && timers_.front().handle == handle)
+    UpdateWakeup();
+  return true;
+}
+
+void TimerQueue::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Timer& timer : timers_) {
+    if (IsScheduled(timer))
+      ReleaseSlot(timer.handle & kSlotIndexMask);
+  }
+  timers_.clear();
+  UpdateWakeup();
+}
+
+int TimerQueue::FireDueTimers(const double timestamp) {
+  if (is_firing_)
+    return 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!timers_.empty() && timers_.front().timestamp <= timestamp) {
+      std::pop_heap(timers_.begin(), timers_.end(), IsLaterTimer);
+      const Timer kTimer = timers_.back();
+      timers_.pop_back();
+      if (!IsScheduled(kTimer))
+        continue;
+      const uint32_t kIndex = kTimer.handle & kSlotIndexMask;
+      firing_callbacks_.push_back(std::move(slots_[kIndex].callback));
+      ReleaseSlot(kIndex);
+    }
+    UpdateWakeup();
+  }
+  is_firing_ = true;
+  for (auto& callback : firing_callbacks_)
+    callback();
+  is_firing_ = false;
+  const int kNumberOfCallbacks = static_cast<int>(firing_callbacks_.size());
+  firing_callbacks_.clear();
+  return kNumberOfCallbacks;
+}
+
+double TimerQueue::GetCurrentTimestamp() {
+  static auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+double TimerQueue::GetNextTimestamp() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PopCancelledTimers();
+  return timers_.empty() ? -1 : timers_.front().timestamp;
+}
+
+bool TimerQueue::IsLaterTimer(const Timer& a, const Timer& b) {
+  if (a.timestamp != b.timestamp)
+    return a.timestamp > b.timestamp;
+  return a.handle > b.handle;
+}
+
+bool TimerQueue::IsScheduled(const Timer& timer) const {
+  return slots_[timer.handle & kSlotIndexMask].handle == timer.handle;
+}
+
+void TimerQueue::PopCancelledTimers() {
+  while (!timers_.empty() && !IsScheduled(timers_.front())) {
+    std::pop_heap(timers_.begin(), timers_.end(), IsLaterTimer);
+    timers_.pop_back();
+  }
+}
+
+void TimerQueue::ReleaseSlot(const uint32_t index) {
+  Slot& slot = slots_[index];
+  slot.callback = nullptr;
+  slot.handle = 0;
+  free_slots_.push_back(index);
+}
+
+TimerQueue::Handle TimerQueue::Schedule(const double timestamp,
+                                        std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t index;
+  if (free_slots_.empty()) {
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(Slot{nullptr, 0});
+  } else {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  const Handle kHandle = (next_sequence.fetch_add(1) << 32) | index;
+  slots_[index] = Slot{std::move(callback), kHandle};
+  timers_.push_back(Timer{timestamp, kHandle});
+  std::push_heap(timers_.begin(), timers_.end(), IsLaterTimer);
+  if (timers_.front().handle == kHandle)
+    UpdateWakeup();
+  return kHandle;
+}
+
+void TimerQueue::UpdateWakeup() {
+  PopCancelledTimers();
+  condition_.notify_all();
+#if defined(__linux__)
+  if (wakeup_fd_ < 0)
+    return;
+  // Setting the timer also resets its expiration count, which drains the
+  // descriptor. A zero `it_value` disarms the timer, so a due timer is armed
+  // to expire in a nanosecond instead.
+  struct itimerspec spec = {};
+  if (!timers_.empty()) {
+    const double kDelay = std::max(
+        timers_.front().timestamp - GetCurrentTimestamp(), 0.0);
+    spec.it_value.tv_sec = static_cast<time_t>(kDelay);
+    spec.it_value.tv_nsec = static_cast<long>(  // NOLINT
+        (kDelay - spec.it_value.tv_sec) * 1e9);
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+      spec.it_value.tv_nsec = 1;
+  }
+  timerfd_settime(wakeup_fd_, 0, &spec, nullptr);
+#endif  // __linux__
+}
+
+void TimerQueue::WaitForDueTimers() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    PopCancelledTimers();
+    if (timers_.empty()) {
+      condition_.wait(lock);
+      continue;
+    }
+    const double kDelay = timers_.front().timestamp - GetCurrentTimestamp();
+    if (kDelay <= 0)
+      return;
+    condition_.wait_for(lock, std::chrono::duration<double>(kDelay));
+  }
+}
+
+}  // namespace moui
@@ -0,0 +1,161 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_CORE_TIMER_QUEUE_H_
+#define MOUI_CORE_TIMER_QUEUE_H_
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "moui/base.h"
+
+namespace moui {
+
+// The `TimerQueue` class keeps callbacks scheduled to be executed at specific
+// timestamps in a min-heap ordered by their timestamps. The queue does not
+// run a thread by itself. Instead, its owner drives it either from a main
+// loop waiting on `wakeup_fd()`, or from a dedicated thread blocked in
+// `WaitForDueTimers()`, and then calls `FireDueTimers()`. Timestamps are in
+// the time base of `GetCurrentTimestamp()`. All methods are thread-safe.
+class TimerQueue {
+ public:
+  // Identifies a scheduled timer. Handles are unique across all queues in
+  // the process, and 0 never identifies a timer.
+  typedef uint64_t Handle;
+
+  TimerQueue();
+  // Creates a queue that also maintains a wakeup file descriptor if
+  // `uses_wakeup_fd` is `true`. See `wakeup_fd()` for details.
+  explicit TimerQueue(const bool uses_wakeup_fd);
+  ~TimerQueue();
+
+  // Cancels the timer of the specified handle. Returns `false` if the handle
+  // does not belong to this queue or the timer already fired or was
+  // cancelled.
+  bool Cancel(const Handle handle);
+
+  // Cancels all timers.
+  void Clear();
+
+  // Executes the callbacks of all timers due at the specified timestamp in a
+  // single batch, ordered by their timestamps and then by the order they
+  // were scheduled. The callbacks are executed without holding the lock, so
+  // they can schedule new timers, which will be fired in a later batch. A
+  // timer cannot be cancelled once its batch starts. Returns the number of
+  // executed callbacks. This method must not be called by more than one
+  // thread at a time.
+  int FireDueTimers(const double timestamp);
+
+  // Returns the current point in time in seconds on the steady clock. Unlike
+  // `Clock::GetTimestamp()`, this ignores the virtual timestamp, so timers
+  // always fire in real time and the threads driving the queues never read
+  // the virtual timestamp set by the main thread.
+  static double GetCurrentTimestamp();
+
+  // Returns the timestamp of the earliest timer, or a negative value if
+  // there is none.
+  double GetNextTimestamp();
+
+  // Schedules the callback to be executed at the specified timestamp and
+  // returns the handle of the timer.
+  Handle Schedule(const double timestamp, std::function<void()> callback);
+
+  // Blocks the calling thread until the earliest timer is due. The wait is
+  // re-evaluated whenever the earliest timer changes.
+  void WaitForDueTimers();
+
+  // Accessors and setters.
+  int wakeup_fd() const { return wakeup_fd_; }
+
+ private:
+  // A pending entry of the heap. Cancelled timers stay in the heap until
+  // they reach the top, where they are discarded by checking their slots.
+  struct Timer {
+    // The timestamp at which the timer is due.
+    double timestamp;
+    // The handle of the timer. The high 32 bits hold a process-wide sequence
+    // number that breaks ties between equal timestamps, and the low 32 bits
+    // hold the index of the slot.
+    Handle handle;
+  };
+
+  // Keeps the callback of a scheduled timer. Slots are recycled through
+  // `free_slots_` so scheduling does not allocate once the queue warmed up.
+  struct Slot {
+    // The callback to execute.
+    std::function<void()> callback;
+    // The handle of the timer currently occupying the slot, or 0 if the slot
+    // is free.
+    Handle handle;
+  };
+
+  // Returns `true` if the timer `a` should fire after the timer `b`. This is
+  // the comparator of the min-heap.
+  static bool IsLaterTimer(const Timer& a, const Timer& b);
+
+  // Returns `true` if the timer is still scheduled. The lock must be held.
+  bool IsScheduled(const Timer& timer) const;
+
+  // Pops cancelled timers off the top of the heap. The lock must be held.
+  void PopCancelledTimers();
+
+  // Returns the slot to `free_slots_`. The lock must be held.
+  void ReleaseSlot(const uint32_t index);
+
+  // Wakes up the waiting threads and re-arms `wakeup_fd_` for the earliest
+  // timer. This must be called whenever the earliest timer changes. The lock
+  // must be held.
+  void UpdateWakeup();
+
+  // Notifies the threads blocked in `WaitForDueTimers()`.
+  std::condition_variable condition_;
+
+  // The callbacks being executed by `FireDueTimers()`. The vector is reused
+  // across batches to avoid allocations.
+  std::vector<std::function<void()>> firing_callbacks_;
+
+  // The indexes of the free slots in `slots_`.
+  std::vector<uint32_t> free_slots_;
+
+  // Indicates whether `FireDueTimers()` is executing callbacks.
+  bool is_firing_;
+
+  // Guards all states except `firing_callbacks_` and `is_firing_`.
+  std::mutex mutex_;
+
+  // The slots of the scheduled timers.
+  std::vector<Slot> slots_;
+
+  // The min-heap of the scheduled timers ordered by their timestamps.
+  std::vector<Timer> timers_;
+
+  // On Linux, including Android, this is a timerfd that becomes readable
+  // when the earliest timer is due, so a single descriptor can be polled by
+  // the main loop no matter how many timers are scheduled. It is re-armed
+  // and drained by `FireDueTimers()`. The value is -1 on other platforms or
+  // if the queue was created without it.
+  int wakeup_fd_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerQueue);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_CORE_TIMER_QUEUE_H_
@@ -0,0 +1,219 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/core/touch_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+
+namespace {
+
+// The maximum distance in points a prediction could be away from the latest
+// sample.
+const float kMaximumPredictionDistance = 40;
+
+// The maximum duration in seconds to predict beyond the latest sample.
+const double kMaximumPredictionInterval = 0.05;
+
+// The maximum number of samples used for fitting.
+const int kMaximumNumberOfSamples = 20;
+
+// The minimum number of samples required to fit a quadratic polynomial.
+// Fewer samples are fitted linearly.
+const int kMinimumNumberOfQuadraticSamples = 4;
+
+// The duration in seconds of the samples used for fitting.
+const double kSampleWindow = 0.1;
+
+// Solves the 3x3 linear system `matrix * solution = vector` by Cramer's rule.
+// Returns `false` if the system is singular.
+bool Solve3x3(const double matrix[3][3], const double vector[3],
+              double solution[3]) {
+  auto determinant = [](const double m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+           m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+  };
+  const double kDeterminant = determinant(matrix);
+  if (std::abs(kDeterminant) < 1e-18)
+    return false;
+  for (int column = 0; column < 3; ++column) {
+    double replaced[3][3];
+    for (int row = 0; row < 3; ++row) {
+      for (int i = 0; i < 3; ++i)
+        replaced[row][i] = i == column ? vector[row] : matrix[row][i];
+    }
+    solution[column] = determinant(replaced) / kDeterminant;
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace moui {
+
+TouchPredictor::TouchPredictor() {
+}
+
+TouchPredictor::~TouchPredictor() {
+}
+
+void TouchPredictor::AddSample(const Point location, const double timestamp) {
+  samples_.push_back({location, timestamp});
+  // Drops samples out of the window but always keeps two for a linear fit.
+  int number_of_expired_samples = 0;
+  const int kNumberOfSamples = static_cast<int>(samples_.size());
+  while (kNumberOfSamples - number_of_expired_samples > 2 &&
+         (kNumberOfSamples - number_of_expired_samples >
+              kMaximumNumberOfSamples ||
+          timestamp - samples_[number_of_expired_samples].timestamp >
+              kSampleWindow)) {
+    ++number_of_expired_samples;
+  }
+  samples_.erase(samples_.begin(),
+                 samples_.begin() + number_of_expired_samples);
+}
+
+bool TouchPredictor::MeasureError(const std::vector<Event::Sample>& trace,
+                                  const double interval, float* mean_error,
+                                  float* maximum_error) {
+  TouchPredictor predictor;
+  double total_error = 0;
+  float max_error = 0;
+  int number_of_predictions = 0;
+  int next_index = 0;
+  for (const Event::Sample& sample : trace) {
+    predictor.AddSample(sample.location, sample.timestamp);
+    const double kTargetTimestamp = sample.timestamp + interval;
+    // Finds the actual location at the target timestamp.
+    while (next_index < static_cast<int>(trace.size()) &&
+           trace[next_index].timestamp < kTargetTimestamp) {
+      ++next_index;
+    }
+    if (next_index == 0 || next_index >= static_cast<int>(trace.size()))
+      continue;
+    const Event::Sample& kBefore = trace[next_index - 1];
+    const Event::Sample& kAfter = trace[next_index];
+    const double kSpan = kAfter.timestamp - kBefore.timestamp;
+    const float kProgress = kSpan <= 0 ?
+        1 : (kTargetTimestamp - kBefore.timestamp) / kSpan;
+    const Point kActual = {
+        kBefore.location.x + (kAfter.location.x - kBefore.location.x) *
+                             kProgress,
+        kBefore.location.y + (kAfter.location.y - kBefore.location.y) *
+                             kProgress};
+
+    Point predicted;
+    predictor.Predict(kTargetTimestamp, &predicted);
+    const float kError = std::hypot(predicted.x - kActual.x,
+                                    predicted.y - kActual.y);
+    total_error += kError;
+    max_error = std::max(max_error, kError);
+    ++number_of_predictions;
+  }
+  if (number_of_predictions == 0)
+    return false;
+  if (mean_error != nullptr)
+    *mean_error = total_error / number_of_predictions;
+  if (maximum_error != nullptr)
+    *maximum_error = max_error;
+  return true;
+}
+
+bool TouchPredictor::Predict(const double timestamp, Point* location) const {
+  if (samples_.empty())
+    return false;
+
+  const Sample& kLatest = samples_.back();
+  *location = kLatest.location;
+  const double kInterval = std::min(kMaximumPredictionInterval,
+                                    timestamp - kLatest.timestamp);
+  if (samples_.size() < 2 || kInterval <= 0)
+    return true;
+
+  // Fits `x(t) = a + b * t + c * t^2` for both axes with `t` relative to the
+  // latest sample, so `a` stays close to the latest location.
+  const int kNumberOfSamples = static_cast<int>(samples_.size());
+  double power_sums[5] = {0, 0, 0, 0, 0};
+  double x_sums[3] = {0, 0, 0};
+  double y_sums[3] = {0, 0, 0};
+  for (const Sample& sample : samples_) {
+    const double kTime = sample.timestamp - kLatest.timestamp;
+    double power = 1;
+    for (int i = 0; i < 5; ++i) {
+      power_sums[i] += power;
+      if (i < 3) {
+        x_sums[i] += power * sample.location.x;
+        y_sums[i] += power * sample.location.y;
+      }
+      power *= kTime;
+    }
+  }
+
+  double x_coefficients[3] = {0, 0, 0};
+  double y_coefficients[3] = {0, 0, 0};
+  const double kQuadraticMatrix[3][3] = {
+      {power_sums[0], power_sums[1], power_sums[2]},
+      {power_sums[1], power_sums[2], power_sums[3]},
+      {power_sums[2], power_sums[3], power_sums[4]}};
+  if (kNumberOfSamples < kMinimumNumberOfQuadraticSamples ||
+      !Solve3x3(kQuadraticMatrix, x_sums, x_coefficients) ||
+      !Solve3x3(kQuadraticMatrix, y_sums, y_coefficients)) {
+    // Falls back to a linear fit.
+    const double kDeterminant = \
+        power_sums[0] * power_sums[2] - power_sums[1] * power_sums[1];
+    if (std::abs(kDeterminant) < 1e-18)
+      return true;
+    x_coefficients[0] = \
+        (power_sums[2] * x_sums[0] - power_sums[1] * x_sums[1]) / kDeterminant;
+    x_coefficients[1] = \
+        (power_sums[0] * x_sums[1] - power_sums[1] * x_sums[0]) / kDeterminant;
+    y_coefficients[0] = \
+        (power_sums[2] * y_sums[0] - power_sums[1] * y_sums[1]) / kDeterminant;
+    y_coefficients[1] = \
+        (power_sums[0] * y_sums[1] - power_sums[1] * y_sums[0]) / kDeterminant;
+    x_coefficients[2] = 0;
+    y_coefficients[2] = 0;
+  }
+
+  // Applies the fitted motion to the latest location instead of using the
+  // fitted location directly, so the prediction starts where the pointer is.
+  auto displacement = [kInterval](const double coefficients[3]) {
+    return coefficients[1] * kInterval +
+           coefficients[2] * kInterval * kInterval;
+  };
+  float dx = displacement(x_coefficients);
+  float dy = displacement(y_coefficients);
+  const float kDistance = std::hypot(dx, dy);
+  if (kDistance > kMaximumPredictionDistance) {
+    dx *= kMaximumPredictionDistance / kDistance;
+    dy *= kMaximumPredictionDistance / kDistance;
+  }
+  location->x += dx;
+  location->y += dy;
+  return true;
+}
+
+void TouchPredictor::Reset() {
+  samples_.clear();
+}
+
+}  // namespace moui
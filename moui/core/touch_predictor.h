@@ -0,0 +1,79 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_CORE_TOUCH_PREDICTOR_H_
+#define MOUI_CORE_TOUCH_PREDICTOR_H_
+
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+
+namespace moui {
+
+// The `TouchPredictor` class estimates where a pointer will be at a time
+// shortly after its latest sample, so content dragged by the pointer can be
+// displayed where the pointer is when the frame is presented rather than
+// where it was when the frame started.
+//
+// The location is extrapolated by a least squares polynomial fitted to the
+// samples of the last 100 milliseconds, quadratic if there are enough samples
+// and linear otherwise. Predictions never reach more than 50 milliseconds or
+// 40 points beyond the latest sample.
+class TouchPredictor {
+ public:
+  TouchPredictor();
+  ~TouchPredictor();
+
+  // Adds a sample of the pointer. Samples must be added in the order they
+  // were sampled.
+  void AddSample(const Point location, const double timestamp);
+
+  // Replays the passed trace of a single pointer and measures how far the
+  // locations predicted `interval` seconds after each sample are from the
+  // actual locations interpolated from the trace. Either `mean_error` or
+  // `maximum_error` could be `nullptr`. Returns `false` if the trace is too
+  // short to measure any prediction.
+  static bool MeasureError(const std::vector<Event::Sample>& trace,
+                           const double interval, float* mean_error,
+                           float* maximum_error);
+
+  // Populates `location` with the estimated location of the pointer at the
+  // specified timestamp. Returns `false` if there is no sample.
+  bool Predict(const double timestamp, Point* location) const;
+
+  // Removes all samples.
+  void Reset();
+
+ private:
+  // A sample of the pointer.
+  struct Sample {
+    // The location of the pointer.
+    Point location;
+    // The timestamp of the sample.
+    double timestamp;
+  };
+
+  // The recent samples ordered from the oldest.
+  std::vector<Sample> samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(TouchPredictor);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_CORE_TOUCH_PREDICTOR_H_
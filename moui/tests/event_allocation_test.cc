@@ -0,0 +1,117 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+// Verifies that reusing an event the way the platform bridges and
+// `WidgetView` do allocates no memory once its storage is large enough.
+//
+// Only the event storage is covered. `WidgetView::DispatchEvent()`, the
+// synthesized cancel events and the gesture arena need a platform view and
+// a nanovg context, which this host-only test does not have, so the pending
+// move event of `WidgetView` is imitated with `Event::Reset()` and
+// `Event::Coalesce()` instead.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "moui/core/event.h"
+
+namespace {
+
+// The number of heap allocations made by `operator new` so far.
+int allocation_count = 0;
+
+// Reinitializes the event as a touch event of the specified number of
+// pointers, each with a few historical samples, like the platform bridges do
+// for every platform event.
+void FillEvent(const moui::Event::Type type, const double timestamp,
+               const int number_of_pointers, moui::Event* event) {
+  event->Reset(type, timestamp);
+  for (int i = 0; i < number_of_pointers; ++i) {
+    const float kOffset = static_cast<float>(i * 10);
+    for (int h = 0; h < 3; ++h) {
+      event->historical_samples()->push_back(
+          {i, {kOffset, kOffset + h}, timestamp - 0.004 * (3 - h)});
+    }
+    event->locations()->push_back({kOffset, kOffset + 3});
+    event->pointer_ids()->push_back(i);
+  }
+}
+
+// Runs one touch sequence of the specified number of pointers through the
+// events. `pending_event` plays the role of the pending move event that
+// `WidgetView` coalesces moves into.
+void RunTouchSequence(const int number_of_pointers,
+                      moui::Event* platform_event,
+                      moui::Event* pending_event) {
+  double timestamp = 1;
+  FillEvent(moui::Event::Type::kDown, timestamp, number_of_pointers,
+            platform_event);
+  for (int i = 0; i < 100; ++i) {
+    timestamp += 0.008;
+    FillEvent(moui::Event::Type::kMove, timestamp, number_of_pointers,
+              platform_event);
+    if (i % 2 == 0) {
+      pending_event->Reset(moui::Event::Type::kMove, timestamp);
+      *pending_event->locations() = *platform_event->locations();
+      *pending_event->pointer_ids() = *platform_event->pointer_ids();
+      *pending_event->historical_samples() =
+          *platform_event->historical_samples();
+    } else {
+      pending_event->Coalesce(*platform_event);
+    }
+  }
+  FillEvent(moui::Event::Type::kUp, timestamp + 0.008, number_of_pointers,
+            platform_event);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /* size */) noexcept {
+  std::free(pointer);
+}
+
+int main() {
+  moui::Event platform_event(moui::Event::Type::kUnknown, 0);
+  moui::Event pending_event(moui::Event::Type::kUnknown, 0);
+
+  // Warms up the storage of both events for up to two pointers.
+  RunTouchSequence(2, &platform_event, &pending_event);
+
+  const int kAllocationCount = allocation_count;
+  RunTouchSequence(1, &platform_event, &pending_event);
+  RunTouchSequence(2, &platform_event, &pending_event);
+  const int kNumberOfAllocations = allocation_count - kAllocationCount;
+  if (kNumberOfAllocations != 0) {
+    std::fprintf(stderr, "Reusing events made %d allocations.\n",
+                 kNumberOfAllocations);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+// Verifies the ordering, cancellation and wakeups of `TimerQueue`, and the
+// `Clock` callbacks that Android and Linux build on top of it.
+
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "moui/core/clock.h"
+#include "moui/core/timer_queue.h"
+
+namespace {
+
+// Prints the message if the condition does not hold. Returns the condition.
+bool Expect(const bool condition, const char* message) {
+  if (!condition)
+    std::fprintf(stderr, "Failed: %s\n", message);
+  return condition;
+}
+
+// Returns `true` if the descriptor becomes readable within the timeout in
+// milliseconds.
+bool PollReadable(const int fd, const int timeout) {
+  pollfd poll_fd = {fd, POLLIN, 0};
+  return poll(&poll_fd, 1, timeout) == 1;
+}
+
+bool TestCancellation() {
+  moui::TimerQueue queue;
+  moui::TimerQueue other_queue;
+  const moui::TimerQueue::Handle kHandle = queue.Schedule(1, [] {});
+  const moui::TimerQueue::Handle kOtherHandle = \
+      other_queue.Schedule(1, [] {});
+  queue.Schedule(2, [] {});
+  bool result = true;
+  result &= Expect(!queue.Cancel(0), "0 is not a handle");
+  result &= Expect(!queue.Cancel(kOtherHandle),
+                   "handles of other queues are not cancelled");
+  result &= Expect(queue.Cancel(kHandle), "a scheduled timer is cancelled");
+  result &= Expect(!queue.Cancel(kHandle), "a timer is cancelled once");
+  result &= Expect(queue.GetNextTimestamp() == 2,
+                   "cancelled timers are skipped");
+  result &= Expect(queue.FireDueTimers(10) == 1,
+                   "cancelled timers do not fire");
+  queue.Schedule(3, [] {});
+  queue.Clear();
+  result &= Expect(queue.GetNextTimestamp() < 0, "clearing cancels timers");
+  return result;
+}
+
+bool TestClock() {
+  bool result = true;
+  // Timers run in real time even if a virtual timestamp is set.
+  moui::Clock::SetVirtualTimestamp(1000);
+  std::atomic<int> count(0);
+  moui::Clock::DispatchAfter(0.02, [&count] { count += 1; });
+  const moui::Clock::Handle kHandle = moui::Clock::DispatchAfter(
+      0.04, [&count] { count += 10; });
+  result &= Expect(moui::Clock::CancelCallback(kHandle),
+                   "background callbacks are cancelled");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  result &= Expect(count == 1, "background callbacks fire in real time");
+
+  moui::TimerQueue* queue = moui::Clock::GetMainThreadTimerQueue();
+  int main_thread_count = 0;
+  moui::Clock::ExecuteCallbackOnMainThread(
+      [&main_thread_count] { ++main_thread_count; });
+  result &= Expect(PollReadable(queue->wakeup_fd(), 1000),
+                   "main thread callbacks wake up the main loop");
+  queue->FireDueTimers(moui::TimerQueue::GetCurrentTimestamp());
+  result &= Expect(main_thread_count == 1,
+                   "main thread callbacks fire when due");
+  moui::Clock::SetVirtualTimestamp(-1);
+  moui::Clock::Reset();
+  return result;
+}
+
+bool TestOrdering() {
+  moui::TimerQueue queue;
+  std::vector<int> order;
+  queue.Schedule(3, [&order] { order.push_back(3); });
+  queue.Schedule(1, [&order] { order.push_back(1); });
+  queue.Schedule(2, [&order] { order.push_back(21); });
+  queue.Schedule(2, [&order, &queue] {
+    order.push_back(22);
+    queue.Schedule(0, [&order] { order.push_back(0); });
+  });
+  bool result = true;
+  result &= Expect(queue.GetNextTimestamp() == 1,
+                   "the earliest timer comes first");
+  result &= Expect(queue.FireDueTimers(2) == 3, "due timers fire in a batch");
+  result &= Expect(order == std::vector<int>({1, 21, 22}),
+                   "timers fire by timestamp and then by scheduling order");
+  result &= Expect(queue.FireDueTimers(2) == 1,
+                   "timers scheduled by callbacks fire in a later batch");
+  result &= Expect(queue.GetNextTimestamp() == 3,
+                   "timers that are not due stay scheduled");
+  return result;
+}
+
+bool TestWakeupFd() {
+  moui::TimerQueue queue(true);
+  bool result = Expect(queue.wakeup_fd() >= 0, "the wakeup fd is created");
+  if (!result)
+    return false;
+  bool fired = false;
+  const double kTimestamp = moui::TimerQueue::GetCurrentTimestamp();
+  queue.Schedule(kTimestamp + 0.05, [&fired] { fired = true; });
+  queue.Schedule(kTimestamp + 10, [] {});
+  result &= Expect(!PollReadable(queue.wakeup_fd(), 0),
+                   "the wakeup fd waits for the earliest timer");
+  result &= Expect(PollReadable(queue.wakeup_fd(), 1000),
+                   "the wakeup fd becomes readable when a timer is due");
+  queue.FireDueTimers(moui::TimerQueue::GetCurrentTimestamp());
+  result &= Expect(fired, "the due timer fires");
+  result &= Expect(!PollReadable(queue.wakeup_fd(), 50),
+                   "firing drains and re-arms the wakeup fd");
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  bool result = true;
+  result &= TestCancellation();
+  result &= TestClock();
+  result &= TestOrdering();
+  result &= TestWakeupFd();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
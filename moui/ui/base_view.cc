@@ -25,7 +25,9 @@
 
 namespace moui {
 
-BaseView::BaseView() : NativeView(nullptr), animation_count_(0) {
+BaseView::BaseView()
+    : NativeView(nullptr), animation_count_(0),
+      platform_event_(Event::Type::kUnknown) {
 }
 
 BaseView::~BaseView() {
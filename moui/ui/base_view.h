@@ -35,6 +35,12 @@ class BaseView : public NativeView {
   BaseView();
   ~BaseView();
 
+  // This method gets called by platforms reporting when frames are displayed,
+  // after the frame rendered by the latest `Render()` call is presented. The
+  // `timestamp` is when the frame is displayed in the time base of
+  // `Clock::GetTimestamp()`.
+  virtual void DidPresentFrame(const double timestamp) {}
+
   // This method gets called when the view received an event. To receive events,
   // the `ShouldHandleEvent()` method should be overriden to return `true`.
   virtual void HandleEvent(Event* event) {}
@@ -67,6 +73,19 @@ class BaseView : public NativeView {
   // implemented in the subclass to change the default behavior.
   virtual bool ShouldHandleEvent(const Point location) { return false; }
 
+  // This method gets called when a scroll event of the passed delta is about
+  // to occur at the passed location of the cursor. The returned boolean
+  // indicates whether the view should handle the scroll event. By default it
+  // returns `false` so the platform passes scroll events to the next
+  // responder.
+  virtual bool ShouldHandleScrollEvent(const Point location,
+                                       const Point delta) {
+    return false;
+  }
+
+  // Accessors and setters.
+  Event* platform_event() { return &platform_event_; }
+
  private:
   // This is a bridge method for calling the corresponded function implemented
   // in native OpenGL view. This method is implemented in the `View` subclass
@@ -84,6 +103,12 @@ class BaseView : public NativeView {
   // value. A view is treated as animating if this value is greater than 0.
   int animation_count_;
 
+  // The event platform bridges reinitialize with `Event::Reset()` for every
+  // platform event before passing it to `HandleEvent()`. Events are handled
+  // one at a time on the main thread, so reusing the event allocates no
+  // memory once its storage is large enough.
+  Event platform_event_;
+
   DISALLOW_COPY_AND_ASSIGN(BaseView);
 };
 
@@ -19,6 +19,9 @@
 
 #import <QuartzCore/QuartzCore.h>
 
+#include <algorithm>
+
+#include "moui/core/clock.h"
 #include "moui/core/event.h"
 #include "moui/ui/view.h"
 #include "moui/widgets/widget.h"
@@ -64,13 +67,31 @@
 }
 
 - (void)handleEvent:(UIEvent *)event withType:(moui::Event::Type)type {
-  moui::Event mouiEvent(type);
+  // Converts timestamps in system uptime to the time base of `moui::Clock`.
+  const double kTimeOffset = moui::Clock::GetTimestamp() - \
+                             [[NSProcessInfo processInfo] systemUptime];
+  moui::Event* mouiEvent = _mouiView->platform_event();
+  mouiEvent->Reset(type, kTimeOffset + event.timestamp);
   for (UITouch* nativeTouch in [event allTouches]) {
+    const int kPointerId = static_cast<int>([nativeTouch hash]);
+    // Adds the touches coalesced since the last event as historical samples.
+    // The last coalesced touch is the same as the touch itself.
+    NSArray<UITouch*>* coalescedTouches = \
+        [event coalescedTouchesForTouch:nativeTouch];
+    for (NSUInteger i = 0; i + 1 < coalescedTouches.count; ++i) {
+      UITouch* coalescedTouch = coalescedTouches[i];
+      CGPoint location = [coalescedTouch locationInView:self];
+      mouiEvent->historical_samples()->push_back(
+          {kPointerId,
+           {static_cast<float>(location.x), static_cast<float>(location.y)},
+           kTimeOffset + coalescedTouch.timestamp});
+    }
     CGPoint location = [nativeTouch locationInView:self];
-    mouiEvent.locations()->push_back({static_cast<float>(location.x),
-                                      static_cast<float>(location.y)});
+    mouiEvent->locations()->push_back({static_cast<float>(location.x),
+                                       static_cast<float>(location.y)});
+    mouiEvent->pointer_ids()->push_back(kPointerId);
   }
-  _mouiView->HandleEvent(&mouiEvent);
+  _mouiView->HandleEvent(mouiEvent);
 }
 
 - (void)render {
@@ -98,6 +119,11 @@
   [self prepareDrawable];
   if (_mouiView->Render()) {
     [self presentDrawable];
+    // Reports when the frame is displayed, which is the target timestamp of
+    // the display link converted to the time base of `moui::Clock`.
+    const double kDisplayDelay = \
+        std::max(0.0, _displayLink.targetTimestamp - CACurrentMediaTime());
+    _mouiView->DidPresentFrame(moui::Clock::GetTimestamp() + kDisplayDelay);
   }
 
   // Pauses display link if stopped updating view and no redraw request.
@@ -17,8 +17,19 @@
 
 #import "moui/ui/mac/MOView.h"
 
+#include "moui/core/clock.h"
+#include "moui/core/event.h"
 #include "moui/ui/view.h"
 
+namespace {
+
+// The distance in points to scroll for each line reported by mouse wheels
+// without precise scrolling deltas. This matches the default line scroll of
+// `NSScrollView`.
+const CGFloat kLineScrollDistance = 10;
+
+}  // namespace
+
 @interface MOView (PrivateDelegateHandling)
 
 // Converts NSView's point to moui's coordinate system.
@@ -27,6 +38,11 @@
 // Dispatches received events to the corresponded moui view.
 - (void)handleEvent:(NSEvent*)event withType:(moui::Event::Type)type;
 
+// Returns the moui event reset for the passed event and type. The returned
+// event is reused for all events.
+- (moui::Event*)mouiEventForEvent:(NSEvent*)event
+                         withType:(moui::Event::Type)type;
+
 // The callback function of `CVDisplayLink`.
 static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
                                   const CVTimeStamp* now,
@@ -40,6 +56,9 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
 // automatically.
 - (void)render;
 
+// Returns the scroll delta of the passed scroll wheel event in points.
+- (moui::Point)scrollDeltaForEvent:(NSEvent*)event;
+
 // Updates drawable if the view size is changed. Returns `YES` if drawable
 // is updated.
 - (BOOL)updateDrawableIfSizeChanged;
@@ -56,14 +75,23 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
 }
 
 - (void)handleEvent:(NSEvent *)event withType:(moui::Event::Type)type {
-  moui::Event mouiEvent(type);
+  _mouiView->HandleEvent([self mouiEventForEvent:event withType:type]);
+}
+
+- (moui::Event*)mouiEventForEvent:(NSEvent*)event
+                         withType:(moui::Event::Type)type {
+  moui::Event* mouiEvent = _mouiView->platform_event();
+  // Converts the timestamp in system uptime to the time base of `moui::Clock`.
+  mouiEvent->Reset(type, moui::Clock::GetTimestamp() -
+                         [[NSProcessInfo processInfo] systemUptime] +
+                         [event timestamp]);
   // Adds the event location.
   NSPoint locationInWindow = [event locationInWindow];
   NSPoint locationInView = [self convertPoint:locationInWindow fromView:self];
   NSPoint location = [self convertToInternalPoint:locationInView];
-  mouiEvent.locations()->push_back({static_cast<float>(location.x),
-                                    static_cast<float>(location.y)});
-  _mouiView->HandleEvent(&mouiEvent);
+  mouiEvent->locations()->push_back({static_cast<float>(location.x),
+                                     static_cast<float>(location.y)});
+  return mouiEvent;
 }
 
 // The callback function of MOView's `_displayLink` for updating the view.
@@ -99,6 +127,14 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
   }
 }
 
+- (moui::Point)scrollDeltaForEvent:(NSEvent*)event {
+  // Mouse wheels without precise deltas report the number of lines instead.
+  const CGFloat kMultiplier = \
+      [event hasPreciseScrollingDeltas] ? 1 : kLineScrollDistance;
+  return {static_cast<float>([event scrollingDeltaX] * kMultiplier),
+          static_cast<float>([event scrollingDeltaY] * kMultiplier)};
+}
+
 - (BOOL)updateDrawableIfSizeChanged {
   NSRect backingRect = [self convertRectToBacking:self.bounds];
   if (backingRect.size.width == _drawableSize.width &&
@@ -151,6 +187,16 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
                                    (__bridge void*)_displaySource);
 
     CVDisplayLinkSetCurrentCGDisplay(_displayLink, CGMainDisplayID());
+
+    // Tracks the cursor moving over the view for hover events.
+    NSTrackingArea* trackingArea = [[NSTrackingArea alloc]
+        initWithRect:NSZeroRect
+             options:(NSTrackingMouseEnteredAndExited |
+                      NSTrackingMouseMoved | NSTrackingActiveInKeyWindow |
+                      NSTrackingInVisibleRect)
+               owner:self
+            userInfo:nil];
+    [self addTrackingArea:trackingArea];
   }
   return self;
 }
@@ -172,8 +218,18 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
 
 - (NSView *)hitTest:(NSPoint)parentViewPoint {
   NSPoint point = [self convertToInternalPoint:parentViewPoint];
-  if (_mouiView->ShouldHandleEvent({static_cast<float>(point.x),
-                                    static_cast<float>(point.y)}))
+  const moui::Point kLocation = {static_cast<float>(point.x),
+                                 static_cast<float>(point.y)};
+  // Scroll events are resolved separately so they never interfere with the
+  // responders of an ongoing touch sequence.
+  NSEvent* currentEvent = [NSApp currentEvent];
+  if ([currentEvent type] == NSEventTypeScrollWheel) {
+    if (_mouiView->ShouldHandleScrollEvent(
+            kLocation, [self scrollDeltaForEvent:currentEvent]))
+      return self;
+    return nil;  // passes to the next responder
+  }
+  if (_mouiView->ShouldHandleEvent(kLocation))
     return self;
   return nil;  // passes to the next responder
 }
@@ -186,6 +242,18 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
   [self handleEvent:event withType:moui::Event::Type::kMove];
 }
 
+- (void)mouseEntered:(NSEvent *)event {
+  [self handleEvent:event withType:moui::Event::Type::kHoverEnter];
+}
+
+- (void)mouseExited:(NSEvent *)event {
+  [self handleEvent:event withType:moui::Event::Type::kHoverLeave];
+}
+
+- (void)mouseMoved:(NSEvent *)event {
+  [self handleEvent:event withType:moui::Event::Type::kHoverMove];
+}
+
 - (void)mouseUp:(NSEvent *)event {
   [self handleEvent:event withType:moui::Event::Type::kUp];
 }
@@ -197,6 +265,30 @@ static CVReturn displaySourceLoop(CVDisplayLinkRef displayLink,
   [self render];
 }
 
+- (void)scrollWheel:(NSEvent *)event {
+  moui::Event* mouiEvent = [self mouiEventForEvent:event
+                                          withType:moui::Event::Type::kScroll];
+  mouiEvent->set_scroll_delta([self scrollDeltaForEvent:event]);
+  // Determines the phase. Momentum events have no phase but a momentum
+  // phase instead.
+  const NSEventPhase kPhase = [event phase];
+  const NSEventPhase kMomentumPhase = [event momentumPhase];
+  moui::Event::ScrollPhase phase = moui::Event::ScrollPhase::kChanged;
+  if (kMomentumPhase != NSEventPhaseNone) {
+    phase = (kMomentumPhase & (NSEventPhaseEnded | NSEventPhaseCancelled)) ?
+            moui::Event::ScrollPhase::kMomentumEnded :
+            moui::Event::ScrollPhase::kMomentum;
+  } else if (kPhase == NSEventPhaseNone) {
+    phase = moui::Event::ScrollPhase::kNone;
+  } else if (kPhase & (NSEventPhaseBegan | NSEventPhaseMayBegin)) {
+    phase = moui::Event::ScrollPhase::kBegan;
+  } else if (kPhase & (NSEventPhaseEnded | NSEventPhaseCancelled)) {
+    phase = moui::Event::ScrollPhase::kEnded;
+  }
+  mouiEvent->set_scroll_phase(phase);
+  _mouiView->HandleEvent(mouiEvent);
+}
+
 - (void)setNeedsRedraw {
   @synchronized(self) {
     if (!_stopsUpdatingView && _needsRedraw)
@@ -19,10 +19,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
 
 #include "moui/base.h"
 #include "moui/core/clock.h"
-#include "moui/core/device.h"
 #include "moui/nanovg_hook.h"
 #include "moui/widgets/control.h"
 #include "moui/widgets/label.h"
@@ -38,12 +40,36 @@ enum class ControlStateIndex {
   kSelected,
 };
 
+// The index corresponded to each rendered state variant.
+enum class RasterIndex {
+  kNormal = 0,
+  kNormalWithHighlightedEffect,
+  kHighlighted,
+  kDisabled,
+  kSelected,
+  kSelectedWithHighlightedEffect,
+};
+
+// A state raster shared by buttons of the same appearance key.
+struct SharedStateRaster {
+  // The strong reference to the framebuffer holding the rendering result.
+  NVGframebuffer* framebuffer;
+  // The number of buttons using the framebuffer.
+  int reference_count;
+};
+
+// The number of bytes taken by each pixel of a framebuffer.
+const int kBytesPerPixel = 4;
+
 // The default opacity for rendering the button with semi transparent style.
 const float kDefaultSemiTransparentStyleOpacity = 0.5;
 
 // The number of ControlStates constants.
 const int kNumberOfControlStates = 4;
 
+// The number of RasterIndex constants.
+const int kNumberOfStateRasters = 6;
+
 // The duration in seconds for transition happened when a finger dragged into
 // the bounds of the button.
 const double kTransitionDragEnterDuration = 0.2;
@@ -52,6 +78,21 @@ const double kTransitionDragEnterDuration = 0.2;
 // from within a button to outside its bounds.
 const double kTransitionDragExitDuration = 0.1;
 
+// The duration in seconds a state raster is kept without being displayed.
+const double kUnusedStateRasterLifetime = 10;
+
+// The state rasters shared by all buttons keyed by
+// `Button::GetSharedRasterKey()`.
+std::map<std::string, SharedStateRaster> shared_state_rasters;
+
+// Returns the number of bytes taken by the passed framebuffer.
+int GetFramebufferBytes(NVGframebuffer* framebuffer) {
+  int width = 0;
+  int height = 0;
+  nvgImageSize(framebuffer->ctx, framebuffer->image, &width, &height);
+  return width * height * kBytesPerPixel;
+}
+
 }  // namespace
 
 namespace moui {
@@ -63,16 +104,12 @@ Button::Button() : Control(false),
                    darkness_(0),
                    default_disabled_style_(Style::kSemiTransparent),
                    default_highlighted_style_(Style::kSemiTransparent),
-                   disabled_state_framebuffer_(nullptr),
                    final_framebuffer_(nullptr),
-                   highlighted_state_framebuffer_(nullptr),
-                   normal_state_framebuffer_(nullptr),
-                   normal_state_with_highlighted_effect_framebuffer_(nullptr),
                    previous_framebuffer_(nullptr),
-                   selected_state_framebuffer_(nullptr),
-                   selected_state_with_highlighted_effect_framebuffer_(nullptr),
                    semi_transparent_style_opacity_(
                        kDefaultSemiTransparentStyleOpacity),
+                   state_rasters_(kNumberOfStateRasters,
+                                  StateRaster{nullptr, "", 0, 0}),
                    title_edge_insets_({0, 0, 0, 0}),
                    title_label_(new Label) {
   transition_states_.is_transitioning = false;
@@ -108,6 +145,9 @@ Button::Button() : Control(false),
 }
 
 Button::~Button() {
+  for (int i = 0; i < kNumberOfStateRasters; ++i)
+    ReleaseStateRaster(i);
+  nvgDeleteFramebuffer(transition_states_.framebuffer);
   moui::Widget::SmartRelease(title_label_);
 }
 
@@ -117,30 +157,26 @@ void Button::BindRenderFunction(
   if (states & ControlState::kNormal) {
     render_functions_[GetControlStateIndex(ControlState::kNormal)] = \
         render_function;
-    nvgDeleteFramebuffer(normal_state_framebuffer_);
-    nvgDeleteFramebuffer(normal_state_with_highlighted_effect_framebuffer_);
-    normal_state_framebuffer_ = nullptr;
-    normal_state_with_highlighted_effect_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kNormal));
+    ReleaseStateRaster(
+        static_cast<int>(RasterIndex::kNormalWithHighlightedEffect));
   }
   if (states & ControlState::kHighlighted) {
     render_functions_[GetControlStateIndex(ControlState::kHighlighted)] = \
         render_function;
-    nvgDeleteFramebuffer(highlighted_state_framebuffer_);
-    highlighted_state_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kHighlighted));
   }
   if (states & ControlState::kDisabled) {
     render_functions_[GetControlStateIndex(ControlState::kDisabled)] = \
         render_function;
-    nvgDeleteFramebuffer(disabled_state_framebuffer_);
-    disabled_state_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kDisabled));
   }
   if (states & ControlState::kSelected) {
     render_functions_[GetControlStateIndex(ControlState::kSelected)] = \
         render_function;
-    nvgDeleteFramebuffer(selected_state_framebuffer_);
-    nvgDeleteFramebuffer(selected_state_with_highlighted_effect_framebuffer_);
-    selected_state_framebuffer_ = nullptr;
-    selected_state_with_highlighted_effect_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kSelected));
+    ReleaseStateRaster(
+        static_cast<int>(RasterIndex::kSelectedWithHighlightedEffect));
   }
 }
 
@@ -221,6 +257,39 @@ std::string Button::GetTitle(const ControlState state) const {
   return titles_[GetControlStateIndex(ControlState::kNormal)];
 }
 
+int Button::GetRasterMemoryUsage() const {
+  int bytes = 0;
+  for (const StateRaster& raster : state_rasters_) {
+    if (raster.framebuffer == nullptr)
+      continue;
+    int reference_count = 1;
+    if (!raster.shared_key.empty()) {
+      reference_count = \
+          shared_state_rasters.at(raster.shared_key).reference_count;
+    }
+    bytes += GetFramebufferBytes(raster.framebuffer) / reference_count;
+  }
+  if (transition_states_.framebuffer != nullptr)
+    bytes += GetFramebufferBytes(transition_states_.framebuffer);
+  return bytes;
+}
+
+std::string Button::GetSharedRasterKey(NVGcontext* context,
+                                       const int raster_index) {
+  const float kScaleFactor = GetRasterScaleFactor();
+  return appearance_key_ + "/" +
+         std::to_string(reinterpret_cast<uintptr_t>(context)) + "/" +
+         std::to_string(raster_index) + "/" +
+         std::to_string(static_cast<int>(GetWidth() * kScaleFactor)) + "x" +
+         std::to_string(static_cast<int>(GetHeight() * kScaleFactor)) + "/" +
+         std::to_string(kScaleFactor) + "/" +
+         std::to_string(rendering_scale()) + "/" +
+         std::to_string(darkness_) + "/" +
+         std::to_string(static_cast<int>(default_disabled_style_)) + "/" +
+         std::to_string(static_cast<int>(default_highlighted_style_)) + "/" +
+         std::to_string(semi_transparent_style_opacity_);
+}
+
 NVGcolor Button::GetTitleColor(const ControlState state) const {
   return title_colors_[GetControlStateIndex(state)];
 }
@@ -249,13 +318,13 @@ void Button::Render(NVGcontext* context) {
 // example, if the current state is selected but there is no render function
 // binded. The normal state will be rendered instead.
 void Button::RenderFramebuffer(NVGcontext* context) {
-  // Determines what state to render and which framebuffer to render to.
-  NVGframebuffer** framebuffer;
+  // Determines what state to render and which raster to render to.
+  RasterIndex raster_index;
   ControlState state = ControlState::kNormal;
   bool renders_default_disabled_effect = false;
   bool renders_default_highlighted_effect = false;
   if (IsDisabled()) {
-    framebuffer = &disabled_state_framebuffer_;
+    raster_index = RasterIndex::kDisabled;
     if (RenderFunctionIsBinded(ControlState::kDisabled)) {
       state = ControlState::kDisabled;
     } else {
@@ -265,55 +334,59 @@ void Button::RenderFramebuffer(NVGcontext* context) {
     }
   } else if (IsHighlighted()) {
     if (RenderFunctionIsBinded(ControlState::kHighlighted)) {
-      framebuffer = &highlighted_state_framebuffer_;
+      raster_index = RasterIndex::kHighlighted;
       state = ControlState::kHighlighted;
     } else if (IsSelected() &&
                RenderFunctionIsBinded(ControlState::kSelected)) {
-      framebuffer = &selected_state_with_highlighted_effect_framebuffer_;
+      raster_index = RasterIndex::kSelectedWithHighlightedEffect;
       state = ControlState::kSelected;
       renders_default_highlighted_effect = true;
     // } else if (IsSelected()) {
-    //   framebuffer = &selected_state_with_highlighted_effect_framebuffer_;
+    //   raster_index = RasterIndex::kSelectedWithHighlightedEffect;
     //   renders_default_highlighted_effect = true;
     } else if (default_highlighted_style_ == Style::kNone) {
-      framebuffer = &normal_state_framebuffer_;
+      raster_index = RasterIndex::kNormal;
     } else {
-      framebuffer = &normal_state_with_highlighted_effect_framebuffer_;
+      raster_index = RasterIndex::kNormalWithHighlightedEffect;
       renders_default_highlighted_effect = true;
     }
   } else if (IsSelected()) {
-    framebuffer = &selected_state_framebuffer_;
+    raster_index = RasterIndex::kSelected;
     if (RenderFunctionIsBinded(ControlState::kSelected))
       state = ControlState::kSelected;
   } else {
-    framebuffer = &normal_state_framebuffer_;
+    raster_index = RasterIndex::kNormal;
   }
+  const int kRasterIndex = static_cast<int>(raster_index);
+  StateRaster& raster = state_rasters_[kRasterIndex];
 
-  // Deletes the framebuffer if the expected framebuffer size has been changed.
-  if (*framebuffer != nullptr) {
-    const float kScaleFactor = \
-        Device::GetScreenScaleFactor() * GetMeasuredScale();
+  // Releases the raster if the expected raster size has been changed or it
+  // should be rendered again at the current scale.
+  if (raster.framebuffer != nullptr) {
+    const float kScaleFactor = GetRasterScaleFactor();
     int framebuffer_width = 0;
     int framebuffer_height = 0;
-    nvgImageSize((*framebuffer)->ctx, (*framebuffer)->image,
+    nvgImageSize(raster.framebuffer->ctx, raster.framebuffer->image,
                  &framebuffer_width, &framebuffer_height);
     if (framebuffer_width != static_cast<int>(GetWidth() * kScaleFactor) ||
-        framebuffer_height != static_cast<int>(GetHeight() * kScaleFactor)) {
-      nvgDeleteFramebuffer(*framebuffer);
-      *framebuffer = nullptr;
+        framebuffer_height != static_cast<int>(GetHeight() * kScaleFactor) ||
+        ShouldRasterizeAgain(raster.scale_factor)) {
+      ReleaseStateRaster(kRasterIndex);
     }
   }
-  // Renders the new framebuffer.
-  if (*framebuffer == nullptr) {
-    RenderFramebufferForControlState(context, framebuffer, state,
-                                     renders_default_disabled_effect,
-                                     renders_default_highlighted_effect);
+  // Renders the new raster.
+  if (raster.framebuffer == nullptr) {
+    RenderStateRaster(context, kRasterIndex, state,
+                      renders_default_disabled_effect,
+                      renders_default_highlighted_effect);
   }
+  raster.last_used_timestamp = Clock::GetTimestamp();
   // Updates the `current_framebuffer_` and `previous_framebuffer_` properties.
-  if (*framebuffer != current_framebuffer_) {
+  if (raster.framebuffer != current_framebuffer_) {
     previous_framebuffer_ = current_framebuffer_;
-    current_framebuffer_ = *framebuffer;
+    current_framebuffer_ = raster.framebuffer;
   }
+  ReleaseUnusedStateRasters(kRasterIndex);
 
   if (transition_states_.is_transitioning &&
       RenderFramebufferForTransition(context, &transition_states_.framebuffer))
@@ -389,8 +462,10 @@ bool Button::RenderFramebufferForControlState(
 
 bool Button::RenderFramebufferForTransition(NVGcontext* context,
                                             NVGframebuffer** framebuffer) {
-  if (!transition_states_.is_transitioning)
+  if (!transition_states_.is_transitioning ||
+      previous_framebuffer_ == nullptr || current_framebuffer_ == nullptr) {
     return false;
+  }
 
   float scale_factor;
   if (!BeginFramebufferUpdates(context, framebuffer, &scale_factor)) {
@@ -425,25 +500,86 @@ bool Button::RenderFunctionIsBinded(const ControlState state) const {
   return render_functions_[GetControlStateIndex(state)] != NULL;
 }
 
+bool Button::RenderStateRaster(NVGcontext* context, const int raster_index,
+                               const ControlState control_state,
+                               const bool renders_default_disabled_effect,
+                               const bool renders_default_highlighted_effect) {
+  StateRaster& raster = state_rasters_[raster_index];
+  raster.scale_factor = GetRasterScaleFactor();
+  if (appearance_key_.empty()) {
+    return RenderFramebufferForControlState(
+        context, &raster.framebuffer, control_state,
+        renders_default_disabled_effect, renders_default_highlighted_effect);
+  }
+
+  // Takes over the raster rendered by another button of the same appearance.
+  const std::string kSharedKey = GetSharedRasterKey(context, raster_index);
+  auto match = shared_state_rasters.find(kSharedKey);
+  if (match != shared_state_rasters.end()) {
+    ++match->second.reference_count;
+    raster.framebuffer = match->second.framebuffer;
+    raster.shared_key = kSharedKey;
+    return true;
+  }
+  if (!RenderFramebufferForControlState(
+          context, &raster.framebuffer, control_state,
+          renders_default_disabled_effect,
+          renders_default_highlighted_effect)) {
+    return false;
+  }
+  shared_state_rasters[kSharedKey] = {raster.framebuffer, 1};
+  raster.shared_key = kSharedKey;
+  return true;
+}
+
+void Button::ReleaseStateRaster(const int raster_index) {
+  StateRaster& raster = state_rasters_[raster_index];
+  if (raster.framebuffer == nullptr)
+    return;
+
+  if (current_framebuffer_ == raster.framebuffer)
+    current_framebuffer_ = nullptr;
+  if (final_framebuffer_ == raster.framebuffer)
+    final_framebuffer_ = nullptr;
+  if (previous_framebuffer_ == raster.framebuffer)
+    previous_framebuffer_ = nullptr;
+
+  if (raster.shared_key.empty()) {
+    nvgDeleteFramebuffer(raster.framebuffer);
+  } else {
+    auto match = shared_state_rasters.find(raster.shared_key);
+    if (--match->second.reference_count == 0) {
+      nvgDeleteFramebuffer(match->second.framebuffer);
+      shared_state_rasters.erase(match);
+    }
+    raster.shared_key.clear();
+  }
+  raster.framebuffer = nullptr;
+}
+
+void Button::ReleaseUnusedStateRasters(const int displayed_raster_index) {
+  const double kTimestamp = Clock::GetTimestamp();
+  for (int i = 0; i < kNumberOfStateRasters; ++i) {
+    const StateRaster& kRaster = state_rasters_[i];
+    if (i == displayed_raster_index || kRaster.framebuffer == nullptr ||
+        (transition_states_.is_transitioning &&
+         kRaster.framebuffer == previous_framebuffer_) ||
+        kTimestamp - kRaster.last_used_timestamp < kUnusedStateRasterLifetime) {
+      continue;
+    }
+    ReleaseStateRaster(i);
+  }
+}
+
 void Button::ResetFramebuffers() {
   StopTransitioningBetweenControlStates(this);
-  nvgDeleteFramebuffer(disabled_state_framebuffer_);
-  nvgDeleteFramebuffer(highlighted_state_framebuffer_);
-  nvgDeleteFramebuffer(normal_state_framebuffer_);
-  nvgDeleteFramebuffer(normal_state_with_highlighted_effect_framebuffer_);
-  nvgDeleteFramebuffer(selected_state_framebuffer_);
-  nvgDeleteFramebuffer(selected_state_with_highlighted_effect_framebuffer_);
+  for (int i = 0; i < kNumberOfStateRasters; ++i)
+    ReleaseStateRaster(i);
   nvgDeleteFramebuffer(transition_states_.framebuffer);
 
   current_framebuffer_ = nullptr;
-  disabled_state_framebuffer_ = nullptr;
   final_framebuffer_ = nullptr;
-  highlighted_state_framebuffer_ = nullptr;
-  normal_state_framebuffer_ = nullptr;
-  normal_state_with_highlighted_effect_framebuffer_ = nullptr;
   previous_framebuffer_ = nullptr;
-  selected_state_framebuffer_ = nullptr;
-  selected_state_with_highlighted_effect_framebuffer_ = nullptr;
   transition_states_.framebuffer = nullptr;
 }
 
@@ -516,24 +652,20 @@ void Button::TransitionBetweenControlStates(Control* control) {
 void Button::UnbindRenderFunction(const ControlState states) {
   if (states & ControlState::kNormal) {
     render_functions_[GetControlStateIndex(ControlState::kNormal)] = NULL;
-    nvgDeleteFramebuffer(normal_state_framebuffer_);
-    normal_state_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kNormal));
   } else if (states & ControlState::kHighlighted) {
     render_functions_[GetControlStateIndex(ControlState::kHighlighted)] = NULL;
-    nvgDeleteFramebuffer(highlighted_state_framebuffer_);
-    nvgDeleteFramebuffer(normal_state_with_highlighted_effect_framebuffer_);
-    nvgDeleteFramebuffer(selected_state_with_highlighted_effect_framebuffer_);
-    highlighted_state_framebuffer_ = nullptr;
-    normal_state_with_highlighted_effect_framebuffer_ = nullptr;
-    selected_state_with_highlighted_effect_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kHighlighted));
+    ReleaseStateRaster(
+        static_cast<int>(RasterIndex::kNormalWithHighlightedEffect));
+    ReleaseStateRaster(
+        static_cast<int>(RasterIndex::kSelectedWithHighlightedEffect));
   } else if (states & ControlState::kSelected) {
     render_functions_[GetControlStateIndex(ControlState::kSelected)] = NULL;
-    nvgDeleteFramebuffer(selected_state_framebuffer_);
-    selected_state_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kSelected));
   } else if (states & ControlState::kDisabled) {
     render_functions_[GetControlStateIndex(ControlState::kDisabled)] = NULL;
-    nvgDeleteFramebuffer(disabled_state_framebuffer_);
-    disabled_state_framebuffer_ = nullptr;
+    ReleaseStateRaster(static_cast<int>(RasterIndex::kDisabled));
   }
 }
 
@@ -635,12 +767,21 @@ void Button::set_adjusts_button_width_to_fit_title_label(const bool value) {
   }
 }
 
+void Button::set_appearance_key(const std::string& appearance_key) {
+  if (appearance_key == appearance_key_)
+    return;
+
+  for (int i = 0; i < kNumberOfStateRasters; ++i)
+    ReleaseStateRaster(i);
+  appearance_key_ = appearance_key;
+  Redraw();
+}
+
 void Button::set_default_disabled_style(const Style style) {
   if (style == default_disabled_style_)
     return;
 
-  nvgDeleteFramebuffer(disabled_state_framebuffer_);
-  disabled_state_framebuffer_ = nullptr;
+  ReleaseStateRaster(static_cast<int>(RasterIndex::kDisabled));
   default_disabled_style_ = style;
 }
 
@@ -648,10 +789,10 @@ void Button::set_default_highlighted_style(const Style style) {
   if (style == default_highlighted_style_)
     return;
 
-  nvgDeleteFramebuffer(normal_state_with_highlighted_effect_framebuffer_);
-  nvgDeleteFramebuffer(selected_state_with_highlighted_effect_framebuffer_);
-  normal_state_with_highlighted_effect_framebuffer_ = nullptr;
-  selected_state_with_highlighted_effect_framebuffer_ = nullptr;
+  ReleaseStateRaster(
+      static_cast<int>(RasterIndex::kNormalWithHighlightedEffect));
+  ReleaseStateRaster(
+      static_cast<int>(RasterIndex::kSelectedWithHighlightedEffect));
   default_highlighted_style_ = style;
 }
 
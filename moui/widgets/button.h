@@ -36,6 +36,11 @@ class Label;
 // `Control` class. In addtion, this class provides methods for setting the
 // title, render function, and other appearance properties to change the
 // appearance for each button state.
+//
+// Each state is rendered into a raster the first time it is displayed, and
+// rasters of states not displayed for a while are released when the button
+// renders again. Buttons given the same `appearance_key()` share rasters of
+// the same state and size instead of rendering their own.
 class Button : public Control {
  public:
   // The style of the highlighted state to render if no corresponded render
@@ -92,6 +97,11 @@ class Button : public Control {
   // Returns the current title that is displayed on the button.
   std::string GetCurrentTitle() const;
 
+  // Returns the number of bytes taken by the framebuffers of the button. A
+  // raster shared with other buttons counts in proportion to the number of
+  // buttons sharing it, so the sum over all buttons is the actual usage.
+  int GetRasterMemoryUsage() const;
+
   // Returns the title associated with the specified state. If no title has
   // been set for the specific state, this method returns the title associated
   // with the `ControlState::kNormal` state.
@@ -121,6 +131,8 @@ class Button : public Control {
     return adjusts_button_height_to_fit_title_label_;
   }
   void set_adjusts_button_width_to_fit_title_label(const bool value);
+  const std::string& appearance_key() const { return appearance_key_; }
+  void set_appearance_key(const std::string& appearance_key);
   float darkness() const { return darkness_; }
   void set_darkness(const float darkness) { darkness_ = darkness; }
   Style default_disabled_style() const {
@@ -173,6 +185,20 @@ class Button : public Control {
     NVGcolor previous_title_color;
   };
 
+  // The rendered raster of a state variant.
+  struct StateRaster {
+    // The framebuffer holding the rendering result, or `nullptr` if the
+    // variant has not been rendered.
+    NVGframebuffer* framebuffer;
+    // The key the framebuffer is shared under, or an empty string if the
+    // framebuffer is owned by the button alone.
+    std::string shared_key;
+    // The timestamp of the last time the raster was displayed.
+    double last_used_timestamp;
+    // The scale factor the raster was rendered at.
+    float scale_factor;
+  };
+
   // Binda a render function for rendering the button with passed states.
   void BindRenderFunction(
       const ControlState states,
@@ -185,6 +211,20 @@ class Button : public Control {
   // Returns the index of the specified control state.
   int GetControlStateIndex(const ControlState state) const;
 
+  // Returns the key for sharing the specified raster with other buttons of
+  // the same `appearance_key_`. The key also covers the context, the raster's
+  // size and every property affecting how states are rendered.
+  std::string GetSharedRasterKey(NVGcontext* context,
+                                 const int raster_index);
+
+  // Releases the raster at the specified index. Shared framebuffers are only
+  // deleted once no button uses them anymore.
+  void ReleaseStateRaster(const int raster_index);
+
+  // Releases all rasters except the specified one that have not been
+  // displayed for `kUnusedStateRasterLifetime` seconds.
+  void ReleaseUnusedStateRasters(const int displayed_raster_index);
+
   // Inherited from `Widget` class. This method takes control of how to render
   // the button. Subclasses should never override this method either.
   // To render customized appearance. Use `BindRenderFunction()` to bind a
@@ -211,6 +251,14 @@ class Button : public Control {
   // Returns `true` if a render function is binded to the passed control state.
   bool RenderFunctionIsBinded(const ControlState state) const;
 
+  // Renders the specified `control_state` to the raster at the specified
+  // index, or takes over a shared raster if there is one. Returns `false` on
+  // failure.
+  bool RenderStateRaster(NVGcontext* context, const int raster_index,
+                         const ControlState control_state,
+                         const bool renders_default_disabled_effect,
+                         const bool renders_default_highlighted_effect);
+
   // Stops transitioning between different control states. The is a callback
   // function for `kTouchCancel`, `kTouchUpInside` and `kTouchUpOutside`
   // control events. And it is called in `WidgetDidRender()` once the
@@ -236,6 +284,12 @@ class Button : public Control {
   // in order to fit the title label's text. The default value is `false`.
   bool adjusts_button_width_to_fit_title_label_;
 
+  // The key identifying buttons that look the same in every state. Buttons
+  // with the same non-empty key share their state rasters if their sizes also
+  // match, so they must bind equivalent render functions. The default value
+  // is an empty string, which disables sharing.
+  std::string appearance_key_;
+
   // Keeps the reference to the framebuffer pointer of current control state.
   // This value is updated in the `RenderFramebuffer()` method.
   NVGframebuffer* current_framebuffer_;
@@ -255,24 +309,11 @@ class Button : public Control {
   // managed title label.
   Style default_highlighted_style_;
 
-  // The framebuffer for rendering the button in disabled state.
-  NVGframebuffer* disabled_state_framebuffer_;
-
   // The reference to the framebuffer pointer that will be actually rendered
   // in the `Render()` method. This value is updated in the
   // `RenderFramebuffer()` method.
   NVGframebuffer* final_framebuffer_;
 
-  // The framebuffer for rendering the button in highlighted state.
-  NVGframebuffer* highlighted_state_framebuffer_;
-
-  // The framebuffer for rendering the button in normal state.
-  NVGframebuffer* normal_state_framebuffer_;
-
-  // The framebuffer for rendering the button in normal state with default
-  // highlighted effect.
-  NVGframebuffer* normal_state_with_highlighted_effect_framebuffer_;
-
   // Keeps the reference to the framebuffer pointer of previous control state.
   // This value is updated in the `RenderFramebuffer()` method.
   NVGframebuffer* previous_framebuffer_;
@@ -284,17 +325,15 @@ class Button : public Control {
   // represent no binded render function.
   std::vector<std::function<void(Button*, NVGcontext*)>> render_functions_;
 
-  // The framebuffer for rendering the button in selected state.
-  NVGframebuffer* selected_state_framebuffer_;
-
-  // The framebuffer for rendering the button in selected state with default
-  // highlighted effect.
-  NVGframebuffer* selected_state_with_highlighted_effect_framebuffer_;
-
   // Indicates the opacity used when rendering the button for
   // `Style::kSemiTransparent`. The default value is 0.5.
   float semi_transparent_style_opacity_;
 
+  // The rasters of every state variant. The vector will be initialized in
+  // constructor to have one element per variant in `RasterIndex`. Rasters are
+  // rendered on first use by `RenderFramebuffer()`.
+  std::vector<StateRaster> state_rasters_;
+
   // Records title colors for every control states.
   std::vector<NVGcolor> title_colors_;
 
@@ -0,0 +1,136 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/cell_snapshot_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "moui/base.h"
+#include "moui/nanovg_hook.h"
+#include "moui/widgets/widget.h"
+
+namespace {
+
+// The number of bytes taken by each pixel of a snapshot.
+const int kBytesPerPixel = 4;
+
+}  // namespace
+
+namespace moui {
+
+CellSnapshotCache::CellSnapshotCache() : capacity_(0), size_(0) {
+}
+
+CellSnapshotCache::~CellSnapshotCache() {
+  Clear();
+}
+
+bool CellSnapshotCache::Capture(Widget* widget, const uint64_t key,
+                                const int64_t version) {
+  const Size kSize = {widget->GetWidth(), widget->GetHeight()};
+  const float kScaleFactor = widget->GetRasterScaleFactor();
+  const int kBytes = static_cast<int>(kSize.width * kScaleFactor) *
+                     static_cast<int>(kSize.height * kScaleFactor) *
+                     kBytesPerPixel;
+
+  // Takes over the framebuffer of the previous snapshot of the key.
+  NVGframebuffer* framebuffer = nullptr;
+  auto match = snapshots_by_key_.find(key);
+  if (match != snapshots_by_key_.end()) {
+    framebuffer = match->second->framebuffer;
+    size_ -= match->second->bytes;
+    snapshots_.erase(match->second);
+    snapshots_by_key_.erase(match);
+  }
+  if (kBytes <= 0 || kBytes > capacity_) {
+    nvgDeleteFramebuffer(framebuffer);
+    return false;
+  }
+
+  Evict(kBytes);
+  if (!widget->RenderToFramebuffer(&framebuffer)) {
+    nvgDeleteFramebuffer(framebuffer);
+    return false;
+  }
+  snapshots_.push_front({key, version, kSize, kBytes, framebuffer});
+  snapshots_by_key_[key] = snapshots_.begin();
+  size_ += kBytes;
+  return true;
+}
+
+void CellSnapshotCache::Clear() {
+  for (Snapshot& snapshot : snapshots_)
+    nvgDeleteFramebuffer(snapshot.framebuffer);
+  snapshots_.clear();
+  snapshots_by_key_.clear();
+  size_ = 0;
+}
+
+void CellSnapshotCache::Evict(const int reserved_bytes) {
+  while (!snapshots_.empty() && size_ + reserved_bytes > capacity_) {
+    Snapshot& snapshot = snapshots_.back();
+    nvgDeleteFramebuffer(snapshot.framebuffer);
+    size_ -= snapshot.bytes;
+    snapshots_by_key_.erase(snapshot.key);
+    snapshots_.pop_back();
+  }
+}
+
+NVGframebuffer* CellSnapshotCache::GetSnapshot(const uint64_t key,
+                                               Size* size) const {
+  auto match = snapshots_by_key_.find(key);
+  if (match == snapshots_by_key_.end())
+    return nullptr;
+  if (size != nullptr)
+    *size = match->second->size;
+  return match->second->framebuffer;
+}
+
+void CellSnapshotCache::Remove(const uint64_t key) {
+  auto match = snapshots_by_key_.find(key);
+  if (match == snapshots_by_key_.end())
+    return;
+  nvgDeleteFramebuffer(match->second->framebuffer);
+  size_ -= match->second->bytes;
+  snapshots_.erase(match->second);
+  snapshots_by_key_.erase(match);
+}
+
+NVGframebuffer* CellSnapshotCache::UseSnapshot(const uint64_t key,
+                                               const int64_t version,
+                                               const Size size) {
+  auto match = snapshots_by_key_.find(key);
+  if (match == snapshots_by_key_.end())
+    return nullptr;
+  auto snapshot = match->second;
+  if (snapshot->version != version || snapshot->size.width != size.width ||
+      snapshot->size.height != size.height) {
+    return nullptr;
+  }
+  snapshots_.splice(snapshots_.begin(), snapshots_, snapshot);
+  return snapshot->framebuffer;
+}
+
+void CellSnapshotCache::set_capacity(const int capacity) {
+  capacity_ = std::max(0, capacity);
+  Evict(0);
+}
+
+}  // namespace moui
@@ -0,0 +1,114 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_CELL_SNAPSHOT_CACHE_H_
+#define MOUI_WIDGETS_CELL_SNAPSHOT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "moui/base.h"
+#include "moui/nanovg_hook.h"
+
+namespace moui {
+
+// Forward declaration.
+class Widget;
+
+// The `CellSnapshotCache` class keeps rasterized snapshots of cells keyed by
+// their locations, so a cell reappearing with the same content can be
+// displayed by compositing its snapshot instead of being configured and
+// rendered again. Each snapshot is tagged with a content version and the
+// size it was captured at, and is only used if both match.
+//
+// The total size of snapshots in bytes is bounded by `capacity()`, and the
+// least recently used snapshots are evicted first.
+class CellSnapshotCache {
+ public:
+  CellSnapshotCache();
+  ~CellSnapshotCache();
+
+  // Renders the specified widget into a snapshot stored under `key` with the
+  // specified content version, replacing any previous snapshot of the key.
+  // Least recently used snapshots are evicted to stay within the capacity.
+  // This method must be called while offscreen rendering is allowed such as
+  // in `Widget::RenderFramebuffer()`. Returns `false` if the snapshot does
+  // not fit in the capacity or cannot be rendered.
+  bool Capture(Widget* widget, const uint64_t key, const int64_t version);
+
+  // Deletes all snapshots.
+  void Clear();
+
+  // Returns the framebuffer of the snapshot stored under `key` regardless of
+  // its version, or `nullptr` if there is none. If `size` is not `nullptr`,
+  // it is set to the size the snapshot was captured at.
+  NVGframebuffer* GetSnapshot(const uint64_t key, Size* size) const;
+
+  // Deletes the snapshot stored under `key` if there is one.
+  void Remove(const uint64_t key);
+
+  // Returns the framebuffer of the snapshot stored under `key` if it matches
+  // the specified version and size, and marks it as the most recently used.
+  // Returns `nullptr` otherwise.
+  NVGframebuffer* UseSnapshot(const uint64_t key, const int64_t version,
+                              const Size size);
+
+  // Setters and accessors.
+  int capacity() const { return capacity_; }
+  void set_capacity(const int capacity);
+  int size() const { return size_; }
+
+ private:
+  // A rasterized snapshot of a cell.
+  struct Snapshot {
+    // The key the snapshot is stored under.
+    uint64_t key;
+    // The content version of the cell when it was captured.
+    int64_t version;
+    // The size of the cell in points when it was captured.
+    Size size;
+    // The number of bytes taken by `framebuffer`.
+    int bytes;
+    // The strong reference to the framebuffer holding the rendering.
+    NVGframebuffer* framebuffer;
+  };
+
+  // Deletes least recently used snapshots until the total size plus
+  // `reserved_bytes` fits in the capacity.
+  void Evict(const int reserved_bytes);
+
+  // The maximum number of bytes taken by all snapshots. The default value is
+  // 0, which disables the cache.
+  int capacity_;
+
+  // The total number of bytes taken by all snapshots.
+  int size_;
+
+  // The snapshots ordered from the most recently used to the least.
+  std::list<Snapshot> snapshots_;
+
+  // Maps keys to their snapshots in `snapshots_`.
+  std::unordered_map<uint64_t, std::list<Snapshot>::iterator>
+      snapshots_by_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(CellSnapshotCache);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_CELL_SNAPSHOT_CACHE_H_
@@ -0,0 +1,325 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/collection_view.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/clock.h"
+#include "moui/core/event.h"
+#include "moui/widgets/scroll_view.h"
+#include "moui/widgets/table_view_cell.h"
+#include "moui/widgets/widget_view.h"
+
+namespace moui {
+
+CollectionView::CollectionView()
+    : ScrollView(), data_source_(nullptr), delegate_(nullptr),
+      down_event_cell_(nullptr), highlight_callback_handle_(0),
+      last_content_view_offset_({-1, -1}), last_size_({-1, -1}),
+      layout_(nullptr), layout_is_invalid_(true), number_of_items_(-1),
+      reusable_cell_pool_(this), should_update_layout_(true) {
+  set_always_bounce_vertical(true);
+  set_always_scroll_both_directions(false);
+}
+
+CollectionView::~CollectionView() {
+  Clock::CancelCallback(highlight_callback_handle_);
+  for (TableViewCell* cell : visible_cells_)
+    moui::Widget::SmartRelease(cell);
+  if (layout_ != nullptr)
+    layout_->collection_view_ = nullptr;
+}
+
+TableViewCell* CollectionView::DequeueReusableCell(
+    const int reuse_identifier_handle) {
+  return reusable_cell_pool_.DequeueCell(reuse_identifier_handle);
+}
+
+TableViewCell* CollectionView::DequeueReusableCell(
+    const std::string& reuse_identifier) {
+  return DequeueReusableCell(
+      TableViewCell::GetReuseIdentifierHandle(reuse_identifier));
+}
+
+// Visible cells are kept in ascending order of their item indexes, so the
+// lookup is a binary search.
+TableViewCell* CollectionView::GetCell(const int item_index) const {
+  auto match = std::lower_bound(visible_item_indexes_.begin(),
+                                visible_item_indexes_.end(), item_index);
+  if (match == visible_item_indexes_.end() || *match != item_index)
+    return nullptr;
+  return visible_cells_[match - visible_item_indexes_.begin()];
+}
+
+int CollectionView::GetItemIndex(TableViewCell* cell) const {
+  auto match = std::find(visible_cells_.begin(), visible_cells_.end(), cell);
+  if (match == visible_cells_.end())
+    return -1;
+  return visible_item_indexes_[match - visible_cells_.begin()];
+}
+
+bool CollectionView::HandleEvent(Event* event) {
+  const bool kResult = ScrollView::HandleEvent(event);
+  if (down_event_cell_ == nullptr)
+    return kResult;
+
+  // Determines the cell's current origin related to the corresponded
+  // widget view's coordinate system.
+  Point origin;
+  down_event_cell_->GetMeasuredBounds(&origin, nullptr);
+
+  if (event->type() == Event::Type::kDown) {
+    down_event_origin_ = origin;
+    // Delay highlights the `down_event_cell_`.
+    Clock::CancelCallback(highlight_callback_handle_);
+    highlight_callback_handle_ = Clock::ExecuteCallbackOnMainThread(
+        0.01,  // delay in seconds
+        std::bind(&CollectionView::HighlightDownEventCell, this));
+  } else if (event->type() == Event::Type::kUp) {
+    SetCellHighlighted(down_event_cell_, false);
+    const int kItemIndex = GetItemIndex(down_event_cell_);
+    down_event_cell_ = nullptr;
+    if (kItemIndex >= 0 && delegate_ != nullptr)
+      delegate_->CollectionViewDidSelectItem(this, kItemIndex);
+  } else if (event->type() == Event::Type::kMove &&
+             (std::abs(origin.x - down_event_origin_.x) >= 1.2 ||
+              std::abs(origin.y - down_event_origin_.y) >= 1.2)) {
+    SetCellHighlighted(down_event_cell_, false);
+    down_event_cell_ = nullptr;
+  } else if (event->type() == Event::Type::kCancel) {
+    SetCellHighlighted(down_event_cell_, false);
+    down_event_cell_ = nullptr;
+  }
+  return kResult;
+}
+
+void CollectionView::HandleMemoryWarning(NVGcontext* context) {
+  ScrollView::HandleMemoryWarning(context);
+  reusable_cell_pool_.ReleaseCells();
+}
+
+void CollectionView::HighlightDownEventCell() {
+  highlight_callback_handle_ = 0;
+  if (down_event_cell_ == nullptr)
+    return;
+  SetCellHighlighted(down_event_cell_, true);
+}
+
+void CollectionView::InvalidateLayout() {
+  layout_is_invalid_ = true;
+  should_update_layout_ = true;
+  if (widget_view() != nullptr)
+    widget_view()->Redraw();
+}
+
+void CollectionView::PrewarmReusableCells(const int reuse_identifier_handle,
+                                          const int number_of_cells) {
+  reusable_cell_pool_.PrewarmCells(reuse_identifier_handle, number_of_cells);
+}
+
+int CollectionView::RegisterReuseIdentifier(
+    const std::string& reuse_identifier,
+    std::function<TableViewCell*()> create_cell) {
+  return reusable_cell_pool_.RegisterReuseIdentifier(reuse_identifier,
+                                                     create_cell);
+}
+
+void CollectionView::ReloadData() {
+  down_event_cell_ = nullptr;
+  ReuseVisibleCells();
+  number_of_items_ = -1;
+  InvalidateLayout();
+  SetContentViewOffset({0, 0});
+}
+
+void CollectionView::ReuseVisibleCells() {
+  for (TableViewCell* cell : visible_cells_)
+    reusable_cell_pool_.ReuseCell(cell);
+  visible_cells_.clear();
+  visible_item_indexes_.clear();
+}
+
+void CollectionView::SetCellHighlighted(TableViewCell* cell,
+                                        const bool highlighted) {
+  if (cell->highlighted() == highlighted)
+    return;
+
+  const int kItemIndex = GetItemIndex(cell);
+  if (kItemIndex < 0)
+    return;
+  if (highlighted && delegate_ != nullptr &&
+      !delegate_->CollectionViewShouldHighlightItem(this, kItemIndex)) {
+    return;
+  }
+  cell->set_highlighted(highlighted);
+}
+
+void CollectionView::SetReusableCellCapacity(
+    const int reuse_identifier_handle, const int capacity) {
+  reusable_cell_pool_.SetCapacity(reuse_identifier_handle, capacity);
+}
+
+bool CollectionView::ShouldHandleEvent(const Point location) {
+  if (!ScrollView::ShouldHandleEvent(location))
+    return false;
+
+  for (TableViewCell* cell : visible_cells_) {
+    if (cell->CollidePoint(location, 0))
+      down_event_cell_ = cell;
+  }
+  return true;
+}
+
+// Both the items that should be visible and the visible cells are in
+// ascending order of item indexes, so they are merged in one pass. Cells of
+// items that remain visible are kept as is, and the data source is only asked
+// for the items that just became visible.
+bool CollectionView::UpdateLayout() {
+  if (data_source_ == nullptr || layout_ == nullptr || IsHidden() ||
+      widget_view() == nullptr || GetWidth() == 0 || GetHeight() == 0) {
+    return false;
+  }
+
+  const Point kContentViewOffset = GetContentViewOffset();
+  const Size kSize = {GetWidth(), GetHeight()};
+  if (!should_update_layout_ &&
+      kContentViewOffset.x == last_content_view_offset_.x &&
+      kContentViewOffset.y == last_content_view_offset_.y &&
+      kSize.width == last_size_.width && kSize.height == last_size_.height) {
+    return false;
+  }
+  should_update_layout_ = false;
+
+  // Prepares the layout if anything it depends on changed.
+  const int kNumberOfItems = data_source_->GetNumberOfItems(this);
+  if (layout_is_invalid_ || kNumberOfItems != number_of_items_ ||
+      kSize.width != last_size_.width) {
+    layout_is_invalid_ = false;
+    number_of_items_ = kNumberOfItems;
+    layout_->PrepareLayout();
+    const Size kContentSize = layout_->GetContentSize();
+    SetContentViewSize(kContentSize.width, kContentSize.height);
+  }
+  last_content_view_offset_ = kContentViewOffset;
+  last_size_ = kSize;
+
+  layout_->GetItemIndexesInRect(kContentViewOffset, kSize,
+                                &visible_item_indexes_buffer_);
+  next_visible_cells_.clear();
+  next_visible_item_indexes_.clear();
+  int position = 0;  // the position in `visible_cells_`
+  const int kNumberOfVisibleCells = static_cast<int>(visible_cells_.size());
+  for (const int kItemIndex : visible_item_indexes_buffer_) {
+    if (kItemIndex < 0 || kItemIndex >= kNumberOfItems)
+      continue;
+
+    // Reuses the cells of items that are no longer visible ahead of the
+    // current item.
+    while (position < kNumberOfVisibleCells &&
+           visible_item_indexes_[position] < kItemIndex) {
+      if (visible_cells_[position] == down_event_cell_)
+        down_event_cell_ = nullptr;
+      reusable_cell_pool_.ReuseCell(visible_cells_[position++]);
+    }
+
+    TableViewCell* cell = nullptr;
+    if (position < kNumberOfVisibleCells &&
+        visible_item_indexes_[position] == kItemIndex) {
+      cell = visible_cells_[position++];
+    } else {
+      cell = data_source_->GetCollectionViewCell(this, kItemIndex);
+      if (cell == nullptr)
+        continue;
+      AddChild(cell);
+    }
+    Point origin;
+    Size size;
+    layout_->GetItemFrame(kItemIndex, &origin, &size);
+    cell->SetBounds(origin.x, origin.y, size.width, size.height);
+    next_visible_cells_.push_back(cell);
+    next_visible_item_indexes_.push_back(kItemIndex);
+  }
+  // Reuses the cells of the remaining items.
+  while (position < kNumberOfVisibleCells) {
+    if (visible_cells_[position] == down_event_cell_)
+      down_event_cell_ = nullptr;
+    reusable_cell_pool_.ReuseCell(visible_cells_[position++]);
+  }
+
+  visible_cells_.swap(next_visible_cells_);
+  visible_item_indexes_.swap(next_visible_item_indexes_);
+  return true;
+}
+
+bool CollectionView::WidgetViewWillRender(NVGcontext* context) {
+  const bool kResult = ScrollView::WidgetViewWillRender(context);
+  if (!kResult)
+    return false;
+
+  UpdateLayout();
+  return true;
+}
+
+void CollectionView::set_data_source(CollectionViewDataSource* data_source) {
+  if (data_source != data_source_) {
+    data_source_ = data_source;
+    ReloadData();
+  }
+}
+
+void CollectionView::set_delegate(CollectionViewDelegate* delegate) {
+  if (delegate != delegate_) {
+    delegate_ = delegate;
+    InvalidateLayout();
+  }
+}
+
+void CollectionView::set_layout(CollectionViewLayout* layout) {
+  if (layout == layout_)
+    return;
+
+  if (layout_ != nullptr)
+    layout_->collection_view_ = nullptr;
+  layout_ = layout;
+  if (layout_ != nullptr) {
+    if (layout_->collection_view_ != nullptr)
+      layout_->collection_view_->set_layout(nullptr);
+    layout_->collection_view_ = this;
+  }
+  InvalidateLayout();
+}
+
+CollectionViewLayout::CollectionViewLayout() : collection_view_(nullptr) {
+}
+
+CollectionViewLayout::~CollectionViewLayout() {
+  if (collection_view_ != nullptr)
+    collection_view_->set_layout(nullptr);
+}
+
+void CollectionViewLayout::InvalidateLayout() {
+  if (collection_view_ != nullptr)
+    collection_view_->InvalidateLayout();
+}
+
+}  // namespace moui
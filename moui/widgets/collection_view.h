@@ -0,0 +1,286 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_COLLECTION_VIEW_H_
+#define MOUI_WIDGETS_COLLECTION_VIEW_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/clock.h"
+#include "moui/widgets/reusable_cell_pool.h"
+#include "moui/widgets/scroll_view.h"
+
+namespace moui {
+
+// Forward declaration.
+class CollectionViewDataSource;
+class CollectionViewDelegate;
+class CollectionViewLayout;
+class TableViewCell;
+
+// The `CollectionView` widget displays an ordered collection of items in a
+// two-dimensional arrangement determined by a `CollectionViewLayout` object.
+// Only the items intersecting the visible area have cells, which are reused
+// the same way as `TableView` cells, so the memory usage does not depend on
+// the number of items.
+class CollectionView : public ScrollView {
+ public:
+  CollectionView();
+  ~CollectionView();
+
+  // Returns a reusable cell object located by its identifier handle in
+  // constant time. If no cell is reusable, a new cell is created by the
+  // function registered with `RegisterReuseIdentifier()`, or `nullptr` is
+  // returned if there is none.
+  TableViewCell* DequeueReusableCell(const int reuse_identifier_handle);
+
+  // Returns a reusable cell object located by its identifier. This is a
+  // convenient wrapper of the handle version at the cost of interning the
+  // identifier.
+  TableViewCell* DequeueReusableCell(const std::string& reuse_identifier);
+
+  // Returns the cell object of the specified item, or `nullptr` if the item
+  // is not visible.
+  TableViewCell* GetCell(const int item_index) const;
+
+  // Returns the index of the item displayed by the specified cell, or -1 if
+  // the cell is not visible in the collection view.
+  int GetItemIndex(TableViewCell* cell) const;
+
+  // Invalidates the layout so it is prepared again before the next layout
+  // pass. This should be called whenever the information the layout depends
+  // on changes.
+  void InvalidateLayout();
+
+  // Creates cells for the specified reuse identifier handle in idle time
+  // until `number_of_cells` cells are reusable.
+  void PrewarmReusableCells(const int reuse_identifier_handle,
+                            const int number_of_cells);
+
+  // Registers a function that creates new cells with the specified reuse
+  // identifier, and returns the identifier's handle to use with
+  // `DequeueReusableCell()`.
+  int RegisterReuseIdentifier(const std::string& reuse_identifier,
+                              std::function<TableViewCell*()> create_cell);
+
+  // Reloads all items of the collection view.
+  void ReloadData();
+
+  // Sets the maximum number of reusable cells kept for the specified reuse
+  // identifier handle.
+  void SetReusableCellCapacity(const int reuse_identifier_handle,
+                               const int capacity);
+
+  // Setters and accessors.
+  CollectionViewDataSource* data_source() const { return data_source_; }
+  void set_data_source(CollectionViewDataSource* data_source);
+  CollectionViewDelegate* delegate() const { return delegate_; }
+  void set_delegate(CollectionViewDelegate* delegate);
+  CollectionViewLayout* layout() const { return layout_; }
+  void set_layout(CollectionViewLayout* layout);
+  std::vector<TableViewCell*>* visible_cells() { return &visible_cells_; }
+  std::vector<int>* visible_item_indexes() { return &visible_item_indexes_; }
+
+ protected:
+  // Inherited from `Widget` class. Releases all reusable cells.
+  void HandleMemoryWarning(NVGcontext* context) override;
+
+  // Inherited from `Widget` class.
+  bool WidgetViewWillRender(NVGcontext* context) override;
+
+ private:
+  // Inherited from `Widget` class.
+  bool HandleEvent(Event* event) final;
+
+  // Highlights the `down_event_cell_` if the cell object is not `nullptr`.
+  // This method exists for the purpose of delay highlighting.
+  void HighlightDownEventCell();
+
+  // Reuses all visible cells.
+  void ReuseVisibleCells();
+
+  // Sets the highlighted state of a visible cell.
+  void SetCellHighlighted(TableViewCell* cell, const bool highlighted);
+
+  // Inherited from `Widget` class.
+  bool ShouldHandleEvent(const Point location) final;
+
+  // Updates the layout of visible cells. Returns `true` if the layout did
+  // update.
+  bool UpdateLayout();
+
+  // The weak reference to the `CollectionViewDataSource` instance.
+  CollectionViewDataSource* data_source_;
+
+  // The weak reference to the `CollectionViewDelegate` instance.
+  CollectionViewDelegate* delegate_;
+
+  // The weak reference to the cell that receives the last down event.
+  TableViewCell* down_event_cell_;
+
+  // Records the cell's origin related to the corresponded widget view's
+  // coordinate system when receiving the `Event::Type::kDown` event.
+  Point down_event_origin_;
+
+  // The handle of the scheduled callback that highlights `down_event_cell_`.
+  // The callback is cancelled when the view is destroyed. The value is 0 if
+  // there is none.
+  Clock::Handle highlight_callback_handle_;
+
+  // Keeps the content view offset last time updated layout.
+  Point last_content_view_offset_;
+
+  // Keeps the size of the collection view last time updated layout.
+  Size last_size_;
+
+  // The weak reference to the layout determining the placement of items.
+  CollectionViewLayout* layout_;
+
+  // Indicates whether the layout has to be prepared before the next layout
+  // pass.
+  bool layout_is_invalid_;
+
+  // The cells and item indexes being collected by a layout pass, which are
+  // swapped with `visible_cells_` and `visible_item_indexes_` when the pass
+  // finishes. The previous visible lists are kept here afterwards so their
+  // storage is reused by the next pass.
+  std::vector<TableViewCell*> next_visible_cells_;
+  std::vector<int> next_visible_item_indexes_;
+
+  // The number of items last time updated layout.
+  int number_of_items_;
+
+  // Keeps the reusable cells.
+  ReusableCellPool reusable_cell_pool_;
+
+  // Indicates whether the layout should update.
+  bool should_update_layout_;
+
+  // The cells that are visible in the collection view, in ascending order of
+  // their item indexes.
+  std::vector<TableViewCell*> visible_cells_;
+
+  // The index of the item displayed by each cell in `visible_cells_`.
+  std::vector<int> visible_item_indexes_;
+
+  // The indexes of items intersecting the visible area. The storage is
+  // reused across layout passes.
+  std::vector<int> visible_item_indexes_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(CollectionView);
+};
+
+// The `CollectionViewDataSource` class is responsible for providing the data
+// and cells required by a collection view.
+class CollectionViewDataSource {
+ public:
+  CollectionViewDataSource() {}
+  ~CollectionViewDataSource() {}
+
+  // Asks the data source for a cell to display the specified item. Cells
+  // should be obtained from `CollectionView::DequeueReusableCell()`.
+  virtual TableViewCell* GetCollectionViewCell(
+      CollectionView* collection_view, const int item_index) = 0;
+
+  // Asks the data source to return the number of items in the collection
+  // view.
+  virtual int GetNumberOfItems(CollectionView* collection_view) = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CollectionViewDataSource);
+};
+
+// The `CollectionViewDelegate` class allows the adopting delegate to respond
+// to messages from the `CollectionView` class.
+class CollectionViewDelegate {
+ public:
+  CollectionViewDelegate() {}
+  virtual ~CollectionViewDelegate() {}
+
+  // Tells the delegate that the specified item was tapped.
+  virtual void CollectionViewDidSelectItem(CollectionView* collection_view,
+                                           const int item_index) {}
+
+  // Asks the delegate for the height of the specified item. Layouts that
+  // support items of various heights call this method, and a value less
+  // than 0 indicates the layout's default height.
+  virtual float GetCollectionViewItemHeight(CollectionView* collection_view,
+                                            const int item_index) {
+    return -1;
+  }
+
+  // Asks the delegate if the specified item should be highlighted when
+  // touched.
+  virtual bool CollectionViewShouldHighlightItem(
+      CollectionView* collection_view, const int item_index) {
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CollectionViewDelegate);
+};
+
+// The `CollectionViewLayout` class is the abstract base class of objects that
+// determine the placement of items in a collection view. Layouts only answer
+// queries about the visible area and the items in it, so a collection view
+// never has to iterate all of its items while scrolling.
+class CollectionViewLayout {
+ public:
+  CollectionViewLayout();
+  virtual ~CollectionViewLayout();
+
+  // Returns the size of the content view that fits all items.
+  virtual Size GetContentSize() = 0;
+
+  // Determines the origin and size of the specified item in the content
+  // view's coordinate system.
+  virtual void GetItemFrame(const int item_index, Point* origin,
+                            Size* size) = 0;
+
+  // Replaces the content of `item_indexes` with the indexes of the items
+  // whose frames intersect the rectangle of the specified `origin` and
+  // `size` in the content view's coordinate system, in ascending order.
+  virtual void GetItemIndexesInRect(const Point origin, const Size size,
+                                    std::vector<int>* item_indexes) = 0;
+
+  // Invalidates the layout of the collection view using this layout.
+  void InvalidateLayout();
+
+  // Tells the layout to update its cached metrics. The collection view calls
+  // this method before any other queries whenever the layout is invalidated,
+  // the number of items changes or the collection view's width changes.
+  virtual void PrepareLayout() {}
+
+  // Accessors.
+  CollectionView* collection_view() const { return collection_view_; }
+
+ private:
+  // Allows `CollectionView` to maintain `collection_view_`.
+  friend class CollectionView;
+
+  // The weak reference to the collection view using this layout.
+  CollectionView* collection_view_;
+
+  DISALLOW_COPY_AND_ASSIGN(CollectionViewLayout);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_COLLECTION_VIEW_H_
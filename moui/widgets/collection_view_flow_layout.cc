@@ -0,0 +1,205 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/collection_view_flow_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/widgets/collection_view.h"
+
+namespace moui {
+
+CollectionViewFlowLayout::CollectionViewFlowLayout()
+    : CollectionViewLayout(), column_stride_(0), content_width_(0),
+      item_heights_vary_(false), item_size_({50, 50}), line_spacing_(10),
+      minimum_interitem_spacing_(10), number_of_items_(0),
+      number_of_columns_(1), number_of_rows_(0), section_inset_({0, 0, 0, 0}) {
+}
+
+CollectionViewFlowLayout::~CollectionViewFlowLayout() {
+}
+
+Size CollectionViewFlowLayout::GetContentSize() {
+  float height = section_inset_.top + section_inset_.bottom;
+  if (number_of_rows_ > 0)
+    height += GetRowOffset(number_of_rows_) - line_spacing_
+              - section_inset_.top;
+  return {content_width_, height};
+}
+
+float CollectionViewFlowLayout::GetItemHeight(const int item_index) const {
+  if (!item_heights_vary_)
+    return item_size_.height;
+
+  CollectionViewDelegate* delegate = collection_view()->delegate();
+  if (delegate == nullptr)
+    return item_size_.height;
+  const float kHeight = delegate->GetCollectionViewItemHeight(
+      collection_view(), item_index);
+  return kHeight < 0 ? item_size_.height : kHeight;
+}
+
+void CollectionViewFlowLayout::GetItemFrame(const int item_index,
+                                            Point* origin, Size* size) {
+  const int kRowIndex = item_index / number_of_columns_;
+  const int kColumnIndex = item_index % number_of_columns_;
+  if (origin != nullptr) {
+    origin->x = section_inset_.left + kColumnIndex * column_stride_;
+    origin->y = GetRowOffset(kRowIndex);
+  }
+  if (size != nullptr) {
+    size->width = item_size_.width;
+    size->height = GetItemHeight(item_index);
+  }
+}
+
+// Only whole rows are returned, so the result is determined by the first and
+// the last rows intersecting the rectangle. Both are computed in constant
+// time for uniform heights or by a binary search of `row_offsets_`.
+void CollectionViewFlowLayout::GetItemIndexesInRect(
+    const Point origin, const Size size, std::vector<int>* item_indexes) {
+  item_indexes->clear();
+  if (number_of_rows_ == 0)
+    return;
+
+  const float kTop = origin.y;
+  const float kBottom = origin.y + size.height;
+  int first_row_index = 0;
+  int last_row_index = 0;
+  if (item_heights_vary_) {
+    auto rows_end = row_offsets_.begin() + number_of_rows_;
+    first_row_index = static_cast<int>(
+        std::upper_bound(row_offsets_.begin(), rows_end, kTop)
+        - row_offsets_.begin()) - 1;
+    last_row_index = static_cast<int>(
+        std::upper_bound(row_offsets_.begin(), rows_end, kBottom)
+        - row_offsets_.begin()) - 1;
+  } else {
+    const float kRowStride = item_size_.height + line_spacing_;
+    first_row_index = std::floor((kTop - section_inset_.top) / kRowStride);
+    last_row_index = std::floor((kBottom - section_inset_.top) / kRowStride);
+  }
+  first_row_index = std::max(0, first_row_index);
+  last_row_index = std::min(number_of_rows_ - 1, last_row_index);
+  if (first_row_index > last_row_index)
+    return;
+
+  const int kFirstItemIndex = first_row_index * number_of_columns_;
+  const int kEndItemIndex = std::min(
+      number_of_items_, (last_row_index + 1) * number_of_columns_);
+  for (int item_index = kFirstItemIndex; item_index < kEndItemIndex;
+       ++item_index) {
+    item_indexes->push_back(item_index);
+  }
+}
+
+float CollectionViewFlowLayout::GetRowOffset(const int row_index) const {
+  if (item_heights_vary_)
+    return row_offsets_[row_index];
+  return section_inset_.top + row_index * (item_size_.height + line_spacing_);
+}
+
+void CollectionViewFlowLayout::PrepareLayout() {
+  CollectionView* collection_view = this->collection_view();
+  row_offsets_.clear();
+  if (collection_view == nullptr ||
+      collection_view->data_source() == nullptr) {
+    number_of_items_ = 0;
+    number_of_rows_ = 0;
+    return;
+  }
+
+  content_width_ = collection_view->GetWidth();
+  number_of_items_ = std::max(
+      0, collection_view->data_source()->GetNumberOfItems(collection_view));
+
+  // Fits as many columns as possible and distributes the remaining width
+  // evenly between them.
+  const float kAvailableWidth = \
+      content_width_ - section_inset_.left - section_inset_.right;
+  number_of_columns_ = std::max(
+      1, static_cast<int>(std::floor(
+             (kAvailableWidth + minimum_interitem_spacing_)
+             / (item_size_.width + minimum_interitem_spacing_))));
+  column_stride_ = item_size_.width;
+  if (number_of_columns_ > 1) {
+    column_stride_ += (kAvailableWidth - number_of_columns_ * item_size_.width)
+                      / (number_of_columns_ - 1);
+  }
+  number_of_rows_ = \
+      (number_of_items_ + number_of_columns_ - 1) / number_of_columns_;
+  if (!item_heights_vary_)
+    return;
+
+  // Caches the offset of each row, which is as tall as its tallest item.
+  row_offsets_.reserve(number_of_rows_ + 1);
+  float row_offset = section_inset_.top;
+  for (int row_index = 0; row_index < number_of_rows_; ++row_index) {
+    row_offsets_.push_back(row_offset);
+    float row_height = 0;
+    const int kEndItemIndex = std::min(
+        number_of_items_, (row_index + 1) * number_of_columns_);
+    for (int item_index = row_index * number_of_columns_;
+         item_index < kEndItemIndex; ++item_index) {
+      row_height = std::max(row_height, GetItemHeight(item_index));
+    }
+    row_offset += row_height + line_spacing_;
+  }
+  row_offsets_.push_back(row_offset);
+}
+
+void CollectionViewFlowLayout::set_item_heights_vary(
+    const bool item_heights_vary) {
+  if (item_heights_vary != item_heights_vary_) {
+    item_heights_vary_ = item_heights_vary;
+    InvalidateLayout();
+  }
+}
+
+void CollectionViewFlowLayout::set_item_size(const Size item_size) {
+  if (item_size.width != item_size_.width ||
+      item_size.height != item_size_.height) {
+    item_size_ = item_size;
+    InvalidateLayout();
+  }
+}
+
+void CollectionViewFlowLayout::set_line_spacing(const float line_spacing) {
+  if (line_spacing != line_spacing_) {
+    line_spacing_ = line_spacing;
+    InvalidateLayout();
+  }
+}
+
+void CollectionViewFlowLayout::set_minimum_interitem_spacing(
+    const float minimum_interitem_spacing) {
+  if (minimum_interitem_spacing != minimum_interitem_spacing_) {
+    minimum_interitem_spacing_ = minimum_interitem_spacing;
+    InvalidateLayout();
+  }
+}
+
+void CollectionViewFlowLayout::set_section_inset(
+    const EdgeInsets section_inset) {
+  section_inset_ = section_inset;
+  InvalidateLayout();
+}
+
+}  // namespace moui
@@ -0,0 +1,116 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_COLLECTION_VIEW_FLOW_LAYOUT_H_
+#define MOUI_WIDGETS_COLLECTION_VIEW_FLOW_LAYOUT_H_
+
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/widgets/collection_view.h"
+
+namespace moui {
+
+// The `CollectionViewFlowLayout` class arranges items in a grid that scrolls
+// vertically. Each row holds as many items as fit in the collection view's
+// width, and the remaining space is distributed evenly between the items.
+//
+// By default all items have the same height and every query is answered in
+// constant time without memory proportional to the number of items. If
+// `item_heights_vary` is enabled, each item's height is requested from the
+// collection view's delegate, and the offsets of rows are cached when the
+// layout is prepared so visible rows are still located by a binary search.
+class CollectionViewFlowLayout : public CollectionViewLayout {
+ public:
+  CollectionViewFlowLayout();
+  ~CollectionViewFlowLayout();
+
+  // Inherited from `CollectionViewLayout` class.
+  Size GetContentSize() override;
+
+  // Inherited from `CollectionViewLayout` class.
+  void GetItemFrame(const int item_index, Point* origin, Size* size) override;
+
+  // Inherited from `CollectionViewLayout` class.
+  void GetItemIndexesInRect(const Point origin, const Size size,
+                            std::vector<int>* item_indexes) override;
+
+  // Inherited from `CollectionViewLayout` class.
+  void PrepareLayout() override;
+
+  // Setters and accessors.
+  Size item_size() const { return item_size_; }
+  void set_item_size(const Size item_size);
+  bool item_heights_vary() const { return item_heights_vary_; }
+  void set_item_heights_vary(const bool item_heights_vary);
+  float line_spacing() const { return line_spacing_; }
+  void set_line_spacing(const float line_spacing);
+  float minimum_interitem_spacing() const {
+    return minimum_interitem_spacing_;
+  }
+  void set_minimum_interitem_spacing(const float minimum_interitem_spacing);
+  EdgeInsets section_inset() const { return section_inset_; }
+  void set_section_inset(const EdgeInsets section_inset);
+
+ private:
+  // Returns the height of the specified item.
+  float GetItemHeight(const int item_index) const;
+
+  // Returns the top offset of the specified row.
+  float GetRowOffset(const int row_index) const;
+
+  // The horizontal distance between the origins of two adjacent items in
+  // the same row.
+  float column_stride_;
+
+  // The width of the content view when the layout was prepared.
+  float content_width_;
+
+  // Indicates whether items may have different heights.
+  bool item_heights_vary_;
+
+  // The default size of items.
+  Size item_size_;
+
+  // The vertical spacing between two rows.
+  float line_spacing_;
+
+  // The minimum horizontal spacing between two items in the same row.
+  float minimum_interitem_spacing_;
+
+  // The number of items when the layout was prepared.
+  int number_of_items_;
+
+  // The number of items in a row.
+  int number_of_columns_;
+
+  // The number of rows.
+  int number_of_rows_;
+
+  // The top offset of each row followed by the bottom offset of the last
+  // row. It is only used when `item_heights_vary_` is `true`.
+  std::vector<float> row_offsets_;
+
+  // The margins around all items.
+  EdgeInsets section_inset_;
+
+  DISALLOW_COPY_AND_ASSIGN(CollectionViewFlowLayout);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_COLLECTION_VIEW_FLOW_LAYOUT_H_
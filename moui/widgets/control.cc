@@ -17,8 +17,6 @@
 
 #include "moui/widgets/control.h"
 
-#include <cmath>
-#include <cstdint>
 #include <vector>
 
 #include "moui/base.h"
@@ -77,30 +75,18 @@ bool Control::HandleControlEvents(const ControlEvents events) {
   return handles_events;
 }
 
-// Handles corresponded control events converted from the passed event.
+// Handles corresponded control events converted from the passed event. When
+// a gesture recognizer such as the one of an underlying scroll view wins the
+// touch sequence, the widget view cancels the control with a `cancel` event.
 bool Control::HandleEvent(Event* event) {
   if (IsDisabled() || ignores_upcoming_events_) {
     return true;
   }
 
-  // Determines the control's current origin related to the corresponded
-  // widget view's coordinate system.
-  Point origin;
-  GetMeasuredBounds(&origin, nullptr);
-
   int control_events = 0;
   // Down.
   if (event->type() == Event::Type::kDown) {
     control_events |= ControlEvents::kTouchDown;
-    down_event_origin_ = origin;
-  // Cancels if the control's initial origin has been changed. This situation
-  // happens when underlying scroll view is scrolling.
-  } else if (down_event_origin_.x != INT_MIN &&
-             down_event_origin_.y != INT_MIN &&
-             (std::abs(origin.x - down_event_origin_.x) >= 1.2 ||
-              std::abs(origin.y - down_event_origin_.y) >= 1.2)) {
-    control_events |= ControlEvents::kTouchCancel;
-    ignores_upcoming_events_ = true;
   // Move.
   } else if (event->type() == Event::Type::kMove) {
     const bool kTouchOutside = !CollidePoint(
@@ -131,6 +117,7 @@ bool Control::HandleEvent(Event* event) {
   // Cancel.
   } else if (event->type() == Event::Type::kCancel) {
     control_events |= ControlEvents::kTouchCancel;
+    ignores_upcoming_events_ = true;
   }
   // Handles the populated control event. The event will be propagated to the
   // next responder if no control event is handled.
@@ -203,7 +190,6 @@ bool Control::ShouldHandleEvent(const Point location) {
     return false;
   }
   ignores_upcoming_events_ = false;
-  down_event_origin_ = {INT_MIN, INT_MIN};
   return true;
 }
 
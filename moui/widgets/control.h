@@ -186,10 +186,6 @@ class Control : public Widget {
   // the list to fire callbacks with matched control events.
   std::vector<Action*> actions_;
 
-  // Records the control's origin related to the corresponded widget view's
-  // coordinate system when receiving the `Event::Type::kDown` event.
-  Point down_event_origin_;
-
   // The margin in points expanding the widget's bounding box as highlighted
   // area.
   int highlighted_margin_;
@@ -0,0 +1,97 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/gesture_arena.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
+#include "moui/widgets/widget.h"
+
+namespace moui {
+
+GestureArena::GestureArena() : winner_(nullptr) {
+}
+
+GestureArena::~GestureArena() {
+  Clear();
+}
+
+void GestureArena::Add(GestureRecognizer* recognizer) {
+  recognizer->arena_ = this;
+  recognizer->state_ = GestureRecognizer::State::kPossible;
+  members_.push_back(recognizer);
+}
+
+bool GestureArena::Claim(GestureRecognizer* recognizer) {
+  if (winner_ != nullptr)
+    return winner_ == recognizer;
+
+  winner_ = recognizer;
+  for (GestureRecognizer* member : members_) {
+    if (member != recognizer &&
+        member->state_ == GestureRecognizer::State::kPossible) {
+      member->state_ = GestureRecognizer::State::kFailed;
+    }
+  }
+  if (resolution_callback_)
+    resolution_callback_(recognizer);
+  return true;
+}
+
+void GestureArena::Clear() {
+  for (GestureRecognizer* member : members_) {
+    member->arena_ = nullptr;
+    member->Reset();
+    member->state_ = GestureRecognizer::State::kPossible;
+  }
+  members_.clear();
+  winner_ = nullptr;
+}
+
+// Visits the recognizers of the widget instead of all members so dispatching
+// an event along the responder chain takes time linear in its length.
+// Iterates by index because the actions called by members could remove
+// recognizers from the widget.
+void GestureArena::HandleEvent(Event* event, const Widget* widget) {
+  const std::vector<GestureRecognizer*>& kRecognizers = \
+      *widget->gesture_recognizers();
+  for (int i = 0; i < static_cast<int>(kRecognizers.size()); ++i) {
+    GestureRecognizer* member = kRecognizers[i];
+    if (member->arena_ != this)
+      continue;
+    const GestureRecognizer::State kState = member->state_;
+    if (kState == GestureRecognizer::State::kPossible ||
+        kState == GestureRecognizer::State::kBegan ||
+        kState == GestureRecognizer::State::kChanged) {
+      member->ReceiveEvent(event);
+    }
+  }
+}
+
+void GestureArena::Remove(GestureRecognizer* recognizer) {
+  auto match = std::find(members_.begin(), members_.end(), recognizer);
+  if (match != members_.end())
+    members_.erase(match);
+  if (winner_ == recognizer)
+    winner_ = nullptr;
+  recognizer->arena_ = nullptr;
+}
+
+}  // namespace moui
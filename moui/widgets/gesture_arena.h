@@ -0,0 +1,84 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_GESTURE_ARENA_H_
+#define MOUI_WIDGETS_GESTURE_ARENA_H_
+
+#include <functional>
+#include <vector>
+
+#include "moui/base.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+class GestureRecognizer;
+class Widget;
+
+// The `GestureArena` class resolves which of the gesture recognizers of a
+// touch sequence wins the sequence. The members are kept in a flat list in
+// the order of the event responders, so the recognizers of the innermost
+// widget see every event first and win ties. The first member claiming the
+// arena wins and all other members still possible fail. A sequence may end
+// without a winner.
+class GestureArena {
+ public:
+  GestureArena();
+  ~GestureArena();
+
+  // Adds a recognizer competing in the current touch sequence.
+  void Add(GestureRecognizer* recognizer);
+
+  // Makes the passed member the winner. Returns `false` if another member
+  // already won.
+  bool Claim(GestureRecognizer* recognizer);
+
+  // Ends the current touch sequence. All members are reset and removed.
+  void Clear();
+
+  // Passes the event to the members attached to the specified widget that
+  // are still possible or won with a continuous gesture in progress.
+  void HandleEvent(Event* event, const Widget* widget);
+
+  // Removes the passed member from the arena.
+  void Remove(GestureRecognizer* recognizer);
+
+  // Accessors and setters.
+  void set_resolution_callback(
+      std::function<void(GestureRecognizer*)> callback) {
+    resolution_callback_ = callback;
+  }
+  GestureRecognizer* winner() const { return winner_; }
+
+ private:
+  // The recognizers competing in the current touch sequence.
+  std::vector<GestureRecognizer*> members_;
+
+  // The function called with the winner once the arena is resolved.
+  std::function<void(GestureRecognizer*)> resolution_callback_;
+
+  // The weak reference to the member that won the current touch sequence.
+  // This value is `nullptr` if no member won yet.
+  GestureRecognizer* winner_;
+
+  DISALLOW_COPY_AND_ASSIGN(GestureArena);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_GESTURE_ARENA_H_
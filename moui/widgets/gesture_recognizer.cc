@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/gesture_recognizer.h"
+
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_arena.h"
+
+namespace {
+
+// Returns the centroid of the passed locations.
+moui::Point GetCentroid(const std::vector<moui::Point>& locations) {
+  moui::Point centroid = {0, 0};
+  if (locations.empty())
+    return centroid;
+  for (const moui::Point& location : locations) {
+    centroid.x += location.x;
+    centroid.y += location.y;
+  }
+  centroid.x /= locations.size();
+  centroid.y /= locations.size();
+  return centroid;
+}
+
+}  // namespace
+
+namespace moui {
+
+GestureRecognizer::GestureRecognizer()
+    : arena_(nullptr), is_enabled_(true), state_(State::kPossible),
+      widget_(nullptr) {
+}
+
+GestureRecognizer::~GestureRecognizer() {
+  if (arena_ != nullptr)
+    arena_->Remove(this);
+}
+
+Point GestureRecognizer::GetLocation() const {
+  return GetCentroid(locations_);
+}
+
+int GestureRecognizer::GetNumberOfPointers() const {
+  return static_cast<int>(locations_.size());
+}
+
+Point GestureRecognizer::GetPredictedLocation() const {
+  if (predicted_locations_.empty())
+    return GetLocation();
+  return GetCentroid(predicted_locations_);
+}
+
+void GestureRecognizer::ReceiveEvent(Event* event) {
+  locations_ = *event->locations();
+  predicted_locations_ = *event->predicted_locations();
+  HandleEvent(event);
+}
+
+void GestureRecognizer::SetState(const State state) {
+  const bool kClaimsArena = \
+      state == State::kBegan ||
+      (state == State::kEnded && state_ == State::kPossible);
+  if (kClaimsArena && arena_ != nullptr && !arena_->Claim(this)) {
+    state_ = State::kFailed;
+    return;
+  }
+  state_ = state;
+  if (state != State::kPossible && state != State::kFailed && action_)
+    action_();
+}
+
+// Disabling a recognizer during a touch sequence takes it out of the
+// sequence immediately.
+void GestureRecognizer::set_is_enabled(const bool is_enabled) {
+  is_enabled_ = is_enabled;
+  if (is_enabled || arena_ == nullptr)
+    return;
+  if (state_ == State::kBegan || state_ == State::kChanged)
+    SetState(State::kCancelled);
+  else if (state_ == State::kPossible)
+    SetState(State::kFailed);
+}
+
+}  // namespace moui
@@ -0,0 +1,155 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_GESTURE_RECOGNIZER_H_
+#define MOUI_WIDGETS_GESTURE_RECOGNIZER_H_
+
+#include <functional>
+#include <vector>
+
+#include "moui/base.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+class GestureArena;
+class Widget;
+
+// The `GestureRecognizer` class is the abstract base class for recognizing a
+// particular gesture from the events of a touch sequence. Recognizers are
+// attached to widgets by `Widget::AddGestureRecognizer()`. When a sequence
+// begins, the recognizers of all widgets responding to it join the gesture
+// arena of the widget view and compete for the sequence. The first
+// recognizer that recognizes its gesture wins the arena, the others fail,
+// and the responders other than the winner's widget receive an
+// `Event::Type::kCancel` event and nothing else of the sequence.
+//
+// Subclasses implement `HandleEvent()` and call `SetState()` as the gesture
+// progresses. Continuous gestures such as pans move through `kBegan`,
+// `kChanged` and `kEnded`, while discrete gestures such as taps move from
+// `kPossible` to `kEnded` directly. Both `kBegan` and a discrete `kEnded`
+// claim the arena, and the state becomes `kFailed` instead if another
+// recognizer already won.
+class GestureRecognizer {
+ public:
+  // The states of a recognizer.
+  enum class State {
+    // The gesture is not recognized yet. This is the initial state of every
+    // touch sequence.
+    kPossible,
+    // A continuous gesture is recognized.
+    kBegan,
+    // The recognized continuous gesture changed.
+    kChanged,
+    // The gesture finished.
+    kEnded,
+    // The recognized continuous gesture was cancelled.
+    kCancelled,
+    // The gesture cannot be recognized in the current touch sequence.
+    kFailed,
+  };
+
+  GestureRecognizer();
+  virtual ~GestureRecognizer();
+
+  // Binds a function or class method to be called whenever the state changes
+  // to `kBegan`, `kChanged`, `kEnded` or `kCancelled`. The signature of the
+  // callback function must be `void(GestureRecognizer*)`.
+  //
+  // Examples:
+  // BindAction(Function)  // function
+  // BindAction(&Class::Method, instance)  // instance method
+  template<class Callback>
+  void BindAction(Callback&& callback) {
+    action_ = std::bind(callback, this);
+  }
+  template<class Callback, class TargetType>
+  void BindAction(Callback&& callback, TargetType&& target) {
+    action_ = std::bind(callback, target, this);
+  }
+
+  // Returns the centroid of the pointers of the latest handled event in the
+  // widget view's coordinate system.
+  Point GetLocation() const;
+
+  // Returns the number of pointers of the latest handled event.
+  int GetNumberOfPointers() const;
+
+  // Returns the centroid of the predicted locations of the pointers of the
+  // latest handled event, or `GetLocation()` if the event carries no
+  // prediction. See `WidgetView::predicts_touches()`.
+  Point GetPredictedLocation() const;
+
+  // Accessors and setters.
+  bool is_enabled() const { return is_enabled_; }
+  void set_is_enabled(const bool is_enabled);
+  const std::vector<Point>* locations() const { return &locations_; }
+  State state() const { return state_; }
+  Widget* widget() const { return widget_; }
+
+ protected:
+  // Recognizes the gesture from the passed event of the current touch
+  // sequence by calling `SetState()`. Recognizers that won the arena or are
+  // still possible receive every event of the sequence in order.
+  virtual void HandleEvent(Event* event) = 0;
+
+  // Resets the states kept for the current touch sequence. This method gets
+  // called when the sequence ends.
+  virtual void Reset() {}
+
+  // Changes the state and calls the bound action. Claims the arena if the
+  // state is `kBegan` or a discrete `kEnded`.
+  void SetState(const State state);
+
+ private:
+  friend class GestureArena;
+  friend class Widget;
+
+  // Records the locations of the passed event and passes the event to
+  // `HandleEvent()`.
+  void ReceiveEvent(Event* event);
+
+  // The function called when the state changes.
+  std::function<void()> action_;
+
+  // The weak reference to the arena the recognizer is competing in. This
+  // value is `nullptr` if no touch sequence is ongoing.
+  GestureArena* arena_;
+
+  // Indicates whether the recognizer takes part in touch sequences. The
+  // default value is `true`.
+  bool is_enabled_;
+
+  // The locations of the pointers of the latest handled event.
+  std::vector<Point> locations_;
+
+  // The predicted locations of the pointers of the latest handled event.
+  std::vector<Point> predicted_locations_;
+
+  // The current state.
+  State state_;
+
+  // The weak reference to the widget the recognizer is attached to.
+  Widget* widget_;
+
+  DISALLOW_COPY_AND_ASSIGN(GestureRecognizer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_GESTURE_RECOGNIZER_H_
@@ -0,0 +1,112 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/input_replayer.h"
+
+#include <chrono>  // NOLINT
+#include <vector>
+
+#include "moui/core/clock.h"
+#include "moui/core/event.h"
+#include "moui/core/input_recording.h"
+#include "moui/ui/base_view.h"
+#include "moui/widgets/widget_view.h"
+
+namespace {
+
+// The default duration in seconds between replayed frames.
+const double kDefaultFrameInterval = 1.0 / 60;
+// The default maximum number of frames rendered after the last record.
+const int kDefaultMaximumNumberOfTrailingFrames = 600;
+
+// Returns the real time in seconds regardless of the virtual timestamp of
+// `moui::Clock`.
+double GetRealTimestamp() {
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Passes the recorded input to the view. The passed `event` is reset and
+// reused for delivering the recorded event.
+void Deliver(const moui::InputRecording::Record& record, moui::Event* event,
+             moui::BaseView* view) {
+  if (record.kind == moui::InputRecording::Record::Kind::kHitTest) {
+    view->ShouldHandleEvent(record.locations.front());
+    return;
+  }
+  event->Reset(record.type, record.timestamp);
+  *event->locations() = record.locations;
+  *event->pointer_ids() = record.pointer_ids;
+  *event->historical_samples() = record.historical_samples;
+  event->set_scroll_delta(record.scroll_delta);
+  event->set_scroll_phase(record.scroll_phase);
+  view->HandleEvent(event);
+}
+
+}  // namespace
+
+namespace moui {
+
+InputReplayer::InputReplayer(const InputRecording* recording)
+    : frame_interval_(kDefaultFrameInterval),
+      maximum_number_of_trailing_frames_(
+          kDefaultMaximumNumberOfTrailingFrames),
+      recording_(recording) {
+}
+
+InputReplayer::~InputReplayer() {
+}
+
+bool InputReplayer::Replay(WidgetView* view) {
+  frames_.clear();
+  const std::vector<InputRecording::Record>& kRecords = \
+      *recording_->records();
+  if (kRecords.empty())
+    return false;
+
+  // `WidgetView` hides the inherited methods for handling input and
+  // rendering.
+  BaseView* base_view = view;
+  Event event(Event::Type::kUnknown);
+  double frame_timestamp = kRecords.front().timestamp;
+  int number_of_trailing_frames = 0;
+  for (int index = 0; ; frame_timestamp += frame_interval_) {
+    if (index == static_cast<int>(kRecords.size())) {
+      if (!view->IsAnimating() ||
+          number_of_trailing_frames == maximum_number_of_trailing_frames_) {
+        break;
+      }
+      ++number_of_trailing_frames;
+    }
+    const double kInputBeginTimestamp = GetRealTimestamp();
+    for (; index < static_cast<int>(kRecords.size()) &&
+           kRecords[index].timestamp <= frame_timestamp; ++index) {
+      Clock::SetVirtualTimestamp(kRecords[index].timestamp);
+      Deliver(kRecords[index], &event, base_view);
+    }
+    const double kRenderBeginTimestamp = GetRealTimestamp();
+    Clock::SetVirtualTimestamp(frame_timestamp);
+    base_view->Render();
+    frames_.push_back({frame_timestamp,
+                       kRenderBeginTimestamp - kInputBeginTimestamp,
+                       GetRealTimestamp() - kRenderBeginTimestamp});
+  }
+  Clock::SetVirtualTimestamp(-1);
+  return true;
+}
+
+}  // namespace moui
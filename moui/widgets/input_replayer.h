@@ -0,0 +1,96 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_INPUT_REPLAYER_H_
+#define MOUI_WIDGETS_INPUT_REPLAYER_H_
+
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/input_recording.h"
+
+namespace moui {
+
+// Forward declaration.
+class WidgetView;
+
+// The `InputReplayer` class feeds the input of an `InputRecording` back to a
+// widget view at the recorded times and renders the view once per refresh
+// cycle, so a recorded session could be benchmarked and the timing of each
+// frame compared between builds.
+//
+// The replay runs as fast as possible against a virtual clock set by
+// `Clock::SetVirtualTimestamp()`, which makes animations such as scroll
+// decelerations advance exactly as they would at the recorded times. Frames
+// are rendered directly without presenting them on screen, but the caller
+// is still responsible for making a graphics context current for the view.
+class InputReplayer {
+ public:
+  // The timing of a replayed refresh cycle.
+  struct Frame {
+    // The virtual timestamp the frame was rendered at.
+    double timestamp;
+    // The time in seconds spent handling the input delivered before the
+    // frame.
+    double input_duration;
+    // The time in seconds spent rendering the frame.
+    double render_duration;
+  };
+
+  explicit InputReplayer(const InputRecording* recording);
+  ~InputReplayer();
+
+  // Replays the recording on the passed widget view from the first record.
+  // A frame is rendered every `frame_interval()` seconds until the last
+  // record is delivered and the view stops animating. Returns `false` if the
+  // recording is empty.
+  bool Replay(WidgetView* view);
+
+  // Accessors and setters.
+  double frame_interval() const { return frame_interval_; }
+  void set_frame_interval(const double frame_interval) {
+    frame_interval_ = frame_interval;
+  }
+  const std::vector<Frame>* frames() const { return &frames_; }
+  int maximum_number_of_trailing_frames() const {
+    return maximum_number_of_trailing_frames_;
+  }
+  void set_maximum_number_of_trailing_frames(const int number) {
+    maximum_number_of_trailing_frames_ = number;
+  }
+
+ private:
+  // The duration in seconds between frames. The default value is the
+  // duration of a refresh cycle at 60 Hz.
+  double frame_interval_;
+
+  // The timing of the frames rendered by the last replay.
+  std::vector<Frame> frames_;
+
+  // The maximum number of frames rendered after the last record while the
+  // view keeps animating. The default value is 600.
+  int maximum_number_of_trailing_frames_;
+
+  // The weak reference to the replayed recording.
+  const InputRecording* recording_;
+
+  DISALLOW_COPY_AND_ASSIGN(InputReplayer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_INPUT_REPLAYER_H_
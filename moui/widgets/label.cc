@@ -82,6 +82,29 @@ void Label::ConfigureTextAttributes(NVGcontext* context) {
   nvgTextLetterSpacing(context, 0);
 }
 
+float Label::MeasureTextHeight(NVGcontext* context, const float width) {
+  font_size_to_render_ = font_size_ > 0 ? font_size_ : default_font_size;
+  if (font_size_to_render_ <= 0 || text_.empty() || width <= 0)
+    return 0;
+
+  ConfigureTextAttributes(context);
+  const int kExpectedNumberOfLines = number_of_lines_ == 0 ?
+                                     kMaximumNumberOfLines : number_of_lines_;
+  NVGtextRow text_rows[kExpectedNumberOfLines];
+  const int kActualNumberOfLines = nvgTextBreakLines(
+      context, text_.c_str(), text_.c_str() + text_.size(), width, text_rows,
+      kExpectedNumberOfLines);
+
+  float text_box_height = 0;
+  for (int i = 0; i < kActualNumberOfLines; ++i) {
+    NVGtextRow* row = &text_rows[i];
+    float bounds[4];  // bounds of the row string
+    nvgTextBounds(context, 0, 0, row->start, row->end, bounds);
+    text_box_height += (bounds[3] - bounds[1]) * line_height_;
+  }
+  return std::ceil(text_box_height);
+}
+
 void Label::Redraw() {
   should_prepare_for_rendering_ = true;
   Widget::Redraw();
@@ -46,6 +46,11 @@ class Label : public Widget {
   // Inherited from `Widget` class;
   void Redraw() final;
 
+  // Returns the height required to render the text wrapped at the specified
+  // `width` with the configured font size, line height and number of lines.
+  // The font size is never reduced to fit.
+  float MeasureTextHeight(NVGcontext* context, const float width);
+
   // Sets the default font baseline.
   static void SetDefaultFontBaseline(const float font_baseline);
 
@@ -0,0 +1,102 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/long_press_gesture_recognizer.h"
+
+#include <cmath>
+#include <functional>
+#include <memory>
+
+#include "moui/base.h"
+#include "moui/core/clock.h"
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace {
+
+// The default maximum distance in points the pointer could move before a
+// long press begins.
+const float kDefaultAllowableMovement = 10;
+
+// The default duration in seconds of a long press.
+const double kDefaultMinimumDuration = 0.5;
+
+}  // namespace
+
+namespace moui {
+
+LongPressGestureRecognizer::LongPressGestureRecognizer()
+    : allowable_movement_(kDefaultAllowableMovement),
+      minimum_duration_(kDefaultMinimumDuration),
+      pressing_reference_(std::make_shared<LongPressGestureRecognizer*>(this)),
+      sequence_number_(0) {
+}
+
+LongPressGestureRecognizer::~LongPressGestureRecognizer() {
+}
+
+void LongPressGestureRecognizer::BeginIfPressing(const int sequence_number) {
+  if (sequence_number == sequence_number_ && state() == State::kPossible)
+    SetState(State::kBegan);
+}
+
+void LongPressGestureRecognizer::HandleEvent(Event* event) {
+  const bool kIsActive = state() == State::kBegan ||
+                         state() == State::kChanged;
+  if (GetNumberOfPointers() > 1) {
+    SetState(kIsActive ? State::kCancelled : State::kFailed);
+    return;
+  }
+
+  const Point kLocation = GetLocation();
+  switch (event->type()) {
+    case Event::Type::kDown: {
+      down_location_ = kLocation;
+      std::weak_ptr<LongPressGestureRecognizer*> reference = \
+          pressing_reference_;
+      const int kSequenceNumber = sequence_number_;
+      Clock::ExecuteCallbackOnMainThread(
+          minimum_duration_, [reference, kSequenceNumber]() {
+            std::shared_ptr<LongPressGestureRecognizer*> recognizer = \
+                reference.lock();
+            if (recognizer != nullptr)
+              (*recognizer)->BeginIfPressing(kSequenceNumber);
+          });
+      break;
+    }
+    case Event::Type::kMove:
+      if (kIsActive) {
+        SetState(State::kChanged);
+      } else if (std::hypot(kLocation.x - down_location_.x,
+                            kLocation.y - down_location_.y) >
+                 allowable_movement_) {
+        SetState(State::kFailed);
+      }
+      break;
+    case Event::Type::kUp:
+      SetState(kIsActive ? State::kEnded : State::kFailed);
+      break;
+    default:
+      SetState(kIsActive ? State::kCancelled : State::kFailed);
+  }
+}
+
+void LongPressGestureRecognizer::Reset() {
+  ++sequence_number_;
+}
+
+}  // namespace moui
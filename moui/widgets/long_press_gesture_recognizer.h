@@ -0,0 +1,86 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_LONG_PRESS_GESTURE_RECOGNIZER_H_
+#define MOUI_WIDGETS_LONG_PRESS_GESTURE_RECOGNIZER_H_
+
+#include <memory>
+
+#include "moui/base.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+
+// The `LongPressGestureRecognizer` class recognizes a continuous long press
+// of a single pointer. The gesture begins once the pointer stays down for
+// `minimum_duration()` without moving farther than `allowable_movement()`,
+// changes as the pointer moves, and ends when the pointer touches up.
+class LongPressGestureRecognizer : public GestureRecognizer {
+ public:
+  LongPressGestureRecognizer();
+  ~LongPressGestureRecognizer();
+
+  // Accessors and setters.
+  float allowable_movement() const { return allowable_movement_; }
+  void set_allowable_movement(const float allowable_movement) {
+    allowable_movement_ = allowable_movement;
+  }
+  double minimum_duration() const { return minimum_duration_; }
+  void set_minimum_duration(const double minimum_duration) {
+    minimum_duration_ = minimum_duration;
+  }
+
+ protected:
+  // Inherited from `GestureRecognizer` class.
+  void HandleEvent(Event* event) override;
+
+  // Inherited from `GestureRecognizer` class.
+  void Reset() override;
+
+ private:
+  // Begins the gesture if the pointer is still pressing in the touch
+  // sequence identified by `sequence_number`.
+  void BeginIfPressing(const int sequence_number);
+
+  // The maximum distance in points the pointer could move before the gesture
+  // begins. The default value is 10.
+  float allowable_movement_;
+
+  // The location where the pointer touched down.
+  Point down_location_;
+
+  // The duration in seconds the pointer must stay down. The default value is
+  // 0.5.
+  double minimum_duration_;
+
+  // Keeps a reference to this recognizer that the delayed check holds
+  // weakly, so the check does nothing once the recognizer is destroyed.
+  std::shared_ptr<LongPressGestureRecognizer*> pressing_reference_;
+
+  // Identifies the current touch sequence so the delayed check scheduled in
+  // a previous sequence is ignored.
+  int sequence_number_;
+
+  DISALLOW_COPY_AND_ASSIGN(LongPressGestureRecognizer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_LONG_PRESS_GESTURE_RECOGNIZER_H_
@@ -0,0 +1,123 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/pan_gesture_recognizer.h"
+
+#include <cmath>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace moui {
+
+PanGestureRecognizer::PanGestureRecognizer()
+    : directions_(static_cast<Direction>(Direction::kHorizontal |
+                                         Direction::kVertical)),
+      locked_directions_(static_cast<Direction>(0)), locks_direction_(true),
+      minimum_distance_(0) {
+}
+
+PanGestureRecognizer::~PanGestureRecognizer() {
+}
+
+// The angle is measured clockwise from the upward direction. If both
+// directions are acceptable, translations within 22.5 degrees of an axis
+// belong to that axis and the others are diagonal. Otherwise every
+// translation belongs to the nearer axis.
+PanGestureRecognizer::Direction PanGestureRecognizer::GetDirection(
+    const Point translation) const {
+  const float kTheta = std::atan2(translation.y, translation.x);
+  float angle = (kTheta + M_PI / 2) * 180 / M_PI;
+  if (angle < 0) angle += 360;
+  float half_range = 360.0 / 8 / 2;
+  if (directions_ == (Direction::kHorizontal | Direction::kVertical)) {
+    if (angle < half_range || angle > (360 - half_range) ||
+        (angle > (180 - half_range) && angle < (180 + half_range))) {
+      return Direction::kVertical;
+    }
+    if ((angle > (90 - half_range) && angle < (90 + half_range)) ||
+        (angle > (270 - half_range) && angle < (270 + half_range))) {
+      return Direction::kHorizontal;
+    }
+    return static_cast<Direction>(Direction::kHorizontal |
+                                  Direction::kVertical);
+  }
+  half_range = 360.0 / 4 / 2;
+  if (angle < half_range || angle > (270 + half_range) ||
+      (angle > (180 - half_range) && angle < (180 + half_range)))
+    return Direction::kVertical;
+  return Direction::kHorizontal;
+}
+
+Point PanGestureRecognizer::GetPredictedTranslation() const {
+  const Point kLocation = GetPredictedLocation();
+  return {kLocation.x - down_location_.x, kLocation.y - down_location_.y};
+}
+
+Point PanGestureRecognizer::GetTranslation() const {
+  const Point kLocation = GetLocation();
+  return {kLocation.x - down_location_.x, kLocation.y - down_location_.y};
+}
+
+void PanGestureRecognizer::HandleEvent(Event* event) {
+  const bool kIsActive = state() == State::kBegan ||
+                         state() == State::kChanged;
+  if (GetNumberOfPointers() > 1) {
+    SetState(kIsActive ? State::kEnded : State::kFailed);
+    return;
+  }
+
+  switch (event->type()) {
+    case Event::Type::kDown:
+      down_location_ = GetLocation();
+      break;
+    case Event::Type::kMove: {
+      if (kIsActive) {
+        SetState(State::kChanged);
+        break;
+      }
+      const Point kTranslation = GetTranslation();
+      if ((kTranslation.x == 0 && kTranslation.y == 0) ||
+          std::hypot(kTranslation.x, kTranslation.y) < minimum_distance_) {
+        break;
+      }
+      if (!locks_direction_) {
+        locked_directions_ = directions_;
+      } else {
+        locked_directions_ = static_cast<Direction>(
+            directions_ & GetDirection(kTranslation));
+      }
+      if (locked_directions_ == static_cast<Direction>(0))
+        SetState(State::kFailed);
+      else
+        SetState(State::kBegan);
+      break;
+    }
+    case Event::Type::kUp:
+      SetState(kIsActive ? State::kEnded : State::kFailed);
+      break;
+    default:
+      SetState(kIsActive ? State::kCancelled : State::kFailed);
+  }
+}
+
+void PanGestureRecognizer::Reset() {
+  locked_directions_ = static_cast<Direction>(0);
+}
+
+}  // namespace moui
@@ -0,0 +1,111 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_PAN_GESTURE_RECOGNIZER_H_
+#define MOUI_WIDGETS_PAN_GESTURE_RECOGNIZER_H_
+
+#include "moui/base.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+
+// The `PanGestureRecognizer` class recognizes a continuous drag of a single
+// pointer. Once the pointer moves farther than `minimum_distance()`, the
+// direction of the movement is determined. The gesture begins if the
+// direction is one of `directions()`, or fails otherwise so that another
+// recognizer such as the one of an enclosing scroll view could take the
+// sequence instead. The gesture ends when the pointer touches up or another
+// pointer touches down.
+class PanGestureRecognizer : public GestureRecognizer {
+ public:
+  // The bitmask type for the directions of a pan.
+  enum Direction {
+    // The pan moves horizontally.
+    kHorizontal = 0x01 << 0,
+    // The pan moves vertically.
+    kVertical = 0x01 << 1,
+  };
+
+  PanGestureRecognizer();
+  ~PanGestureRecognizer();
+
+  // Returns the displacement of the predicted location of the pointer since
+  // it touched down. This is the same as `GetTranslation()` if the event
+  // carries no prediction.
+  Point GetPredictedTranslation() const;
+
+  // Returns the displacement of the pointer since it touched down.
+  Point GetTranslation() const;
+
+  // Accessors and setters.
+  Direction directions() const { return directions_; }
+  void set_directions(const Direction directions) {
+    directions_ = directions;
+  }
+  Direction locked_directions() const { return locked_directions_; }
+  bool locks_direction() const { return locks_direction_; }
+  void set_locks_direction(const bool locks_direction) {
+    locks_direction_ = locks_direction;
+  }
+  float minimum_distance() const { return minimum_distance_; }
+  void set_minimum_distance(const float minimum_distance) {
+    minimum_distance_ = minimum_distance;
+  }
+
+ protected:
+  // Inherited from `GestureRecognizer` class.
+  void HandleEvent(Event* event) override;
+
+  // Inherited from `GestureRecognizer` class.
+  void Reset() override;
+
+ private:
+  // Returns the direction of the passed non-zero translation. The direction
+  // is either horizontal or vertical if only one of them is accepted. If both
+  // are accepted, diagonal translations are reported as both directions.
+  Direction GetDirection(const Point translation) const;
+
+  // The acceptable directions of the pan. The default value accepts both
+  // directions.
+  Direction directions_;
+
+  // The location where the pointer touched down.
+  Point down_location_;
+
+  // The directions the recognized pan is locked to. This value is determined
+  // when the gesture begins.
+  Direction locked_directions_;
+
+  // Indicates whether the recognized pan is locked to the direction it began
+  // in. If `false`, the pan is locked to all acceptable directions. The
+  // default value is `true`.
+  bool locks_direction_;
+
+  // The distance in points the pointer must move before the direction is
+  // determined. The default value is 0, which determines the direction on
+  // the first movement.
+  float minimum_distance_;
+
+  DISALLOW_COPY_AND_ASSIGN(PanGestureRecognizer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_PAN_GESTURE_RECOGNIZER_H_
@@ -0,0 +1,90 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/pinch_gesture_recognizer.h"
+
+#include <cmath>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace {
+
+// The default change in points of the distance between the pointers to
+// begin a pinch.
+const float kDefaultMinimumDistanceChange = 8;
+
+}  // namespace
+
+namespace moui {
+
+PinchGestureRecognizer::PinchGestureRecognizer()
+    : initial_distance_(0),
+      minimum_distance_change_(kDefaultMinimumDistanceChange) {
+}
+
+PinchGestureRecognizer::~PinchGestureRecognizer() {
+}
+
+float PinchGestureRecognizer::GetDistance() const {
+  const std::vector<Point>& kLocations = *locations();
+  if (kLocations.size() < 2)
+    return 0;
+  return std::hypot(kLocations[1].x - kLocations[0].x,
+                    kLocations[1].y - kLocations[0].y);
+}
+
+float PinchGestureRecognizer::GetScale() const {
+  if (initial_distance_ <= 0)
+    return 1;
+  return GetDistance() / initial_distance_;
+}
+
+void PinchGestureRecognizer::HandleEvent(Event* event) {
+  const bool kIsActive = state() == State::kBegan ||
+                         state() == State::kChanged;
+  if (event->type() == Event::Type::kCancel) {
+    SetState(kIsActive ? State::kCancelled : State::kFailed);
+    return;
+  }
+  if (event->type() == Event::Type::kUp || GetNumberOfPointers() < 2) {
+    // Waits for the second pointer until the first one touches up.
+    if (kIsActive)
+      SetState(State::kEnded);
+    else if (event->type() == Event::Type::kUp)
+      SetState(State::kFailed);
+    return;
+  }
+
+  const float kDistance = GetDistance();
+  if (initial_distance_ <= 0) {
+    initial_distance_ = kDistance;
+  } else if (kIsActive) {
+    SetState(State::kChanged);
+  } else if (std::abs(kDistance - initial_distance_) >
+             minimum_distance_change_) {
+    SetState(State::kBegan);
+  }
+}
+
+void PinchGestureRecognizer::Reset() {
+  initial_distance_ = 0;
+}
+
+}  // namespace moui
@@ -0,0 +1,73 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_PINCH_GESTURE_RECOGNIZER_H_
+#define MOUI_WIDGETS_PINCH_GESTURE_RECOGNIZER_H_
+
+#include "moui/base.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+
+// The `PinchGestureRecognizer` class recognizes a continuous pinch of two
+// pointers. The gesture begins once the distance between the first two
+// pointers changes by more than `minimum_distance_change()` and ends when
+// fewer than two pointers remain.
+class PinchGestureRecognizer : public GestureRecognizer {
+ public:
+  PinchGestureRecognizer();
+  ~PinchGestureRecognizer();
+
+  // Returns the distance between the first two pointers relative to the
+  // distance when the second pointer touched down.
+  float GetScale() const;
+
+  // Accessors and setters.
+  float minimum_distance_change() const { return minimum_distance_change_; }
+  void set_minimum_distance_change(const float minimum_distance_change) {
+    minimum_distance_change_ = minimum_distance_change;
+  }
+
+ protected:
+  // Inherited from `GestureRecognizer` class.
+  void HandleEvent(Event* event) override;
+
+  // Inherited from `GestureRecognizer` class.
+  void Reset() override;
+
+ private:
+  // Returns the distance between the first two pointers of the latest
+  // handled event.
+  float GetDistance() const;
+
+  // The distance between the first two pointers when the second pointer
+  // touched down. This value is 0 if there has not been two pointers yet.
+  float initial_distance_;
+
+  // The change in points of the distance between the pointers required to
+  // begin the gesture. The default value is 8.
+  float minimum_distance_change_;
+
+  DISALLOW_COPY_AND_ASSIGN(PinchGestureRecognizer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_PINCH_GESTURE_RECOGNIZER_H_
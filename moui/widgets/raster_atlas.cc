@@ -0,0 +1,253 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/raster_atlas.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/defines.h"
+#include "moui/nanovg_hook.h"
+#include "moui/widgets/widget.h"
+
+namespace {
+
+// The maximum width or height in pixels of a slot. Larger results are not
+// worth sharing a page and are rendered in their own framebuffers.
+const int kMaximumSlotLength = 256;
+// The width and height in pixels of a page.
+const int kPageLength = 1024;
+// The gap in pixels between slots so that antialiasing and texture filtering
+// at the edge of a slot never touch its neighbors.
+const int kSlotPadding = 2;
+
+}  // namespace
+
+namespace moui {
+
+RasterAtlas::RasterAtlas() {
+}
+
+RasterAtlas::~RasterAtlas() {
+  Clear();
+}
+
+RasterAtlas::Slot* RasterAtlas::Allocate(NVGcontext* context, Widget* widget,
+                                         const int width, const int height,
+                                         const float scale_factor) {
+  if (width <= 0 || height <= 0 || width > kMaximumSlotLength ||
+      height > kMaximumSlotLength) {
+    return nullptr;
+  }
+
+  Page* page = nullptr;
+  int x = 0;
+  int y = 0;
+  for (Page* candidate : pages_) {
+    if (candidate->scale_factor == scale_factor &&
+        PlaceInPage(candidate, width, height, &x, &y)) {
+      page = candidate;
+      break;
+    }
+  }
+  if (page == nullptr) {
+    page = CreatePage(context, scale_factor);
+    if (page == nullptr)
+      return nullptr;
+    pages_.push_back(page);
+    PlaceInPage(page, width, height, &x, &y);
+  }
+
+  Slot* slot = new Slot{widget, page, x, y, width, height, scale_factor,
+                        false, false};
+  page->slots.push_back(slot);
+  return slot;
+}
+
+void RasterAtlas::Clear() {
+  pending_slots_.clear();
+  for (Page* page : pages_) {
+    for (Slot* slot : page->slots) {
+      slot->widget->atlas_slot_ = nullptr;
+      delete slot;
+    }
+    nvgDeleteFramebuffer(page->framebuffer);
+    delete page;
+  }
+  pages_.clear();
+}
+
+bool RasterAtlas::Compact() {
+  bool did_outdate_slots = false;
+  for (auto iterator = pages_.begin(); iterator != pages_.end();) {
+    Page* page = *iterator;
+    if (page->slots.empty()) {
+      nvgDeleteFramebuffer(page->framebuffer);
+      delete page;
+      iterator = pages_.erase(iterator);
+      continue;
+    }
+    ++iterator;
+
+    int packed_area = 0;
+    for (const Shelf& shelf : page->shelves)
+      packed_area += shelf.x * shelf.height;
+    if (page->released_area * 2 <= packed_area)
+      continue;
+
+    // Starts over the page. The outdated slots are released and allocated
+    // again by their widgets, which packs the page tightly again.
+    for (Slot* slot : page->slots) {
+      if (slot->is_outdated)
+        continue;
+      slot->is_outdated = true;
+      did_outdate_slots = true;
+    }
+    page->shelves.clear();
+    page->released_area = 0;
+  }
+  return did_outdate_slots;
+}
+
+RasterAtlas::Page* RasterAtlas::CreatePage(NVGcontext* context,
+                                           const float scale_factor) {
+  NVGframebuffer* framebuffer = nvgCreateFramebuffer(context, kPageLength,
+                                                     kPageLength, 0);
+  if (framebuffer == NULL)
+    return nullptr;
+  nvgBindFramebuffer(framebuffer);
+  nvgClearColor(context, kPageLength, kPageLength, nvgRGBA(0, 0, 0, 0));
+  nvgBindFramebuffer(NULL);
+  return new Page{framebuffer, scale_factor, {}, {}, 0};
+}
+
+NVGpaint RasterAtlas::GetPaint(NVGcontext* context, const Slot* slot) const {
+  const float kScaleFactor = slot->scale_factor;
+  const float kPageSize = kPageLength / kScaleFactor;
+  return nvgImagePattern(context, -slot->x / kScaleFactor,
+                         -slot->y / kScaleFactor, kPageSize, kPageSize, 0,
+                         slot->page->framebuffer->image, 1);
+}
+
+bool RasterAtlas::PlaceInPage(Page* page, const int width, const int height,
+                              int* x, int* y) {
+  const int kWidth = width + kSlotPadding;
+  const int kHeight = height + kSlotPadding;
+
+  // Finds the lowest shelf the region fits in.
+  Shelf* best_shelf = nullptr;
+  for (Shelf& shelf : page->shelves) {
+    if (shelf.height < kHeight || shelf.x + kWidth > kPageLength)
+      continue;
+    if (best_shelf == nullptr || shelf.height < best_shelf->height)
+      best_shelf = &shelf;
+  }
+
+  // Opens a new shelf instead if the best shelf would waste more than half of
+  // its height and there is still room below the last shelf.
+  const int kTop = page->shelves.empty() ?
+                   0 : page->shelves.back().y + page->shelves.back().height;
+  if ((best_shelf == nullptr || best_shelf->height > kHeight * 2) &&
+      kTop + kHeight <= kPageLength) {
+    page->shelves.push_back({kTop, kHeight, 0});
+    best_shelf = &page->shelves.back();
+  }
+  if (best_shelf == nullptr)
+    return false;
+
+  *x = best_shelf->x;
+  *y = best_shelf->y;
+  best_shelf->x += kWidth;
+  return true;
+}
+
+void RasterAtlas::Release(Slot* slot) {
+  if (slot->is_pending) {
+    pending_slots_.erase(std::find(pending_slots_.begin(),
+                                   pending_slots_.end(), slot));
+  }
+  Page* page = slot->page;
+  page->slots.erase(std::find(page->slots.begin(), page->slots.end(), slot));
+  if (!slot->is_outdated) {
+    page->released_area += \
+        (slot->width + kSlotPadding) * (slot->height + kSlotPadding);
+  }
+  delete slot;
+}
+
+void RasterAtlas::RenderPendingSlots(NVGcontext* context) {
+  if (pending_slots_.empty())
+    return;
+
+  // Groups the slots by pages so each page is bound only once.
+  std::stable_sort(pending_slots_.begin(), pending_slots_.end(),
+                   [](const Slot* a, const Slot* b) {
+                     return a->page < b->page;
+                   });
+  Page* page = nullptr;
+  for (Slot* slot : pending_slots_) {
+    if (slot->page != page) {
+      if (page != nullptr)
+        nvgEndFrame(context);
+      page = slot->page;
+      nvgBindFramebuffer(page->framebuffer);
+#ifdef MOUI_GL
+      glViewport(0, 0, kPageLength, kPageLength);
+#endif
+      const float kPageSize = kPageLength / page->scale_factor;
+      nvgBeginFrame(context, kPageSize, kPageSize, page->scale_factor);
+    }
+    RenderSlot(context, slot);
+    slot->is_pending = false;
+  }
+  nvgEndFrame(context);
+  nvgBindFramebuffer(NULL);
+  pending_slots_.clear();
+}
+
+void RasterAtlas::RenderSlot(NVGcontext* context, Slot* slot) {
+  Widget* widget = slot->widget;
+  const float kScaleFactor = slot->scale_factor;
+  const float kWidth = slot->width / kScaleFactor;
+  const float kHeight = slot->height / kScaleFactor;
+
+  nvgSave(context);
+  nvgTranslate(context, slot->x / kScaleFactor, slot->y / kScaleFactor);
+  nvgScissor(context, 0, 0, kWidth, kHeight);
+
+  // Replaces the previous rendering result in the slot with the background.
+  nvgGlobalCompositeOperation(context, NVG_COPY);
+  nvgBeginPath(context);
+  nvgRect(context, 0, 0, kWidth, kHeight);
+  nvgFillColor(context, widget->is_opaque() ? widget->background_color() :
+                                              nvgRGBA(0, 0, 0, 0));
+  nvgFill(context);
+  nvgGlobalCompositeOperation(context, NVG_SOURCE_OVER);
+
+  widget->ExecuteRenderFunction(context);
+  nvgRestore(context);
+}
+
+void RasterAtlas::RequestRendering(Slot* slot) {
+  if (slot->is_pending)
+    return;
+  slot->is_pending = true;
+  pending_slots_.push_back(slot);
+}
+
+}  // namespace moui
@@ -0,0 +1,155 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_RASTER_ATLAS_H_
+#define MOUI_WIDGETS_RASTER_ATLAS_H_
+
+#include <vector>
+
+#include "moui/base.h"
+#include "moui/nanovg_hook.h"
+
+namespace moui {
+
+// Forward declaration.
+class Widget;
+
+// The `RasterAtlas` class packs the cached rendering results of small widgets
+// into shared framebuffers called pages, so they do not need a framebuffer
+// each. Every page holds results of a single scale factor and is packed in
+// shelves. All slots waiting to be rendered are rendered together with a
+// single bind and a single frame per page, and slots of the same page are
+// composited with the same image.
+//
+// Released slots are not reused directly. Once more than half of a page's
+// packed area is released, all of its slots are marked as outdated and the
+// page starts over empty, which makes their widgets allocate and render new
+// slots the next time they are rendered.
+class RasterAtlas {
+ public:
+  // A page of the atlas.
+  struct Page;
+
+  // A region in a page holding the rendering result of a widget.
+  struct Slot {
+    // The weak reference to the widget rendered in the slot.
+    Widget* widget;
+    // The weak reference to the page the slot belongs to.
+    Page* page;
+    // The horizontal position in pixels in the page.
+    int x;
+    // The vertical position in pixels in the page.
+    int y;
+    // The width in pixels.
+    int width;
+    // The height in pixels.
+    int height;
+    // The scale factor the slot is rendered at.
+    float scale_factor;
+    // Indicates whether the slot no longer owns its region and must be
+    // allocated again.
+    bool is_outdated;
+    // Indicates whether the slot is waiting for `RenderPendingSlots()`.
+    bool is_pending;
+  };
+
+  RasterAtlas();
+  ~RasterAtlas();
+
+  // Allocates a slot of the specified size in pixels for rendering the
+  // widget at the specified scale factor. Returns `nullptr` if the size is
+  // too large for the atlas or a new page cannot be created. This method
+  // must not be called during a frame.
+  Slot* Allocate(NVGcontext* context, Widget* widget, const int width,
+                 const int height, const float scale_factor);
+
+  // Deletes all pages and slots and detaches the slots from their widgets.
+  // This method must be called before the context is deleted.
+  void Clear();
+
+  // Deletes empty pages and starts over the pages whose released area is
+  // more than half of the packed area. Returns `true` if any slot became
+  // outdated.
+  bool Compact();
+
+  // Returns the paint for compositing the specified slot at the origin.
+  NVGpaint GetPaint(NVGcontext* context, const Slot* slot) const;
+
+  // Releases the specified slot.
+  void Release(Slot* slot);
+
+  // Renders all slots requested by `RequestRendering()` page by page. This
+  // method must not be called during a frame.
+  void RenderPendingSlots(NVGcontext* context);
+
+  // Requests rendering the widget of the specified slot in the next call to
+  // `RenderPendingSlots()`.
+  void RequestRendering(Slot* slot);
+
+  // Setters and accessors.
+  int number_of_pages() const { return static_cast<int>(pages_.size()); }
+
+ private:
+  // A row of slots of similar heights.
+  struct Shelf {
+    // The vertical position in pixels in the page.
+    int y;
+    // The height in pixels.
+    int height;
+    // The horizontal position in pixels of the next slot.
+    int x;
+  };
+
+  // Creates an empty page for the specified scale factor. Returns `nullptr`
+  // on failure.
+  Page* CreatePage(NVGcontext* context, const float scale_factor);
+
+  // Finds a region of the specified size in pixels in the page. Returns
+  // `false` if the page is full.
+  bool PlaceInPage(Page* page, const int width, const int height, int* x,
+                   int* y);
+
+  // Renders the widget of the specified slot. This method must be called
+  // during the frame of the slot's page.
+  void RenderSlot(NVGcontext* context, Slot* slot);
+
+  // The pages in the order they were created.
+  std::vector<Page*> pages_;
+
+  // The slots requested by `RequestRendering()`.
+  std::vector<Slot*> pending_slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(RasterAtlas);
+};
+
+// The definition of `RasterAtlas::Page`.
+struct RasterAtlas::Page {
+  // The strong reference to the framebuffer holding the slots.
+  NVGframebuffer* framebuffer;
+  // The scale factor of all slots in the page.
+  float scale_factor;
+  // The shelves from top to bottom.
+  std::vector<Shelf> shelves;
+  // The slots allocated in the page.
+  std::vector<Slot*> slots;
+  // The area in pixels of released slots.
+  int released_area;
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_RASTER_ATLAS_H_
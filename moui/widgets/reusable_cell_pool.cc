@@ -0,0 +1,177 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/reusable_cell_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "moui/core/clock.h"
+#include "moui/widgets/scroll_view.h"
+#include "moui/widgets/table_view_cell.h"
+#include "moui/widgets/widget.h"
+
+namespace {
+
+// The default maximum number of reusable cells kept for a reuse identifier.
+const int kDefaultCapacity = 32;
+// The delay in seconds between creating two prewarmed cells.
+const float kPrewarmingInterval = 0.02;
+
+}  // namespace
+
+namespace moui {
+
+ReusableCellPool::ReusableCellPool(ScrollView* scroll_view)
+    : prewarming_is_scheduled_(false),
+      prewarming_reference_(std::make_shared<ReusableCellPool*>(this)),
+      scroll_view_(scroll_view) {
+}
+
+ReusableCellPool::~ReusableCellPool() {
+  ReleaseCells();
+}
+
+TableViewCell* ReusableCellPool::DequeueCell(
+    const int reuse_identifier_handle) {
+  if (reuse_identifier_handle < 0)
+    return nullptr;
+
+  Pool* pool = GetPool(reuse_identifier_handle);
+  if (pool->cells.empty())
+    return pool->create_cell ? pool->create_cell() : nullptr;
+
+  TableViewCell* cell = pool->cells.back();
+  pool->cells.pop_back();
+  cell->PrepareForReuse();
+  return cell;
+}
+
+ReusableCellPool::Pool* ReusableCellPool::GetPool(
+    const int reuse_identifier_handle) {
+  while (static_cast<int>(pools_.size()) <= reuse_identifier_handle)
+    pools_.push_back({{}, kDefaultCapacity, nullptr, 0});
+  return &pools_[reuse_identifier_handle];
+}
+
+void ReusableCellPool::PrewarmCells(const int reuse_identifier_handle,
+                                    const int number_of_cells) {
+  if (reuse_identifier_handle < 0)
+    return;
+
+  Pool* pool = GetPool(reuse_identifier_handle);
+  pool->number_of_cells_to_prewarm = std::max(
+      0, std::min(number_of_cells, pool->capacity)
+         - static_cast<int>(pool->cells.size()));
+  if (pool->number_of_cells_to_prewarm > 0)
+    SchedulePrewarmingCells();
+}
+
+void ReusableCellPool::PrewarmNextCell() {
+  prewarming_is_scheduled_ = false;
+  // Waits for scrolling to finish.
+  if (scroll_view_->is_scrolling() || scroll_view_->IsAnimating()) {
+    SchedulePrewarmingCells();
+    return;
+  }
+
+  for (Pool& pool : pools_) {
+    if (pool.number_of_cells_to_prewarm <= 0)
+      continue;
+    if (!pool.create_cell ||
+        static_cast<int>(pool.cells.size()) >= pool.capacity) {
+      pool.number_of_cells_to_prewarm = 0;
+      continue;
+    }
+    pool.cells.push_back(pool.create_cell());
+    --pool.number_of_cells_to_prewarm;
+    break;
+  }
+  for (const Pool& pool : pools_) {
+    if (pool.number_of_cells_to_prewarm > 0) {
+      SchedulePrewarmingCells();
+      return;
+    }
+  }
+}
+
+int ReusableCellPool::RegisterReuseIdentifier(
+    const std::string& reuse_identifier,
+    std::function<TableViewCell*()> create_cell) {
+  const int kHandle = TableViewCell::GetReuseIdentifierHandle(
+      reuse_identifier);
+  if (kHandle >= 0)
+    GetPool(kHandle)->create_cell = create_cell;
+  return kHandle;
+}
+
+void ReusableCellPool::ReleaseCells() {
+  for (Pool& pool : pools_) {
+    for (TableViewCell* cell : pool.cells)
+      moui::Widget::SmartRelease(cell);
+    pool.cells.clear();
+    pool.cells.shrink_to_fit();
+    pool.number_of_cells_to_prewarm = 0;
+  }
+}
+
+void ReusableCellPool::ReuseCell(TableViewCell* cell) {
+  cell->RemoveFromParent();
+  const int kReuseIdentifierHandle = cell->reuse_identifier_handle();
+  if (kReuseIdentifierHandle < 0) {
+    moui::Widget::SmartRelease(cell);
+    return;
+  }
+
+  Pool* pool = GetPool(kReuseIdentifierHandle);
+  if (static_cast<int>(pool->cells.size()) >= pool->capacity) {
+    moui::Widget::SmartRelease(cell);
+    return;
+  }
+  pool->cells.push_back(cell);
+}
+
+void ReusableCellPool::SchedulePrewarmingCells() {
+  if (prewarming_is_scheduled_)
+    return;
+
+  prewarming_is_scheduled_ = true;
+  std::weak_ptr<ReusableCellPool*> reference = prewarming_reference_;
+  Clock::ExecuteCallbackOnMainThread(kPrewarmingInterval, [reference]() {
+    std::shared_ptr<ReusableCellPool*> pool = reference.lock();
+    if (pool != nullptr)
+      (*pool)->PrewarmNextCell();
+  });
+}
+
+void ReusableCellPool::SetCapacity(const int reuse_identifier_handle,
+                                   const int capacity) {
+  if (reuse_identifier_handle < 0)
+    return;
+
+  Pool* pool = GetPool(reuse_identifier_handle);
+  pool->capacity = std::max(0, capacity);
+  while (static_cast<int>(pool->cells.size()) > pool->capacity) {
+    moui::Widget::SmartRelease(pool->cells.back());
+    pool->cells.pop_back();
+  }
+}
+
+}  // namespace moui
@@ -0,0 +1,119 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_REUSABLE_CELL_POOL_H_
+#define MOUI_WIDGETS_REUSABLE_CELL_POOL_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "moui/base.h"
+
+namespace moui {
+
+// Forward declaration.
+class ScrollView;
+class TableViewCell;
+
+// The `ReusableCellPool` class keeps the cells that are no longer visible in
+// a scroll view, grouped by reuse identifier handles, so they can be dequeued
+// and displayed again instead of being created. It is the reuse engine shared
+// by `TableView` and `CollectionView`.
+class ReusableCellPool {
+ public:
+  // The `scroll_view` is the owner of the pool. Prewarming waits for it to
+  // stop scrolling or animating.
+  explicit ReusableCellPool(ScrollView* scroll_view);
+  ~ReusableCellPool();
+
+  // Returns a reusable cell of the specified reuse identifier handle in
+  // constant time. If no cell is reusable, a new cell is created by the
+  // function registered with `RegisterReuseIdentifier()`, or `nullptr` is
+  // returned if there is none.
+  TableViewCell* DequeueCell(const int reuse_identifier_handle);
+
+  // Creates cells for the specified reuse identifier handle in idle time
+  // until `number_of_cells` cells are reusable. Cells are created one at a
+  // time by the function registered with `RegisterReuseIdentifier()` and
+  // never while the owner is scrolling.
+  void PrewarmCells(const int reuse_identifier_handle,
+                    const int number_of_cells);
+
+  // Registers a function that creates new cells with the specified reuse
+  // identifier, and returns the identifier's handle.
+  int RegisterReuseIdentifier(const std::string& reuse_identifier,
+                              std::function<TableViewCell*()> create_cell);
+
+  // Releases all reusable cells and stops prewarming.
+  void ReleaseCells();
+
+  // Removes the specified cell from its parent and keeps it for reuse if the
+  // cell's reuse identifier is not empty and its pool is not full. Otherwise,
+  // the cell is released.
+  void ReuseCell(TableViewCell* cell);
+
+  // Sets the maximum number of reusable cells kept for the specified reuse
+  // identifier handle. Cells beyond the capacity are released.
+  void SetCapacity(const int reuse_identifier_handle, const int capacity);
+
+ private:
+  // Keeps the reusable cells of a reuse identifier.
+  struct Pool {
+    // The strong references to the reusable cells. The last cell is dequeued
+    // first.
+    std::vector<TableViewCell*> cells;
+    // The maximum number of cells in `cells`.
+    int capacity;
+    // Creates a new cell with the reuse identifier. It may be empty.
+    std::function<TableViewCell*()> create_cell;
+    // The number of cells remaining to be created in idle time.
+    int number_of_cells_to_prewarm;
+  };
+
+  // Returns the pool of the specified reuse identifier handle, which is
+  // created if necessary.
+  Pool* GetPool(const int reuse_identifier_handle);
+
+  // Creates one cell for the first pool that needs prewarming, and schedules
+  // the next call if there are more to create.
+  void PrewarmNextCell();
+
+  // Schedules a call to `PrewarmNextCell()` on the main thread if there is
+  // none scheduled yet.
+  void SchedulePrewarmingCells();
+
+  // Keeps the pools indexed by reuse identifier handles.
+  std::vector<Pool> pools_;
+
+  // Indicates whether a call to `PrewarmNextCell()` is scheduled.
+  bool prewarming_is_scheduled_;
+
+  // Keeps a reference to this pool that scheduled prewarming holds weakly, so
+  // the callback does nothing once the pool is destroyed.
+  std::shared_ptr<ReusableCellPool*> prewarming_reference_;
+
+  // The weak reference to the scroll view owning the pool.
+  ScrollView* scroll_view_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReusableCellPool);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_REUSABLE_CELL_POOL_H_
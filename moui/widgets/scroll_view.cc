@@ -25,6 +25,8 @@
 #include "moui/core/clock.h"
 #include "moui/core/event.h"
 #include "moui/nanovg_hook.h"
+#include "moui/widgets/gesture_recognizer.h"
+#include "moui/widgets/pan_gesture_recognizer.h"
 #include "moui/widgets/scroller.h"
 #include "moui/widgets/widget.h"
 
@@ -46,6 +48,15 @@ const double kMaximumReachingBoundaryDuration = 0.15;
 // The upper bound of the acceptable velocity to scroll the content view.
 const float kMaximumScrollVelocity = 2500;
 
+// The minimum duration in seconds of the recent events measuring the scroll
+// velocity.
+const double kMinimumVelocityMeasuringDuration = 0.07;
+
+// The distance in points the pointer must move before the content view starts
+// scrolling. Below this distance the touch sequence is still considered a tap,
+// so controls inside the scroll view are not cancelled by slight jitter.
+const float kPanTouchSlop = 8;
+
 // The minimum velocity that will enable the mechanism of stopping content view
 // gradually while scrolling.
 const float kScrollVelocityThreshold = 100;
@@ -73,6 +84,7 @@ ScrollView::ScrollView()
       bounces_(true), content_view_(new Widget(false)),
       deceleration_rate_(kDefaultDecelerationRate), enables_paging_(false),
       enables_scroll_(true), moves_content_view_to_page_(0), page_width_(0),
+      pan_gesture_recognizer_(new PanGestureRecognizer),
       scroll_indicator_insets_({0, 0, 0, 0}),
       shows_horizontal_scroll_indicator_(true),
       shows_vertical_scroll_indicator_(true) {
@@ -96,6 +108,11 @@ ScrollView::ScrollView()
   horizontal_animation_states_.is_bouncing = false;
   vertical_animation_states_.is_animating = false;
   vertical_animation_states_.is_bouncing = false;
+
+  // Initializes the pan gesture recognizer.
+  pan_gesture_recognizer_->set_minimum_distance(kPanTouchSlop);
+  pan_gesture_recognizer_->BindAction(&ScrollView::HandlePanGesture, this);
+  AddGestureRecognizer(pan_gesture_recognizer_);
 }
 
 ScrollView::~ScrollView() {
@@ -236,6 +253,18 @@ bool ScrollView::BringChildToFront(Widget* child) {
   return content_view_->BringChildToFront(child);
 }
 
+void ScrollView::EndScrolling() {
+  ignores_upcoming_events_ = true;
+  is_scrolling_ = false;
+  StopScrollingGradually();
+  // Hides scrollers if not animating.
+  if (!horizontal_animation_states_.is_animating &&
+      !vertical_animation_states_.is_animating) {
+    horizontal_scroller_->HideInAnimation();
+    vertical_scroller_->HideInAnimation();
+  }
+}
+
 Point ScrollView::GetContentViewOffset() const {
   return {-content_view_->GetX(), -content_view_->GetY()};
 }
@@ -290,50 +319,6 @@ int ScrollView::GetPage(const float origin_x) const {
   return (GetWidth() / 2 - origin_x) / kPageWidth;
 }
 
-bool ScrollView::GetScrollDirection(ScrollDirection* direction) const {
-  if (event_history_.size() < 2)
-    return false;
-
-  *direction = static_cast<ScrollDirection>(0);
-  ScrollEvent latest_event = event_history_.back();
-  ScrollEvent previous_event = event_history_.front();
-
-  const float kOffsetX = latest_event.location.x - previous_event.location.x;
-  const float kOffsetY = latest_event.location.y - previous_event.location.y;
-  if (kOffsetX == 0 && kOffsetY == 0) {
-    return false;
-  }
-
-  const float kTheta = std::atan2(kOffsetY, kOffsetX);
-  float angle = (kTheta + M_PI / 2) * 180 / M_PI;
-  if (angle < 0) angle += 360;
-  float half_range = 360.0 / 8 / 2;
-  if (acceptable_scroll_directions_ == (ScrollDirection::kHorizontal |
-                                        ScrollDirection::kVertical)) {
-    if (angle < half_range || angle > (360 - half_range) ||
-        (angle > (180 - half_range) && angle < (180 + half_range))) {
-      *direction = ScrollDirection::kVertical;
-      return true;
-    }
-    if ((angle > (90 - half_range) && angle < (90 + half_range)) ||
-        (angle > (270 - half_range) && angle < (270 + half_range))) {
-      *direction = ScrollDirection::kHorizontal;
-      return true;
-    }
-    *direction = static_cast<ScrollDirection>(ScrollDirection::kVertical |
-                                              ScrollDirection::kHorizontal);
-    return true;
-  }
-  // Acceptable direction is either horizontal or vertical.
-  half_range = 360.0 / 4 / 2;
-  if (angle < half_range || angle > (270 + half_range) ||
-      (angle > (180 - half_range) && angle < (180 + half_range)))
-    *direction = ScrollDirection::kVertical;
-  else
-    *direction = ScrollDirection::kHorizontal;
-  return true;
-}
-
 void ScrollView::GetScrollVelocity(float* horizontal_velocity,
                                    float* vertical_velocity) {
   if (horizontal_velocity != nullptr)
@@ -350,7 +335,7 @@ void ScrollView::GetScrollVelocity(float* horizontal_velocity,
     initial_event = event_history_[i];
     elapsed_time = last_event.timestamp - initial_event.timestamp;
     // Stops if reached the expected minimum time for calculating the velocity.
-    if (elapsed_time > 0.07)
+    if (elapsed_time > kMinimumVelocityMeasuringDuration)
       break;
   }
   if (elapsed_time <= 0) {
@@ -390,70 +375,146 @@ void ScrollView::GetScrollVelocity(float* horizontal_velocity,
 }
 
 bool ScrollView::HandleEvent(Event* event) {
-  if (horizontal_animation_states_.is_bouncing)
+  if (horizontal_animation_states_.is_bouncing) {
     ignores_upcoming_events_ = true;
+    pan_gesture_recognizer_->set_is_enabled(false);
+  }
   if (ignores_upcoming_events_)
     return true;
 
-  // Finalization.
-  if (event->type() == Event::Type::kUp ||
-      event->type() == Event::Type::kCancel ||
-      event->locations()->size() > 1) {
-    ignores_upcoming_events_ = true;
-    is_scrolling_ = false;
-    StopScrollingGradually();
-    // Hides scrollers if not animating.
-    if (!horizontal_animation_states_.is_animating &&
-        !vertical_animation_states_.is_animating) {
-      horizontal_scroller_->HideInAnimation();
-      vertical_scroller_->HideInAnimation();
+  // Handles the first receivied event.
+  if (event_history_.empty())
+    StopAnimation();
+  // Records the coalesced samples as well so the scroll direction and
+  // velocity are measured at the rate the platform samples the pointer.
+  event->GetSamples(event->GetPointerId(0), &event_samples_);
+  for (const Event::Sample& sample : event_samples_)
+    event_history_.push_back({sample.location, sample.timestamp});
+  // Drops the events no longer needed for measuring the velocity so the
+  // history stays short during long drags.
+  if (!event_history_.empty()) {
+    const double kOldestTimestamp = \
+        event_history_.back().timestamp - kMinimumVelocityMeasuringDuration;
+    int number_of_expired_events = 0;
+    while (number_of_expired_events + 2 <
+               static_cast<int>(event_history_.size()) &&
+           event_history_[number_of_expired_events + 1].timestamp <
+               kOldestTimestamp) {
+      ++number_of_expired_events;
     }
-    return false;
+    event_history_.erase(event_history_.begin(),
+                         event_history_.begin() + number_of_expired_events);
   }
 
-  const double kTimestamp = Clock::GetTimestamp();
-  Point current_location = event->locations()->at(0);
+  // The rest is handled by `HandlePanGesture()` unless the pan gesture
+  // failed, which happens if the pointer moves in an unacceptable direction
+  // or the touch sequence ends before the pointer moves.
+  if (pan_gesture_recognizer_->state() != GestureRecognizer::State::kFailed)
+    return true;
+  if (event->type() == Event::Type::kMove &&
+      event->locations()->size() == 1) {
+    ignores_upcoming_events_ = true;
+    return true;
+  }
+  EndScrolling();
+  return false;
+}
 
-  // Handles the first receivied event.
-  if (event_history_.empty()) {
-    StopAnimation();
+void ScrollView::HandlePanGesture(GestureRecognizer* recognizer) {
+  const GestureRecognizer::State kState = recognizer->state();
+  if (kState == GestureRecognizer::State::kEnded ||
+      kState == GestureRecognizer::State::kCancelled) {
+    EndScrolling();
+    return;
+  }
+  if (kState != GestureRecognizer::State::kBegan &&
+      kState != GestureRecognizer::State::kChanged) {
+    return;
+  }
+
+  // Moves the content view to where the pointer is predicted to be when the
+  // frame is presented if the widget view predicts touches.
+  const Point kTranslation = \
+      pan_gesture_recognizer_->GetPredictedTranslation();
+  if (kState == GestureRecognizer::State::kBegan) {
+    is_scrolling_ = true;
+    locked_scroll_directions_ = static_cast<ScrollDirection>(
+        pan_gesture_recognizer_->locked_directions());
+    // Excludes the touch slop traveled before the pan began so the content
+    // view does not jump.
     initial_scroll_content_view_origin_ = {content_view_->GetX(),
                                            content_view_->GetY()};
+    if ((locked_scroll_directions_ & ScrollDirection::kHorizontal) != 0)
+      initial_scroll_content_view_origin_.x -= kTranslation.x;
+    if ((locked_scroll_directions_ & ScrollDirection::kVertical) != 0)
+      initial_scroll_content_view_origin_.y -= kTranslation.y;
   }
-  event_history_.push_back({current_location, kTimestamp});
+  Point origin = initial_scroll_content_view_origin_;
+  if ((locked_scroll_directions_ & ScrollDirection::kHorizontal) != 0)
+    origin.x += kTranslation.x;
+  if ((locked_scroll_directions_ & ScrollDirection::kVertical) != 0)
+    origin.y += kTranslation.y;
+  SetContentViewOrigin(origin);
+}
 
-  // Handles the move event.
-  if (event->type() != Event::Type::kMove)
-    return false;
+// The platform already accelerates scroll deltas and generates the momentum
+// of trackpad gestures, so the content view simply follows the deltas.
+void ScrollView::HandleScrollEvent(Event* event) {
+  // Touch sequences take precedence over scroll events.
+  const GestureRecognizer::State kPanState = pan_gesture_recognizer_->state();
+  if (kPanState == GestureRecognizer::State::kBegan ||
+      kPanState == GestureRecognizer::State::kChanged) {
+    return;
+  }
 
-  if (locked_scroll_directions_ == static_cast<ScrollDirection>(0)) {
-    if (always_scroll_both_directions_ &&
-        (acceptable_scroll_directions_ & ScrollDirection::kHorizontal) != 0 &&
-        (acceptable_scroll_directions_ & ScrollDirection::kVertical) != 0) {
-      locked_scroll_directions_ = acceptable_scroll_directions_;
-    } else {
-      ScrollDirection scroll_direction;
-      if (!GetScrollDirection(&scroll_direction))
-        return true;
-      locked_scroll_directions_ = static_cast<ScrollDirection>(
-          acceptable_scroll_directions_ & scroll_direction);
-      if (locked_scroll_directions_ == static_cast<ScrollDirection>(0)) {
-        ignores_upcoming_events_ = true;
-        return true;
-      }
+  // Ignores the delta along the directions the scroll view cannot scroll.
+  UpdateAcceptableScrollDirections();
+  Point delta = event->scroll_delta();
+  if ((acceptable_scroll_directions_ & ScrollDirection::kHorizontal) == 0)
+    delta.x = 0;
+  if ((acceptable_scroll_directions_ & ScrollDirection::kVertical) == 0)
+    delta.y = 0;
+
+  const Event::ScrollPhase kPhase = event->scroll_phase();
+  if (kPhase == Event::ScrollPhase::kBegan ||
+      kPhase == Event::ScrollPhase::kNone) {
+    StopAnimation();
+  }
+  if (enables_paging_) {
+    // Momentum is ignored since the content view settles at a page as soon
+    // as the fingers leave the trackpad.
+    if (kPhase == Event::ScrollPhase::kMomentum ||
+        kPhase == Event::ScrollPhase::kMomentumEnded) {
+      return;
+    }
+    if (kPhase == Event::ScrollPhase::kEnded) {
+      is_scrolling_ = false;
+      BounceContentViewHorizontally();
+      return;
+    }
+    if (kPhase == Event::ScrollPhase::kNone && delta.x != 0) {
+      const int kPage = std::max(0, std::min(
+          GetMaximumPage(), GetCurrentPage() + (delta.x < 0 ? 1 : -1)));
+      ShowPage(kPage, kAnimationDurationPerPage);
+      return;
     }
-    is_scrolling_ = true;
   }
 
-  // Moves the content view.
-  ScrollEvent first_event = event_history_.front();
-  Point origin = initial_scroll_content_view_origin_;
-  if ((locked_scroll_directions_ & ScrollDirection::kHorizontal) != 0)
-    origin.x += current_location.x - first_event.location.x;
-  if ((locked_scroll_directions_ & ScrollDirection::kVertical) != 0)
-    origin.y += current_location.y - first_event.location.y;
+  float minimum_x, minimum_y, maximum_x, maximum_y;
+  GetContentViewBoundaries(&minimum_x, &minimum_y, &maximum_x, &maximum_y);
+  Point origin = {content_view_->GetX() + delta.x,
+                  content_view_->GetY() + delta.y};
+  origin.x = std::max(minimum_x, std::min(maximum_x, origin.x));
+  origin.y = std::max(minimum_y, std::min(maximum_y, origin.y));
+  is_scrolling_ = true;
   SetContentViewOrigin(origin);
-  return false;
+  if (kPhase == Event::ScrollPhase::kNone ||
+      kPhase == Event::ScrollPhase::kEnded ||
+      kPhase == Event::ScrollPhase::kMomentumEnded) {
+    is_scrolling_ = false;
+    horizontal_scroller_->HideInAnimation();
+    vertical_scroller_->HideInAnimation();
+  }
 }
 
 bool ScrollView::HorizontalScrollingIsAcceptable() const {
@@ -637,16 +698,7 @@ bool ScrollView::ShouldHandleEvent(const Point location) {
   if (!enables_scroll_ || !CollidePoint(location, 0))
     return false;
 
-  // Determines acceptable scroll directions.
-  acceptable_scroll_directions_ = static_cast<ScrollDirection>(0);
-  if (HorizontalScrollingIsAcceptable()) {
-    acceptable_scroll_directions_ = static_cast<ScrollDirection>(
-        acceptable_scroll_directions_ | ScrollDirection::kHorizontal);
-  }
-  if (VerticalScrollingIsAcceptable()) {
-    acceptable_scroll_directions_ = static_cast<ScrollDirection>(
-        acceptable_scroll_directions_ | ScrollDirection::kVertical);
-  }
+  UpdateAcceptableScrollDirections();
   if (acceptable_scroll_directions_ == static_cast<ScrollDirection>(0))
     return false;
 
@@ -654,9 +706,32 @@ bool ScrollView::ShouldHandleEvent(const Point location) {
   ignores_upcoming_events_ = false;
   locked_scroll_directions_ = static_cast<ScrollDirection>(0);
   is_scrolling_ = false;
+
+  // Locks the pan to a single direction unless both directions are always
+  // scrolled together.
+  pan_gesture_recognizer_->set_directions(
+      static_cast<PanGestureRecognizer::Direction>(
+          acceptable_scroll_directions_));
+  pan_gesture_recognizer_->set_locks_direction(
+      !always_scroll_both_directions_ ||
+      acceptable_scroll_directions_ != (ScrollDirection::kHorizontal |
+                                        ScrollDirection::kVertical));
+  pan_gesture_recognizer_->set_is_enabled(true);
   return true;
 }
 
+bool ScrollView::ShouldHandleScrollEvent(const Point delta) {
+  if (!enables_scroll_)
+    return false;
+  const bool kOverflowsHorizontally = content_view_->GetWidth() > GetWidth();
+  const bool kOverflowsVertically = content_view_->GetHeight() > GetHeight();
+  if (delta.x == 0 && delta.y == 0)
+    return kOverflowsHorizontally || kOverflowsVertically;
+  if (std::abs(delta.x) > std::abs(delta.y))
+    return kOverflowsHorizontally;
+  return kOverflowsVertically;
+}
+
 void ScrollView::ShowPage(const int page, const double duration) {
   const float kPageOrigin = GetContentViewOriginForPage(page);
   if (duration <= 0)
@@ -744,6 +819,33 @@ void ScrollView::StopScrollingGradually() {
   }
 }
 
+void ScrollView::TranslateContentView(const Point displacement) {
+  if (displacement.x == 0 && displacement.y == 0)
+    return;
+
+  content_view_->SetX(content_view_->GetX() + displacement.x);
+  content_view_->SetY(content_view_->GetY() + displacement.y);
+  initial_scroll_content_view_origin_.x += displacement.x;
+  initial_scroll_content_view_origin_.y += displacement.y;
+  horizontal_animation_states_.initial_location += displacement.x;
+  horizontal_animation_states_.destination_location += displacement.x;
+  vertical_animation_states_.initial_location += displacement.y;
+  vertical_animation_states_.destination_location += displacement.y;
+  RedrawScrollers();
+}
+
+void ScrollView::UpdateAcceptableScrollDirections() {
+  acceptable_scroll_directions_ = static_cast<ScrollDirection>(0);
+  if (HorizontalScrollingIsAcceptable()) {
+    acceptable_scroll_directions_ = static_cast<ScrollDirection>(
+        acceptable_scroll_directions_ | ScrollDirection::kHorizontal);
+  }
+  if (VerticalScrollingIsAcceptable()) {
+    acceptable_scroll_directions_ = static_cast<ScrollDirection>(
+        acceptable_scroll_directions_ | ScrollDirection::kVertical);
+  }
+}
+
 void ScrollView::UpdateAnimationOriginAndStates(const double timestamp,
                                                 AnimationStates* states) {
   if (!states->is_animating)
@@ -22,17 +22,24 @@
 #include <vector>
 
 #include "moui/base.h"
+#include "moui/core/event.h"
 #include "moui/nanovg_hook.h"
+#include "moui/widgets/pan_gesture_recognizer.h"
 #include "moui/widgets/widget.h"
 
 namespace moui {
 
 // Forward declaration.
-class Event;
+class GestureRecognizer;
 class Scroller;
 
 // The `ScrollView` class allows to display content that is larger than the
-// size of the scroll view itself.
+// size of the scroll view itself. Scrolling is recognized by
+// `pan_gesture_recognizer()`, so nested scroll views and other gesture
+// recognizers compete for touch sequences in the gesture arena of the widget
+// view, and the responders inside a scroll view are cancelled once it starts
+// scrolling. Scroll events from mouse wheels and trackpads move the content
+// view directly by their deltas.
 class ScrollView : public Widget {
  public:
   ScrollView();
@@ -133,6 +140,9 @@ class ScrollView : public Widget {
            GetWidth() : page_width_;
   }
   void set_page_width(const float page_width);
+  PanGestureRecognizer* pan_gesture_recognizer() const {
+    return pan_gesture_recognizer_;
+  }
   EdgeInsets scroll_indicator_insets() const {
     return scroll_indicator_insets_;
   }
@@ -167,9 +177,18 @@ class ScrollView : public Widget {
   void GetScrollVelocity(float* horizontal_velocity,
                          float* vertical_velocity);
 
-  // Inherited from `Widget` class. Controls the scroll behavior.
+  // Inherited from `Widget` class. Stops the ongoing animation when a touch
+  // sequence begins, records the event history for measuring the scroll
+  // velocity, and settles the content view if the sequence ends without
+  // scrolling.
   bool HandleEvent(Event* event) override;
 
+  // Inherited from `Widget` class. Moves the content view by the scroll delta
+  // without passing its boundaries. If paging is enabled, each wheel step
+  // turns a page and the content view settles at a page when the fingers
+  // leave the trackpad.
+  void HandleScrollEvent(Event* event) override;
+
   // Inserts a view above the content view in the view hierarchy.
   bool InsertChildAboveContentView(Widget* child);
 
@@ -183,9 +202,19 @@ class ScrollView : public Widget {
   // Inherited from `Widget` class.
   bool ShouldHandleEvent(const Point location) override;
 
+  // Inherited from `Widget` class. Returns `true` if scrolling is enabled and
+  // the content view is larger than the scroll view along the dominant axis
+  // of the delta, or along either axis if the delta is zero.
+  bool ShouldHandleScrollEvent(const Point delta) override;
+
   // Animates content view to stop gradually.
   void StopScrollingGradually();
 
+  // Moves the content view by the specified displacement immediately. Unlike
+  // `SetContentViewOrigin()`, the ongoing dragging and scrolling animation
+  // are moved along so the user's gesture continues seamlessly.
+  void TranslateContentView(const Point displacement);
+
   // Inherited from `Widget` class. Animates the content view and updates
   // the animation states accordingly.
   bool WidgetViewWillRender(NVGcontext* context) override;
@@ -256,6 +285,10 @@ class ScrollView : public Widget {
   // Moves the content view to not reach its vertical boundaries.
   void BounceContentViewVertically();
 
+  // Stops handling the current touch sequence and lets the content view
+  // scroll to a stop gradually.
+  void EndScrolling();
+
   // Returns the content view's horizontal origin for the specified page.
   float GetContentViewOriginForPage(const int page) const;
 
@@ -269,10 +302,9 @@ class ScrollView : public Widget {
   // Returns the page of the specified horizontal origin of the content view.
   int GetPage(const float origin_x) const;
 
-  // Gets the current scroll direction based on the
-  // `acceptable_scroll_directions_` and the latest `event_history_`.
-  // Returns `false` on failure.
-  bool GetScrollDirection(ScrollDirection* direction) const;
+  // Moves the content view along with the pan gesture recognized by
+  // `pan_gesture_recognizer_`.
+  void HandlePanGesture(GestureRecognizer* recognizer);
 
   // Redraws the scroller for a specific direction.
   void RedrawScroller(const float scroll_view_length,
@@ -295,11 +327,16 @@ class ScrollView : public Widget {
                                  const float content_view_padding,
                                  const bool always_bounces) const;
 
+  // Determines `acceptable_scroll_directions_` from the current
+  // configuration.
+  void UpdateAcceptableScrollDirections();
+
   void UpdateAnimationOriginAndStates(const double timestamp,
                                       AnimationStates* states);
 
   // Indicates the direction that is acceptable for scrolling. This value is
-  // determined in the `ShouldHandleEvent()` method.
+  // determined in the `ShouldHandleEvent()` and `HandleScrollEvent()`
+  // methods.
   ScrollDirection acceptable_scroll_directions_;
 
   // Indicates whether bouncing always occurs when horizontal scrolling reaches
@@ -354,9 +391,12 @@ class ScrollView : public Widget {
   // view does not respond to coming events. The default value is `true`.
   bool enables_scroll_;
 
-  // Keeps all event reocrds in the current sequenece of events.
+  // Keeps the recent event reocrds in the current sequenece of events.
   std::vector<ScrollEvent> event_history_;
 
+  // Reused by `HandleEvent()` to collect the samples of each event.
+  std::vector<Event::Sample> event_samples_;
+
   // Keeps the states for animating content view in horizontal direction.
   AnimationStates horizontal_animation_states_;
 
@@ -368,7 +408,7 @@ class ScrollView : public Widget {
   // This value is reset to `false` in `ShouldHandleEvent()`.
   bool ignores_upcoming_events_;
 
-  // Records the content view's origin when receiving the first scroll event.
+  // Records the content view's origin when the pan gesture begins.
   Point initial_scroll_content_view_origin_;
 
   // Records the current page when received the first scroll event.
@@ -389,6 +429,10 @@ class ScrollView : public Widget {
   // the scroll view's width instead of the actual value.
   float page_width_;
 
+  // The weak reference to the gesture recognizer recognizing scrolling. It
+  // is owned by the scroll view itself as one of its gesture recognizers.
+  PanGestureRecognizer* pan_gesture_recognizer_;
+
   // Indicates the distance the scroll indicators are inset from the edge of
   // the scroll view.
   EdgeInsets scroll_indicator_insets_;
@@ -18,10 +18,11 @@
 #include "moui/widgets/table_view.h"
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
-#include <map>
+#include <functional>
 #include <string>
-#include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include "moui/base.h"
@@ -30,6 +31,7 @@
 #include "moui/nanovg_hook.h"
 #include "moui/widgets/scroll_view.h"
 #include "moui/widgets/table_view_cell.h"
+#include "moui/widgets/table_view_index_bar.h"
 #include "moui/widgets/widget_view.h"
 
 namespace {
@@ -38,53 +40,527 @@ namespace {
 const float kDefaultHeightBetweenSections = 35;
 // The default row height in points.
 const float kDefaultRowHeight = 44;
+// The maximum number of cell snapshots captured in a frame.
+const int kMaximumCellSnapshotsPerFrame = 2;
+// The maximum number of times to measure visible rows again in a frame after
+// measured rows bring more rows into view.
+const int kMaximumMeasuringPasses = 4;
+// The maximum distance in screens to prefetch rows ahead of the visible rows.
+const float kMaximumPrefetchingDistance = 3;
+// The duration in seconds of scrolling at the current velocity that the
+// prefetched rows should cover.
+const float kPrefetchingLookaheadDuration = 0.5;
+// The reuse identifier of placeholder cells displayed while scrubbing.
+const char kPlaceholderCellReuseIdentifier[] = "moui.TableView.placeholder";
+// The number of rows represented by each word of a selection bitset.
+const int kRowsPerSelectionWord = 64;
+// The reuse identifier of cells displaying snapshots.
+const char kSnapshotCellReuseIdentifier[] = "moui.TableView.snapshot";
+// The duration in seconds of sliding cells displaced by animated updates.
+const double kUpdateAnimationDuration = 0.25;
+
+// Returns `true` if `cell_index` is ordered before `other_cell_index`.
+bool CellIndexPrecedes(const moui::TableView::CellIndex cell_index,
+                       const moui::TableView::CellIndex other_cell_index) {
+  return cell_index.section_index < other_cell_index.section_index ||
+         (cell_index.section_index == other_cell_index.section_index &&
+          cell_index.row_index < other_cell_index.row_index);
+}
+
+// Returns the key of `TableView::visible_cells_by_index_` for the specified
+// section and row.
+uint64_t GetCellIndexKey(const int section_index, const int row_index) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(section_index)) << 32) |
+         static_cast<uint32_t>(row_index);
+}
+
+// Returns the version of a cell snapshot, which changes with both the
+// content version of the row and the selected state of the cell.
+int64_t GetCellSnapshotVersion(const int content_version,
+                               const bool selected) {
+  return (static_cast<int64_t>(content_version) << 1) | (selected ? 1 : 0);
+}
+
+// Returns the mask of bits from `first_bit` to `last_bit` inclusively.
+uint64_t GetSelectionMask(const int first_bit, const int last_bit) {
+  return (~0ULL << first_bit) &
+         (~0ULL >> (kRowsPerSelectionWord - 1 - last_bit));
+}
 
 }  // namespace
 
 namespace moui {
 
+TableView::RowSelection::Iterator::Iterator(const RowSelection* selection,
+                                            const int section_index,
+                                            const int row_index)
+    : selection_(selection), section_index_(-1), row_index_(-1) {
+  if (section_index >= 0 && row_index >= 0)
+    Seek(section_index, row_index);
+}
+
+TableView::RowSelection::Iterator&
+TableView::RowSelection::Iterator::operator++() {
+  if (section_index_ >= 0)
+    Seek(section_index_, row_index_ + 1);
+  return *this;
+}
+
+void TableView::RowSelection::Iterator::Seek(int section_index,
+                                             int row_index) {
+  const int kNumberOfSections = \
+      static_cast<int>(selection_->sections_.size());
+  for (; section_index < kNumberOfSections; ++section_index, row_index = 0) {
+    const std::vector<uint64_t>& words = selection_->sections_[section_index];
+    const int kNumberOfWords = static_cast<int>(words.size());
+    int word_index = row_index / kRowsPerSelectionWord;
+    if (word_index >= kNumberOfWords)
+      continue;
+    uint64_t word = words[word_index] & \
+                    (~0ULL << (row_index % kRowsPerSelectionWord));
+    while (word == 0 && ++word_index < kNumberOfWords)
+      word = words[word_index];
+    if (word != 0) {
+      section_index_ = section_index;
+      row_index_ = word_index * kRowsPerSelectionWord + __builtin_ctzll(word);
+      return;
+    }
+  }
+  section_index_ = -1;
+  row_index_ = -1;
+}
+
+TableView::RowSelection::RowSelection() : count_(0) {
+}
+
+TableView::RowSelection::~RowSelection() {
+}
+
+void TableView::RowSelection::Clear() {
+  sections_.clear();
+  count_ = 0;
+}
+
+bool TableView::RowSelection::Contains(const CellIndex cell_index) const {
+  if (cell_index.section_index < 0 || cell_index.row_index < 0 ||
+      cell_index.section_index >= static_cast<int>(sections_.size())) {
+    return false;
+  }
+  const std::vector<uint64_t>& words = sections_[cell_index.section_index];
+  const int kWordIndex = cell_index.row_index / kRowsPerSelectionWord;
+  if (kWordIndex >= static_cast<int>(words.size()))
+    return false;
+  return (words[kWordIndex] >> (cell_index.row_index % kRowsPerSelectionWord))
+         & 1;
+}
+
+bool TableView::RowSelection::Insert(const CellIndex cell_index) {
+  return InsertRange(cell_index.section_index, cell_index.row_index,
+                     cell_index.row_index) > 0;
+}
+
+int TableView::RowSelection::InsertRange(const int section_index,
+                                         const int first_row_index,
+                                         const int last_row_index) {
+  if (section_index < 0 || first_row_index < 0 ||
+      last_row_index < first_row_index) {
+    return 0;
+  }
+  if (section_index >= static_cast<int>(sections_.size()))
+    sections_.resize(section_index + 1);
+  std::vector<uint64_t>* words = &sections_[section_index];
+  const int kFirstWordIndex = first_row_index / kRowsPerSelectionWord;
+  const int kLastWordIndex = last_row_index / kRowsPerSelectionWord;
+  if (kLastWordIndex >= static_cast<int>(words->size()))
+    words->resize(kLastWordIndex + 1, 0);
+
+  int number_of_inserted_rows = 0;
+  for (int word_index = kFirstWordIndex; word_index <= kLastWordIndex;
+       ++word_index) {
+    const uint64_t kMask = GetSelectionMask(
+        word_index == kFirstWordIndex ?
+            first_row_index % kRowsPerSelectionWord : 0,
+        word_index == kLastWordIndex ?
+            last_row_index % kRowsPerSelectionWord :
+            kRowsPerSelectionWord - 1);
+    uint64_t* word = &(*words)[word_index];
+    number_of_inserted_rows += __builtin_popcountll(kMask & ~(*word));
+    *word |= kMask;
+  }
+  count_ += number_of_inserted_rows;
+  return number_of_inserted_rows;
+}
+
+void TableView::RowSelection::MoveSection(const int from_section_index,
+                                          const int to_section_index) {
+  const int kNumberOfSections = static_cast<int>(sections_.size());
+  if (from_section_index < 0 || to_section_index < 0 ||
+      from_section_index == to_section_index ||
+      (from_section_index >= kNumberOfSections &&
+       to_section_index >= kNumberOfSections)) {
+    return;
+  }
+  sections_.resize(
+      std::max(kNumberOfSections,
+               std::max(from_section_index, to_section_index) + 1));
+  if (from_section_index < to_section_index) {
+    std::rotate(sections_.begin() + from_section_index,
+                sections_.begin() + from_section_index + 1,
+                sections_.begin() + to_section_index + 1);
+  } else {
+    std::rotate(sections_.begin() + to_section_index,
+                sections_.begin() + from_section_index,
+                sections_.begin() + from_section_index + 1);
+  }
+}
+
+bool TableView::RowSelection::Remove(const CellIndex cell_index) {
+  return RemoveRange(cell_index.section_index, cell_index.row_index,
+                     cell_index.row_index) > 0;
+}
+
+int TableView::RowSelection::RemoveRange(const int section_index,
+                                         const int first_row_index,
+                                         const int last_row_index) {
+  if (section_index < 0 || first_row_index < 0 ||
+      last_row_index < first_row_index ||
+      section_index >= static_cast<int>(sections_.size())) {
+    return 0;
+  }
+  std::vector<uint64_t>* words = &sections_[section_index];
+  const int kFirstWordIndex = first_row_index / kRowsPerSelectionWord;
+  const int kLastWordIndex = std::min(
+      last_row_index / kRowsPerSelectionWord,
+      static_cast<int>(words->size()) - 1);
+
+  int number_of_removed_rows = 0;
+  for (int word_index = kFirstWordIndex; word_index <= kLastWordIndex;
+       ++word_index) {
+    const uint64_t kMask = GetSelectionMask(
+        word_index == kFirstWordIndex ?
+            first_row_index % kRowsPerSelectionWord : 0,
+        word_index == last_row_index / kRowsPerSelectionWord ?
+            last_row_index % kRowsPerSelectionWord :
+            kRowsPerSelectionWord - 1);
+    uint64_t* word = &(*words)[word_index];
+    number_of_removed_rows += __builtin_popcountll(kMask & *word);
+    *word &= ~kMask;
+  }
+  count_ -= number_of_removed_rows;
+  return number_of_removed_rows;
+}
+
+// Rebuilds the words from the first affected row on. Words before it are kept
+// as is, and each remaining selected row is either dropped or moved.
+void TableView::RowSelection::ShiftRows(const int section_index,
+                                        const int row_index,
+                                        const int offset) {
+  if (section_index < 0 || row_index < 0 || offset == 0 ||
+      section_index >= static_cast<int>(sections_.size())) {
+    return;
+  }
+  std::vector<uint64_t>* words = &sections_[section_index];
+  const int kFirstAffectedRowIndex = \
+      std::max(0, row_index + std::min(0, offset));
+  const int kFirstWordIndex = kFirstAffectedRowIndex / kRowsPerSelectionWord;
+  const int kNumberOfWords = static_cast<int>(words->size());
+  if (kFirstWordIndex >= kNumberOfWords)
+    return;
+
+  const uint64_t kAffectedMask = GetSelectionMask(
+      kFirstAffectedRowIndex % kRowsPerSelectionWord,
+      kRowsPerSelectionWord - 1);
+  std::vector<uint64_t> shifted_words(words->begin(),
+                                      words->begin() + kFirstWordIndex + 1);
+  shifted_words.back() &= ~kAffectedMask;
+  for (int word_index = kFirstWordIndex; word_index < kNumberOfWords;
+       ++word_index) {
+    uint64_t word = (*words)[word_index];
+    if (word_index == kFirstWordIndex)
+      word &= kAffectedMask;
+    while (word != 0) {
+      const int kRowIndex = \
+          word_index * kRowsPerSelectionWord + __builtin_ctzll(word);
+      word &= word - 1;
+      if (kRowIndex < row_index) {  // dropped
+        --count_;
+        continue;
+      }
+      const int kShiftedRowIndex = kRowIndex + offset;
+      const int kShiftedWordIndex = kShiftedRowIndex / kRowsPerSelectionWord;
+      if (kShiftedWordIndex >= static_cast<int>(shifted_words.size()))
+        shifted_words.resize(kShiftedWordIndex + 1, 0);
+      shifted_words[kShiftedWordIndex] |= \
+          1ULL << (kShiftedRowIndex % kRowsPerSelectionWord);
+    }
+  }
+  words->swap(shifted_words);
+}
+
+void TableView::RowSelection::ShiftSections(const int section_index,
+                                            const int offset) {
+  const int kNumberOfSections = static_cast<int>(sections_.size());
+  if (section_index < 0 || offset == 0)
+    return;
+
+  if (offset > 0) {
+    if (section_index < kNumberOfSections) {
+      sections_.insert(sections_.begin() + section_index, offset,
+                       std::vector<uint64_t>());
+    }
+    return;
+  }
+  const int kFirstSectionIndex = std::max(0, section_index + offset);
+  const int kLastSectionIndex = std::min(section_index, kNumberOfSections);
+  if (kFirstSectionIndex >= kLastSectionIndex)
+    return;
+  for (int index = kFirstSectionIndex; index < kLastSectionIndex; ++index) {
+    for (const uint64_t word : sections_[index])
+      count_ -= __builtin_popcountll(word);
+  }
+  sections_.erase(sections_.begin() + kFirstSectionIndex,
+                  sections_.begin() + kLastSectionIndex);
+}
+
 TableView::TableView() :
     ScrollView(), data_source_(nullptr), delegate_(nullptr),
-    down_event_cell_(nullptr),
+    down_event_cell_(nullptr), estimated_row_height_(0),
+    first_prefetching_row_number_(-1),
     height_between_sections_(kDefaultHeightBetweenSections),
-    last_bottommost_content_view_offset_(-1),
-    last_topmost_content_view_offset_(-1),
-    row_height_(TableView::kAutomaticDimenstion),
-    should_update_layout_(true),
+    highlight_callback_handle_(0), index_bar_(nullptr), is_scrubbing_(false),
+    last_bottommost_content_view_offset_(-1), last_layout_timestamp_(-1),
+    last_prefetching_row_number_(-1), last_topmost_content_view_offset_(-1),
+    pending_scrubbing_offset_(-1), pinned_section_header_(nullptr),
+    pinned_section_header_framebuffer_(nullptr),
+    pinned_section_header_framebuffer_scale_factor_(0),
+    pinned_section_header_offset_(0), pins_section_headers_(false),
+    placeholder_cell_handle_(-1), prefetch_data_source_(nullptr),
+    prefetching_statistics_({0, 0, 0, 0, 0}), reusable_cell_pool_(this),
+    row_height_(TableView::kAutomaticDimenstion), scroll_velocity_(0),
+    should_capture_cell_snapshots_(false),
+    should_render_pinned_section_header_(false), should_update_layout_(true),
     separator_color_(nvgRGB(234, 234, 234)),
-    separator_insets_({0, 20, 0, 20}),
+    separator_insets_({0, 20, 0, 20}), snapshot_cell_handle_(-1),
+    table_footer_offset_(-1),
     table_footer_view_(nullptr),
-    table_header_view_(nullptr) {
+    table_header_view_(nullptr),
+    update_animation_timestamp_(0),
+    update_level_(0) {
   set_always_bounce_vertical(true);
   set_always_scroll_both_directions(false);
   set_background_color(nvgRGBA(240, 239, 245, 255));
 
-  layout_view_ = new moui::Widget(true);
+  layout_view_ = new moui::Widget(false);
   layout_view_->set_is_opaque(false);
   layout_view_->BindRenderFunction(&TableView::RenderLayoutView, this);
   layout_view_->SetWidth(Widget::Unit::kPercent, 100);
   layout_view_->SetHeight(Widget::Unit::kPercent, 100);
   InsertChildAboveContentView(layout_view_);
+
+  pinned_section_header_view_ = new moui::Widget(false);
+  pinned_section_header_view_->set_is_opaque(false);
+  pinned_section_header_view_->BindRenderFunction(
+      &TableView::RenderPinnedSectionHeaderView, this);
+  pinned_section_header_view_->SetWidth(Widget::Unit::kPercent, 100);
+  pinned_section_header_view_->SetHeight(Widget::Unit::kPercent, 100);
+  Widget::InsertChildAboveSibling(pinned_section_header_view_, layout_view_);
+
+  placeholder_cell_handle_ = reusable_cell_pool_.RegisterReuseIdentifier(
+      kPlaceholderCellReuseIdentifier, []() {
+        return new TableViewCell(TableViewCell::Style::kDefault,
+                                 kPlaceholderCellReuseIdentifier);
+      });
+  snapshot_cell_handle_ = reusable_cell_pool_.RegisterReuseIdentifier(
+      kSnapshotCellReuseIdentifier, [this]() {
+        auto cell = new TableViewCell(TableViewCell::Style::kDefault,
+                                      kSnapshotCellReuseIdentifier);
+        cell->set_is_opaque(false);
+        cell->content_view()->SetHidden(true);
+        cell->BindRenderFunction(&TableView::RenderCellSnapshot, this);
+        return cell;
+      });
 }
 
 TableView::~TableView() {
+  Clock::CancelCallback(highlight_callback_handle_);
   // Releases visible cells.
   for (TableViewCell* cell : visible_cells_) {
     moui::Widget::SmartRelease(cell);
   }
-  // Releases reusable cells.
-  for (auto iterator = reusable_cells_.begin();
-       iterator != reusable_cells_.end();
-       ++iterator) {
-    std::queue<TableViewCell*>* table_view_cells = &(iterator->second);
-    while (!table_view_cells->empty()) {
-      TableViewCell* cell = table_view_cells->front();
-      table_view_cells->pop();
-      moui::Widget::SmartRelease(cell);
-    }
-  }
   // Releases managed widgets.
   moui::Widget::SmartRelease(layout_view_);
+  moui::Widget::SmartRelease(pinned_section_header_view_);
+  nvgDeleteFramebuffer(pinned_section_header_framebuffer_);
+  if (index_bar_ != nullptr)
+    index_bar_->table_view_ = nullptr;
+}
+
+bool TableView::BeginImplicitUpdates() {
+  if (update_level_ > 0)
+    return false;
+  BeginUpdates();
+  return true;
+}
+
+// Row numbers of pending prefetching become meaningless once rows are
+// inserted or deleted, so they are cancelled before the first update.
+void TableView::BeginUpdates() {
+  if (update_level_ == 0)
+    CancelPrefetchingRows();
+  ++update_level_;
+}
+
+void TableView::CancelPrefetchingRows() {
+  if (prefetch_data_source_ != nullptr) {
+    NotifyPrefetchingRows(first_prefetching_row_number_,
+                          last_prefetching_row_number_, true);
+  }
+  first_prefetching_row_number_ = -1;
+  last_prefetching_row_number_ = -1;
+}
+
+void TableView::CaptureCellSnapshots() {
+  should_capture_cell_snapshots_ = false;
+  if (delegate_ == nullptr || cell_snapshot_cache_.capacity() <= 0)
+    return;
+
+  // Marks the snapshots displayed by visible cells as the most recently used
+  // so capturing evicts them last.
+  for (TableViewCell* cell : visible_cells_) {
+    if (cell->reuse_identifier_handle() != snapshot_cell_handle_)
+      continue;
+    const CellIndex kCellIndex = {cell->section_index_, cell->row_index_};
+    const int kContentVersion = \
+        delegate_->GetTableViewRowContentVersion(this, kCellIndex);
+    cell_snapshot_cache_.UseSnapshot(
+        GetCellIndexKey(kCellIndex.section_index, kCellIndex.row_index),
+        GetCellSnapshotVersion(kContentVersion,
+                               selected_rows_.Contains(kCellIndex)),
+        {cell->GetWidth(), cell->GetHeight()});
+  }
+
+  int number_of_captured_cells = 0;
+  for (TableViewCell* cell : visible_cells_) {
+    const int kHandle = cell->reuse_identifier_handle();
+    if (kHandle == placeholder_cell_handle_ ||
+        kHandle == snapshot_cell_handle_ || cell->highlighted()) {
+      continue;
+    }
+    const CellIndex kCellIndex = {cell->section_index_, cell->row_index_};
+    const int kContentVersion = \
+        delegate_->GetTableViewRowContentVersion(this, kCellIndex);
+    if (kContentVersion < 0)
+      continue;
+    const uint64_t kKey = GetCellIndexKey(kCellIndex.section_index,
+                                          kCellIndex.row_index);
+    const int64_t kVersion = \
+        GetCellSnapshotVersion(kContentVersion, cell->selected());
+    if (cell_snapshot_cache_.UseSnapshot(
+            kKey, kVersion, {cell->GetWidth(), cell->GetHeight()}) != nullptr) {
+      continue;
+    }
+    // Leaves the remaining cells to the following frames.
+    if (number_of_captured_cells == kMaximumCellSnapshotsPerFrame) {
+      should_capture_cell_snapshots_ = true;
+      break;
+    }
+    cell_snapshot_cache_.Capture(cell, kKey, kVersion);
+    ++number_of_captured_cells;
+  }
+
+  // Visible cells whose snapshots were evicted would render blank, so they
+  // are replaced by live cells in the next layout.
+  for (TableViewCell* cell : visible_cells_) {
+    if (cell->reuse_identifier_handle() == snapshot_cell_handle_ &&
+        cell_snapshot_cache_.GetSnapshot(
+            GetCellIndexKey(cell->section_index_, cell->row_index_),
+            nullptr) == nullptr) {
+      should_update_layout_ = true;
+      Redraw();
+      return;
+    }
+  }
+}
+
+void TableView::ContextWillChange(NVGcontext* context) {
+  ScrollView::ContextWillChange(context);
+  nvgDeleteFramebuffer(pinned_section_header_framebuffer_);
+  pinned_section_header_framebuffer_ = nullptr;
+  cell_snapshot_cache_.Clear();
+  should_update_layout_ = true;
+}
+
+void TableView::DeleteRows(const int section_index, const int row_index,
+                           const int number_of_rows) {
+  if (section_index < 0 || row_index < 0 || number_of_rows <= 0)
+    return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  if (section_index < static_cast<int>(section_layouts_.size())) {
+    SectionLayout* layout = &section_layouts_[section_index];
+    const int kNumberOfRows = static_cast<int>(layout->row_heights.size());
+    if (row_index < kNumberOfRows) {
+      const int kLastRowIndex = std::min(kNumberOfRows,
+                                         row_index + number_of_rows);
+      layout->row_heights.erase(layout->row_heights.begin() + row_index,
+                                layout->row_heights.begin() + kLastRowIndex);
+      layout->estimated_rows.erase(
+          layout->estimated_rows.begin() + row_index,
+          layout->estimated_rows.begin() + kLastRowIndex);
+      layout->first_invalid_row = std::min(layout->first_invalid_row,
+                                           row_index);
+    }
+  }
+  selected_rows_.ShiftRows(section_index, row_index + number_of_rows,
+                           -number_of_rows);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index != section_index ||
+        cell_index.row_index < row_index) {
+      return cell_index;
+    }
+    if (cell_index.row_index < row_index + number_of_rows)
+      return {-1, -1};
+    return {section_index, cell_index.row_index - number_of_rows};
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::DeleteSections(const int section_index,
+                               const int number_of_sections) {
+  if (section_index < 0 || number_of_sections <= 0)
+    return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  const int kNumberOfSections = static_cast<int>(section_layouts_.size());
+  if (section_index < kNumberOfSections) {
+    section_layouts_.erase(
+        section_layouts_.begin() + section_index,
+        section_layouts_.begin() + std::min(
+            kNumberOfSections, section_index + number_of_sections));
+  }
+  selected_rows_.ShiftSections(section_index + number_of_sections,
+                               -number_of_sections);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index < section_index)
+      return cell_index;
+    if (cell_index.section_index < section_index + number_of_sections)
+      return {-1, -1};
+    return {cell_index.section_index - number_of_sections,
+            cell_index.row_index};
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::DeselectAllRows() {
+  if (delegate_ == nullptr) {
+    selected_rows_.Clear();
+    UpdateSelectedStateOfVisibleCells();
+    return;
+  }
+  for (const CellIndex cell_index : GetCellIndexesForSelectedRows())
+    DeselectRow(cell_index);
 }
 
 void TableView::DeselectRow(const CellIndex cell_index) {
@@ -97,64 +573,205 @@ void TableView::DeselectRow(const CellIndex cell_index) {
     return;
   }
 
-  auto iterator = cell_indexes_for_selected_rows_.begin();
-  for (; iterator != cell_indexes_for_selected_rows_.end(); ++iterator) {
-    const CellIndex kCachedCellIndex = static_cast<CellIndex>(*iterator);
-    if (cell_index.section_index == kCachedCellIndex.section_index &&
-        cell_index.row_index == kCachedCellIndex.row_index) {
-      break;
-    }
-  }  // end of `cell_indexes_for_selected_rows_` iterator.
-
   // Updates the sates of the corresopnded cell.
   TableViewCell* cell = GetCell(cell_index);
   if (cell != nullptr) {
     cell->set_selected(false);
   }
 
-  // Removes the cell index from `cell_indexes_for_selected_rows_`.
-  if (iterator != cell_indexes_for_selected_rows_.end()) {
-    cell_indexes_for_selected_rows_.erase(iterator);
-    if (delegate_ != nullptr)
-      delegate_->TableViewDidDeselectRow(this, cell_index);
+  if (selected_rows_.Remove(cell_index) && delegate_ != nullptr)
+    delegate_->TableViewDidDeselectRow(this, cell_index);
+}
+
+void TableView::DeselectRows(const int section_index,
+                             const int first_row_index,
+                             const int last_row_index) {
+  if (delegate_ == nullptr) {
+    selected_rows_.RemoveRange(section_index, first_row_index,
+                               last_row_index);
+  } else {
+    for (int row_index = std::max(0, first_row_index);
+         row_index <= last_row_index;
+         ++row_index) {
+      const CellIndex kCellIndex = {section_index, row_index};
+      if (selected_rows_.Contains(kCellIndex) &&
+          delegate_->TableViewShouldDeselectRow(this, kCellIndex) &&
+          selected_rows_.Remove(kCellIndex)) {
+        delegate_->TableViewDidDeselectRow(this, kCellIndex);
+      }
+    }
   }
+  UpdateSelectedStateOfVisibleCells();
 }
 
-TableViewCell* TableView::DequeueReusableCell(const std::string identifier) {
-  auto queue_match = reusable_cells_.find(identifier);
-  if (queue_match == reusable_cells_.end())
+TableViewCell* TableView::DequeueCellSnapshot(const CellIndex cell_index,
+                                              const Size size) {
+  if (delegate_ == nullptr || cell_snapshot_cache_.capacity() <= 0)
     return nullptr;
 
-  auto reusable_cells = &(queue_match->second);
-  if (reusable_cells->empty())
+  const int kContentVersion = \
+      delegate_->GetTableViewRowContentVersion(this, cell_index);
+  if (kContentVersion < 0)
     return nullptr;
+  const int64_t kVersion = GetCellSnapshotVersion(
+      kContentVersion, selected_rows_.Contains(cell_index));
+  if (cell_snapshot_cache_.UseSnapshot(
+          GetCellIndexKey(cell_index.section_index, cell_index.row_index),
+          kVersion, size) == nullptr) {
+    return nullptr;
+  }
+  return reusable_cell_pool_.DequeueCell(snapshot_cell_handle_);
+}
 
-  TableViewCell* cell = reusable_cells->front();
-  reusable_cells->pop();
-  cell->PrepareForReuse();
-  return cell;
+TableViewCell* TableView::DequeueReusableCell(
+    const int reuse_identifier_handle) {
+  return reusable_cell_pool_.DequeueCell(reuse_identifier_handle);
 }
 
-TableViewCell* TableView::GetCell(const CellIndex cell_index) const {
-  int vector_index = 0;
-  for (CellIndex visible_cell_index : cell_indexes_for_visible_rows_) {
-    if (visible_cell_index.section_index == cell_index.section_index &&
-        visible_cell_index.row_index == cell_index.row_index) {
-      return visible_cells_[vector_index];
+TableViewCell* TableView::DequeueReusableCell(
+    const std::string& reuse_identifier) {
+  return DequeueReusableCell(
+      TableViewCell::GetReuseIdentifierHandle(reuse_identifier));
+}
+
+// Visible rows are laid out again in the next refresh cycle, which replaces
+// their placeholders with cells from the data source.
+void TableView::EndScrubbing() {
+  pending_scrubbing_offset_ = -1;
+  if (!is_scrubbing_)
+    return;
+  is_scrubbing_ = false;
+  should_update_layout_ = true;
+  if (widget_view() != nullptr)
+    widget_view()->Redraw();
+}
+
+// The topmost visible cell that survives the updates serves as the anchor.
+// Its position on screen before the updates is restored by translating the
+// content view, which also keeps any ongoing scrolling intact.
+void TableView::EndUpdates(const bool animating) {
+  if (update_level_ == 0 || --update_level_ > 0)
+    return;
+
+  // Rows may have moved, so snapshots keyed by cell indexes are outdated.
+  cell_snapshot_cache_.Clear();
+  should_update_layout_ = true;
+  if (data_source_ == nullptr || section_layouts_.empty()) {
+    RefreshLayout();
+    return;
+  }
+
+  // Records the positions on screen of the visible cells before updates.
+  const float kContentViewOffset = GetContentViewOffset().y;
+  std::vector<DisplacedCell> surviving_cells;
+  surviving_cells.reserve(visible_cells_.size());
+  for (TableViewCell* cell : visible_cells_) {
+    surviving_cells.push_back({cell, {cell->section_index_, cell->row_index_},
+                               cell->GetY() - kContentViewOffset});
+  }
+
+  UpdateSectionLayouts();
+  if (kContentViewOffset > 0 && !surviving_cells.empty()) {
+    const DisplacedCell& kAnchor = surviving_cells.front();
+    float row_offset = 0;
+    float row_height = 0;
+    if (GetRowBounds(kAnchor.cell_index, &row_offset, &row_height)) {
+      const float kMaximumContentViewOffset = \
+          std::max(0.0f, GetContentViewSize().height - GetHeight());
+      const float kNewContentViewOffset = std::min(
+          kMaximumContentViewOffset,
+          std::max(0.0f, row_offset - kAnchor.displacement));
+      TranslateContentView({0, kContentViewOffset - kNewContentViewOffset});
     }
-    ++vector_index;
   }
-  return nullptr;
+
+  displaced_cells_.clear();
+  if (!UpdateLayout() || !animating)
+    return;
+
+  // Slides the surviving cells from their previous positions on screen.
+  const float kNewContentViewOffset = GetContentViewOffset().y;
+  for (DisplacedCell& displaced_cell : surviving_cells) {
+    TableViewCell* cell = displaced_cell.cell;
+    if (cell->section_index_ != displaced_cell.cell_index.section_index ||
+        cell->row_index_ != displaced_cell.cell_index.row_index) {
+      continue;
+    }
+    displaced_cell.displacement -= cell->GetY() - kNewContentViewOffset;
+    if (displaced_cell.displacement != 0)
+      displaced_cells_.push_back(displaced_cell);
+  }
+  if (displaced_cells_.empty())
+    return;
+  update_animation_timestamp_ = Clock::GetTimestamp();
+  if (!layout_view_->IsAnimating())
+    layout_view_->StartAnimation();
+  should_update_layout_ = true;
+  UpdateLayout();
+}
+
+TableViewCell* TableView::GetCell(const CellIndex cell_index) const {
+  if (cell_index.section_index < 0 || cell_index.row_index < 0)
+    return nullptr;
+
+  auto match = visible_cells_by_index_.find(
+      GetCellIndexKey(cell_index.section_index, cell_index.row_index));
+  if (match == visible_cells_by_index_.end())
+    return nullptr;
+  return match->second;
 }
 
+// The cell keeps the index of the row it displays, which is then verified
+// against `visible_cells_by_index_` in case the cell belongs to another table
+// view.
 TableView::CellIndex TableView::GetCellIndex(TableViewCell* cell) const {
-  int vector_index = 0;
-  for (TableViewCell* visible_cell : visible_cells_) {
-    if (visible_cell == cell)
-      return cell_indexes_for_visible_rows_[vector_index];
-    ++vector_index;
+  if (cell == nullptr)
+    return {-1, -1};
+
+  const CellIndex kCellIndex = {cell->section_index_, cell->row_index_};
+  if (GetCell(kCellIndex) != cell)
+    return {-1, -1};
+  return kCellIndex;
+}
+
+TableView::CellIndex TableView::GetCellIndexAtOffset(const float offset) {
+  UpdateSectionLayouts();
+  const int kRowNumber = GetRowNumberAtOffset(offset);
+  if (kRowNumber < 0)
+    return {-1, -1};
+
+  // Finds the last section whose first row number is not greater than the
+  // row number, which is the non-empty section containing the row.
+  auto section = std::upper_bound(
+      section_layouts_.begin(), section_layouts_.end(), kRowNumber,
+      [](const int row_number, const SectionLayout& layout) {
+        return row_number < layout.row_number_offset;
+      }) - 1;
+  return {static_cast<int>(section - section_layouts_.begin()),
+          kRowNumber - section->row_number_offset};
+}
+
+std::vector<TableView::CellIndex>
+TableView::GetCellIndexesForSelectedRows() const {
+  std::vector<CellIndex> cell_indexes;
+  cell_indexes.reserve(selected_rows_.GetCount());
+  for (const CellIndex cell_index : selected_rows_)
+    cell_indexes.push_back(cell_index);
+  return cell_indexes;
+}
+
+bool TableView::GetRowBounds(const CellIndex cell_index, float* offset,
+                             float* height) const {
+  if (cell_index.section_index < 0 || cell_index.row_index < 0 ||
+      cell_index.section_index >= static_cast<int>(section_layouts_.size())) {
+    return false;
   }
-  return {-1, -1};
+  const SectionLayout& kLayout = section_layouts_[cell_index.section_index];
+  if (cell_index.row_index >= kLayout.first_invalid_row)
+    return false;
+  *offset = kLayout.row_offset + kLayout.row_offsets[cell_index.row_index];
+  *height = kLayout.row_heights[cell_index.row_index];
+  return true;
 }
 
 float TableView::GetRowHeight(const CellIndex cell_index) {
@@ -164,16 +781,58 @@ float TableView::GetRowHeight(const CellIndex cell_index) {
   }
   if (row_height == TableView::kAutomaticDimenstion)
     row_height = row_height_;
-  if (row_height == TableView::kAutomaticDimenstion)
+  if (row_height == TableView::kAutomaticDimenstion &&
+      estimated_row_height_ <= 0) {
     row_height = kDefaultRowHeight;
+  }
   return row_height;
 }
 
+int TableView::GetRowNumberAtOffset(const float offset) const {
+  auto section = std::upper_bound(
+      section_layouts_.begin(), section_layouts_.end(), offset,
+      [](const float offset, const SectionLayout& layout) {
+        return offset < layout.row_offset;
+      });
+  while (section != section_layouts_.begin()) {
+    --section;
+    const int kNumberOfRows = static_cast<int>(section->row_heights.size());
+    if (kNumberOfRows == 0)
+      continue;
+    const int kRowIndex = static_cast<int>(
+        std::upper_bound(section->row_offsets.begin(),
+                         section->row_offsets.begin() + kNumberOfRows,
+                         offset - section->row_offset)
+        - section->row_offsets.begin()) - 1;
+    return section->row_number_offset + std::max(0, kRowIndex);
+  }
+  if (section_layouts_.empty() ||
+      section_layouts_.back().row_number_offset +
+          section_layouts_.back().row_heights.size() == 0) {
+    return -1;
+  }
+  return 0;
+}
+
 bool TableView::HandleEvent(Event* event) {
   const bool kResult = ScrollView::HandleEvent(event);
   if (down_event_cell_ == nullptr)
     return kResult;
 
+  // Placeholders and snapshots turn into live cells once touched down. This
+  // is not done in `ShouldHandleEvent()` since platforms also call it for
+  // hit testing alone.
+  if (event->type() == Event::Type::kDown) {
+    const int kHandle = down_event_cell_->reuse_identifier_handle();
+    auto match = std::find(visible_cells_.begin(), visible_cells_.end(),
+                           down_event_cell_);
+    if ((kHandle == placeholder_cell_handle_ ||
+         kHandle == snapshot_cell_handle_) && match != visible_cells_.end()) {
+      down_event_cell_ = MaterializeVisibleCell(
+          static_cast<int>(match - visible_cells_.begin()));
+    }
+  }
+
   // Determines the cell's current origin related to the corresponded
   // widget view's coordinate system.
   Point origin;
@@ -182,7 +841,8 @@ bool TableView::HandleEvent(Event* event) {
   if (event->type() == Event::Type::kDown) {
     down_event_origin_ = origin;
     // Delay highlights the `down_event_cell_`.
-    Clock::ExecuteCallbackOnMainThread(
+    Clock::CancelCallback(highlight_callback_handle_);
+    highlight_callback_handle_ = Clock::ExecuteCallbackOnMainThread(
         0.01,  // delay in seconds
         std::bind(&TableView::HighlightDownEventCell, this));
   } else if (event->type() == Event::Type::kUp) {
@@ -206,43 +866,411 @@ bool TableView::HandleEvent(Event* event) {
   return kResult;
 }
 
+void TableView::HandleMemoryWarning(NVGcontext* context) {
+  ScrollView::HandleMemoryWarning(context);
+  reusable_cell_pool_.ReleaseCells();
+  nvgDeleteFramebuffer(pinned_section_header_framebuffer_);
+  pinned_section_header_framebuffer_ = nullptr;
+  cell_snapshot_cache_.Clear();
+  should_update_layout_ = true;
+}
+
 void TableView::HighlightDownEventCell() {
+  highlight_callback_handle_ = 0;
   if (down_event_cell_ == nullptr)
     return;
   SetCellHighlighted(down_event_cell_, true);
 }
 
+void TableView::InsertRows(const int section_index, const int row_index,
+                           const int number_of_rows) {
+  if (section_index < 0 || row_index < 0 || number_of_rows <= 0)
+    return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  if (section_index < static_cast<int>(section_layouts_.size())) {
+    SectionLayout* layout = &section_layouts_[section_index];
+    if (row_index <= static_cast<int>(layout->row_heights.size())) {
+      layout->row_heights.insert(layout->row_heights.begin() + row_index,
+                                 number_of_rows, -1);
+      layout->estimated_rows.insert(
+          layout->estimated_rows.begin() + row_index, number_of_rows, false);
+      layout->first_invalid_row = std::min(layout->first_invalid_row,
+                                           row_index);
+    }
+  }
+  selected_rows_.ShiftRows(section_index, row_index, number_of_rows);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index != section_index ||
+        cell_index.row_index < row_index) {
+      return cell_index;
+    }
+    return {section_index, cell_index.row_index + number_of_rows};
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::InsertSections(const int section_index,
+                               const int number_of_sections) {
+  if (section_index < 0 || number_of_sections <= 0)
+    return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  if (section_index <= static_cast<int>(section_layouts_.size())) {
+    section_layouts_.insert(section_layouts_.begin() + section_index,
+                            number_of_sections, SectionLayout());
+  }
+  selected_rows_.ShiftSections(section_index, number_of_sections);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index < section_index)
+      return cell_index;
+    return {cell_index.section_index + number_of_sections,
+            cell_index.row_index};
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::InsertVisibleCell(const int position,
+                                  const CellIndex cell_index,
+                                  TableViewCell* cell) {
+  cell->section_index_ = cell_index.section_index;
+  cell->row_index_ = cell_index.row_index;
+  visible_cells_.insert(visible_cells_.begin() + position, cell);
+  cell_indexes_for_visible_rows_.insert(
+      cell_indexes_for_visible_rows_.begin() + position, cell_index);
+  visible_cells_by_index_[GetCellIndexKey(cell_index.section_index,
+                                          cell_index.row_index)] = cell;
+}
+
+TableViewCell* TableView::MaterializeVisibleCell(const int position) {
+  TableViewCell* visible_cell = visible_cells_[position];
+  const CellIndex kCellIndex = cell_indexes_for_visible_rows_[position];
+  const float kX = visible_cell->GetX();
+  const float kY = visible_cell->GetY();
+  const float kWidth = visible_cell->GetWidth();
+  const float kHeight = visible_cell->GetHeight();
+  ReuseVisibleCells(position, position + 1);
+
+  TableViewCell* cell = data_source_->GetTableViewCell(
+      this, kCellIndex.section_index, kCellIndex.row_index);
+  InsertVisibleCell(position, kCellIndex, cell);
+  cell->set_selected(selected_rows_.Contains(kCellIndex));
+  AddChild(cell);
+  SendChildToBack(cell);
+  cell->SetBounds(kX, kY, kWidth, kHeight);
+  should_capture_cell_snapshots_ = true;
+  return cell;
+}
+
+// The anchor is the topmost visible row that was already measured, since its
+// position is final. Rows above it that change their heights would push it
+// around, which is compensated by translating the content view.
+bool TableView::MeasureVisibleRows(NVGcontext* context) {
+  if (estimated_row_height_ <= 0 || update_level_ > 0)
+    return false;
+
+  CellIndex anchor = {-1, -1};
+  for (const CellIndex cell_index : cell_indexes_for_visible_rows_) {
+    if (!section_layouts_[cell_index.section_index]
+            .estimated_rows[cell_index.row_index]) {
+      anchor = cell_index;
+      break;
+    }
+  }
+
+  bool did_measure = false;
+  float displacement = 0;  // the height difference of rows above the anchor
+  for (size_t position = 0; position < visible_cells_.size(); ++position) {
+    const CellIndex kCellIndex = cell_indexes_for_visible_rows_[position];
+    SectionLayout* layout = &section_layouts_[kCellIndex.section_index];
+    if (!layout->estimated_rows[kCellIndex.row_index])
+      continue;
+
+    // Placeholders keep the estimates until replaced after scrubbing.
+    TableViewCell* cell = visible_cells_[position];
+    if (cell->reuse_identifier_handle() == placeholder_cell_handle_)
+      continue;
+    const float kRowHeight = std::max(
+        0.0f, std::ceil(cell->GetFittingHeight(context, cell->GetWidth())));
+    float* row_height = &layout->row_heights[kCellIndex.row_index];
+    layout->estimated_rows[kCellIndex.row_index] = false;
+    did_measure = true;
+    if (kRowHeight == *row_height)
+      continue;
+    if (anchor.section_index >= 0 && CellIndexPrecedes(kCellIndex, anchor))
+      displacement += kRowHeight - *row_height;
+    *row_height = kRowHeight;
+    layout->first_invalid_row = std::min(layout->first_invalid_row,
+                                         kCellIndex.row_index);
+  }
+  if (!did_measure)
+    return false;
+
+  UpdateSectionLayouts();
+  if (displacement != 0) {
+    const float kContentViewOffset = GetContentViewOffset().y;
+    const float kNewContentViewOffset = std::max(
+        0.0f, kContentViewOffset + displacement);
+    TranslateContentView({0, kContentViewOffset - kNewContentViewOffset});
+  }
+  return true;
+}
+
+// The moved row is measured again at its new location and its visible cell,
+// if any, is requested from the data source again.
+void TableView::MoveRow(const CellIndex from_cell_index,
+                        const CellIndex to_cell_index) {
+  if (from_cell_index.section_index < 0 || from_cell_index.row_index < 0 ||
+      to_cell_index.section_index < 0 || to_cell_index.row_index < 0 ||
+      (from_cell_index.section_index == to_cell_index.section_index &&
+       from_cell_index.row_index == to_cell_index.row_index)) {
+    return;
+  }
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  const int kNumberOfSections = static_cast<int>(section_layouts_.size());
+  if (from_cell_index.section_index < kNumberOfSections &&
+      to_cell_index.section_index < kNumberOfSections) {
+    SectionLayout* from_layout = \
+        &section_layouts_[from_cell_index.section_index];
+    SectionLayout* to_layout = &section_layouts_[to_cell_index.section_index];
+    if (from_cell_index.row_index <
+            static_cast<int>(from_layout->row_heights.size()) &&
+        to_cell_index.row_index <
+            static_cast<int>(to_layout->row_heights.size()) +
+            (from_layout == to_layout ? 0 : 1)) {
+      from_layout->row_heights.erase(from_layout->row_heights.begin() +
+                                     from_cell_index.row_index);
+      from_layout->estimated_rows.erase(from_layout->estimated_rows.begin() +
+                                        from_cell_index.row_index);
+      from_layout->first_invalid_row = std::min(from_layout->first_invalid_row,
+                                                from_cell_index.row_index);
+      to_layout->row_heights.insert(
+          to_layout->row_heights.begin() + to_cell_index.row_index, -1);
+      to_layout->estimated_rows.insert(
+          to_layout->estimated_rows.begin() + to_cell_index.row_index, false);
+      to_layout->first_invalid_row = std::min(to_layout->first_invalid_row,
+                                              to_cell_index.row_index);
+    }
+  }
+  const bool kIsSelected = selected_rows_.Contains(from_cell_index);
+  selected_rows_.ShiftRows(from_cell_index.section_index,
+                           from_cell_index.row_index + 1, -1);
+  selected_rows_.ShiftRows(to_cell_index.section_index,
+                           to_cell_index.row_index, 1);
+  if (kIsSelected)
+    selected_rows_.Insert(to_cell_index);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index == from_cell_index.section_index &&
+        cell_index.row_index == from_cell_index.row_index) {
+      return {-1, -1};
+    }
+    CellIndex result = cell_index;
+    if (result.section_index == from_cell_index.section_index &&
+        result.row_index > from_cell_index.row_index) {
+      --result.row_index;
+    }
+    if (result.section_index == to_cell_index.section_index &&
+        result.row_index >= to_cell_index.row_index) {
+      ++result.row_index;
+    }
+    return result;
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::MoveSection(const int from_section_index,
+                            const int to_section_index) {
+  if (from_section_index < 0 || to_section_index < 0 ||
+      from_section_index == to_section_index) {
+    return;
+  }
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  const int kNumberOfSections = static_cast<int>(section_layouts_.size());
+  if (from_section_index < kNumberOfSections &&
+      to_section_index < kNumberOfSections) {
+    if (from_section_index < to_section_index) {
+      std::rotate(section_layouts_.begin() + from_section_index,
+                  section_layouts_.begin() + from_section_index + 1,
+                  section_layouts_.begin() + to_section_index + 1);
+    } else {
+      std::rotate(section_layouts_.begin() + to_section_index,
+                  section_layouts_.begin() + from_section_index,
+                  section_layouts_.begin() + from_section_index + 1);
+    }
+  }
+  selected_rows_.MoveSection(from_section_index, to_section_index);
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index == from_section_index)
+      return {-1, -1};
+    CellIndex result = cell_index;
+    if (result.section_index > from_section_index)
+      --result.section_index;
+    if (result.section_index >= to_section_index)
+      ++result.section_index;
+    return result;
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::NotifyPrefetchingRows(const int first_row_number,
+                                      const int last_row_number,
+                                      const bool cancels) {
+  if (first_row_number < 0 || first_row_number > last_row_number)
+    return;
+
+  auto section = std::upper_bound(
+      section_layouts_.begin(), section_layouts_.end(), first_row_number,
+      [](const int row_number, const SectionLayout& layout) {
+        return row_number < layout.row_number_offset;
+      });
+  if (section == section_layouts_.begin())
+    return;
+  int row_number = first_row_number;
+  for (--section;
+       section != section_layouts_.end() && row_number <= last_row_number;
+       ++section) {
+    const int kNumberOfRows = static_cast<int>(section->row_heights.size());
+    if (row_number >= section->row_number_offset + kNumberOfRows)
+      continue;
+    const int kSectionIndex = \
+        static_cast<int>(section - section_layouts_.begin());
+    const int kFirstRowIndex = row_number - section->row_number_offset;
+    const int kLastRowIndex = std::min(
+        kNumberOfRows - 1, last_row_number - section->row_number_offset);
+    if (cancels) {
+      prefetch_data_source_->TableViewCancelPrefetchingRows(
+          this, kSectionIndex, kFirstRowIndex, kLastRowIndex);
+      prefetching_statistics_.number_of_cancelled_rows += \
+          kLastRowIndex - kFirstRowIndex + 1;
+    } else {
+      prefetch_data_source_->TableViewPrefetchRows(
+          this, kSectionIndex, kFirstRowIndex, kLastRowIndex);
+      prefetching_statistics_.number_of_prefetched_rows += \
+          kLastRowIndex - kFirstRowIndex + 1;
+    }
+    row_number = section->row_number_offset + kLastRowIndex + 1;
+  }
+}
+
+void TableView::PrewarmReusableCells(const int reuse_identifier_handle,
+                                     const int number_of_cells) {
+  reusable_cell_pool_.PrewarmCells(reuse_identifier_handle, number_of_cells);
+}
+
+int TableView::RegisterReuseIdentifier(
+    const std::string& reuse_identifier,
+    std::function<TableViewCell*()> create_cell) {
+  return reusable_cell_pool_.RegisterReuseIdentifier(reuse_identifier,
+                                                     create_cell);
+}
+
+void TableView::RedrawPinnedSectionHeader() {
+  should_render_pinned_section_header_ = true;
+  pinned_section_header_view_->Redraw();
+}
+
 void TableView::ReloadData() {
+  CancelPrefetchingRows();
   down_event_cell_ = nullptr;
   for (TableViewCell* cell : visible_cells_) {
     cell->RemoveFromParent();
     ReuseCell(cell);
   }
   visible_cells_.clear();
+  visible_cells_by_index_.clear();
   cell_indexes_for_visible_rows_.clear();
-  cell_indexes_for_selected_rows_.clear();
+  selected_rows_.Clear();
+  section_layouts_.clear();
+  displaced_cells_.clear();
+  pinned_section_header_ = nullptr;
+  pending_scrubbing_offset_ = -1;
+  cell_snapshot_cache_.Clear();
   should_update_layout_ = true;
   SetContentViewOffset({0, 0});
   layout_view_->Redraw();
 }
 
 void TableView::RefreshLayout() {
+  CancelPrefetchingRows();
+  section_layouts_.clear();
+  cell_snapshot_cache_.Clear();
+  should_render_pinned_section_header_ = true;
   should_update_layout_ = true;
   layout_view_->Redraw();
   Redraw();
 }
 
-void TableView::ReuseCell(TableViewCell* cell) {
-  cell->RemoveFromParent();
-  const std::string kReuseIdentifier = cell->reuse_identifier();
-  if (kReuseIdentifier.empty()) {
-    moui::Widget::SmartRelease(cell);
+void TableView::ReloadRows(const int section_index, const int row_index,
+                           const int number_of_rows) {
+  if (section_index < 0 || row_index < 0 || number_of_rows <= 0)
+    return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  if (section_index < static_cast<int>(section_layouts_.size())) {
+    SectionLayout* layout = &section_layouts_[section_index];
+    const int kNumberOfRows = static_cast<int>(layout->row_heights.size());
+    if (row_index < kNumberOfRows) {
+      std::fill(layout->row_heights.begin() + row_index,
+                layout->row_heights.begin() + std::min(
+                    kNumberOfRows, row_index + number_of_rows),
+                -1);
+      layout->first_invalid_row = std::min(layout->first_invalid_row,
+                                           row_index);
+    }
+  }
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index == section_index &&
+        cell_index.row_index >= row_index &&
+        cell_index.row_index < row_index + number_of_rows) {
+      return {-1, -1};
+    }
+    return cell_index;
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
+
+void TableView::ReloadSections(const int section_index,
+                               const int number_of_sections) {
+  if (section_index < 0 || number_of_sections <= 0)
     return;
+
+  const bool kIsImplicit = BeginImplicitUpdates();
+  const int kLastSectionIndex = section_index + number_of_sections - 1;
+  for (int index = section_index;
+       index <= kLastSectionIndex &&
+           index < static_cast<int>(section_layouts_.size());
+       ++index) {
+    section_layouts_[index] = SectionLayout();
   }
+  for (int index = section_index; index <= kLastSectionIndex; ++index)
+    selected_rows_.RemoveRange(index, 0, INT_MAX);
+  should_render_pinned_section_header_ = true;
+  UpdateVisibleCellIndexes([=](const CellIndex cell_index) -> CellIndex {
+    if (cell_index.section_index >= section_index &&
+        cell_index.section_index <= kLastSectionIndex) {
+      return {-1, -1};
+    }
+    return cell_index;
+  });
+  if (kIsImplicit)
+    EndUpdates(false);
+}
 
-  std::queue<TableViewCell*>* reusable_cells = \
-      &(reusable_cells_[kReuseIdentifier]);
-  reusable_cells->push(cell);
+void TableView::ResetPrefetchingStatistics() {
+  prefetching_statistics_ = {0, 0, 0, 0, 0};
+}
+
+void TableView::ReuseCell(TableViewCell* cell) {
+  cell->section_index_ = -1;
+  cell->row_index_ = -1;
+  reusable_cell_pool_.ReuseCell(cell);
 }
 
 void TableView::ReuseVisibleCells(const int begin, const int last) {
@@ -253,6 +1281,8 @@ void TableView::ReuseVisibleCells(const int begin, const int last) {
        iterator < visible_cells_.begin() + last;
        ++iterator) {
     auto cell = reinterpret_cast<TableViewCell*>(*iterator);
+    visible_cells_by_index_.erase(
+        GetCellIndexKey(cell->section_index_, cell->row_index_));
     ReuseCell(cell);
   }
   visible_cells_.erase(visible_cells_.begin() + begin,
@@ -262,8 +1292,27 @@ void TableView::ReuseVisibleCells(const int begin, const int last) {
       cell_indexes_for_visible_rows_.begin() + last);
 }
 
+void TableView::RenderCellSnapshot(moui::Widget* widget,
+                                   NVGcontext* context) {
+  auto cell = reinterpret_cast<TableViewCell*>(widget);
+  NVGframebuffer* framebuffer = cell_snapshot_cache_.GetSnapshot(
+      GetCellIndexKey(cell->section_index_, cell->row_index_), nullptr);
+  if (framebuffer == nullptr)
+    return;
+
+  const float kWidth = cell->GetWidth();
+  const float kHeight = cell->GetHeight();
+  nvgBeginPath(context);
+  nvgRect(context, 0, 0, kWidth, kHeight);
+  nvgFillPaint(context, nvgImagePattern(context, 0, 0, kWidth, kHeight, 0,
+                                        framebuffer->image, 1));
+  nvgFill(context);
+}
+
+// All separators are added to a single path and filled at once, so the
+// cost of rendering does not grow with the number of draw calls.
 void TableView::RenderLayoutView(moui::Widget* widget, NVGcontext* context) {
-  if (data_source_ == nullptr)
+  if (data_source_ == nullptr || cell_indexes_for_visible_rows_.empty())
     return;
 
   const Point kContentViewOffset = GetContentViewOffset();
@@ -279,6 +1328,9 @@ void TableView::RenderLayoutView(moui::Widget* widget, NVGcontext* context) {
     if (cell_index.section_index != current_section) {
       current_section = cell_index.section_index;
       last_row_of_the_current_section = \
+          current_section < static_cast<int>(section_layouts_.size()) ?
+          static_cast<int>(
+              section_layouts_[current_section].row_heights.size()) - 1 :
           data_source_->GetNumberOfRowsInSection(this, current_section) - 1;
     }
 
@@ -310,6 +1362,59 @@ void TableView::RenderLayoutView(moui::Widget* widget, NVGcontext* context) {
   nvgFill(context);
 }
 
+// The pinned section header is rendered again only when a different header
+// gets pinned, when its size changes or on request, so scrolling merely moves
+// the cached rendering.
+void TableView::RenderFramebuffer(NVGcontext* context) {
+  if (should_capture_cell_snapshots_)
+    CaptureCellSnapshots();
+  if (pinned_section_header_ == nullptr)
+    return;
+
+  if (pinned_section_header_framebuffer_ != nullptr &&
+      !should_render_pinned_section_header_) {
+    const float kScaleFactor = \
+        pinned_section_header_->GetRasterScaleFactor();
+    int framebuffer_width = 0;
+    int framebuffer_height = 0;
+    nvgImageSize(pinned_section_header_framebuffer_->ctx,
+                 pinned_section_header_framebuffer_->image,
+                 &framebuffer_width, &framebuffer_height);
+    if (framebuffer_width == static_cast<int>(
+            pinned_section_header_->GetWidth() * kScaleFactor) &&
+        framebuffer_height == static_cast<int>(
+            pinned_section_header_->GetHeight() * kScaleFactor) &&
+        !pinned_section_header_->ShouldRasterizeAgain(
+            pinned_section_header_framebuffer_scale_factor_)) {
+      return;
+    }
+  }
+  should_render_pinned_section_header_ = false;
+  pinned_section_header_framebuffer_scale_factor_ = \
+      pinned_section_header_->GetRasterScaleFactor();
+  pinned_section_header_->RenderToFramebuffer(
+      &pinned_section_header_framebuffer_);
+}
+
+void TableView::RenderPinnedSectionHeaderView(moui::Widget* widget,
+                                              NVGcontext* context) {
+  if (pinned_section_header_ == nullptr ||
+      pinned_section_header_framebuffer_ == nullptr) {
+    return;
+  }
+
+  const float kX = pinned_section_header_->GetX();
+  const float kWidth = pinned_section_header_->GetWidth();
+  const float kHeight = pinned_section_header_->GetHeight();
+  nvgBeginPath(context);
+  nvgRect(context, kX, pinned_section_header_offset_, kWidth, kHeight);
+  nvgFillPaint(context,
+               nvgImagePattern(context, kX, pinned_section_header_offset_,
+                               kWidth, kHeight, 0,
+                               pinned_section_header_framebuffer_->image, 1));
+  nvgFill(context);
+}
+
 void TableView::ScrollToCellIndex(const CellIndex cell_index,
                                   const ScrollPosition scroll_position,
                                   const bool animating) {
@@ -317,70 +1422,11 @@ void TableView::ScrollToCellIndex(const CellIndex cell_index,
     return;
 
   // Determines the offset and height of the cell of interest.
+  UpdateSectionLayouts();
   const float kContentViewOffset = GetContentViewOffset().y;
   float cell_offset = -1;
   float cell_height = -1;
-
-  TableViewCell* cell = GetCell(cell_index);
-  if (cell != nullptr) {
-    cell_offset = cell->GetY();
-    cell_height = cell->GetHeight();
-  } else {
-    float content_view_offset = -1;
-    bool finished = false;
-
-    // Table header view.
-    if (table_header_view_ != nullptr) {
-      content_view_offset = table_header_view_->GetHeight();
-    }
-
-    const int kNumberOfSections = data_source_->GetNumberOfSections(this);
-    for (int section_index = 0;
-         section_index < kNumberOfSections;
-         ++section_index) {
-      const int kNumberOfRows = data_source_->GetNumberOfRowsInSection(
-          this, section_index);
-      if (kNumberOfRows == 0) {
-        cell_height = 0;
-        cell_offset = std::max(0.0f, content_view_offset);
-        break;
-      }
-      if (section_index > 0) {
-        content_view_offset += height_between_sections_;
-      }
-
-      // Section header.
-      if (delegate_ != nullptr) {
-        const float kHeaderHeight = delegate_->GetTableViewSectionHeaderHeight(
-            this, section_index);
-        content_view_offset = content_view_offset < 0 ?
-                              kHeaderHeight :
-                              content_view_offset + kHeaderHeight;
-      }
-
-      // Rows.
-      for (int row_index = 0; row_index < kNumberOfRows; ++row_index) {
-        cell_offset = content_view_offset <= 0 ? 0 : content_view_offset - 1;
-        cell_height = GetRowHeight({section_index, row_index});
-        if (section_index == cell_index.section_index &&
-            row_index == cell_index.row_index) {
-          finished = true;
-          break;
-        }
-        content_view_offset = cell_offset + cell_height;
-      }
-      if (finished)
-        break;
-
-      // Section footer.
-      if (delegate_ != nullptr) {
-        const float kFooterHeight = delegate_->GetTableViewSectionFooterHeight(
-            this, section_index);
-        content_view_offset += kFooterHeight;
-      }
-    }
-  }
-  if (cell_offset < 0 || cell_height < 0)
+  if (!GetRowBounds(cell_index, &cell_offset, &cell_height))
     return;
 
   const float kCellBottomOffset = cell_offset + cell_height - 1;
@@ -419,6 +1465,38 @@ void TableView::ScrollToCellIndex(const CellIndex cell_index,
     SetContentViewOffset({0, new_content_view_offset});
 }
 
+void TableView::ScrubToCellIndex(const CellIndex cell_index) {
+  if (!ValidateCellIndex(cell_index))
+    return;
+
+  UpdateSectionLayouts();
+  float cell_offset = -1;
+  float cell_height = -1;
+  if (!GetRowBounds(cell_index, &cell_offset, &cell_height))
+    return;
+
+  is_scrubbing_ = true;
+  pending_scrubbing_offset_ = std::max(
+      0.0f,
+      std::min(cell_offset, GetContentViewSize().height - GetHeight()));
+  if (widget_view() != nullptr)
+    widget_view()->Redraw();
+}
+
+void TableView::SelectAllRows() {
+  if (data_source_ == nullptr)
+    return;
+
+  const int kNumberOfSections = data_source_->GetNumberOfSections(this);
+  for (int section_index = 0;
+       section_index < kNumberOfSections;
+       ++section_index) {
+    const int kNumberOfRows = data_source_->GetNumberOfRowsInSection(
+        this, section_index);
+    SelectRows(section_index, 0, kNumberOfRows - 1);
+  }
+}
+
 void TableView::SelectRow(const CellIndex cell_index) {
   if (cell_index.section_index < 0 || cell_index.row_index < 0) {
     return;
@@ -429,22 +1507,6 @@ void TableView::SelectRow(const CellIndex cell_index) {
     return;
   }
 
-  int position = 0;
-  for (auto iterator = cell_indexes_for_selected_rows_.begin();
-       iterator != cell_indexes_for_selected_rows_.end();
-       ++iterator) {
-    const CellIndex kCachedCellIndex = static_cast<CellIndex>(*iterator);
-    if (kCachedCellIndex.section_index < cell_index.section_index ||
-        (kCachedCellIndex.section_index == cell_index.section_index &&
-         kCachedCellIndex.row_index < cell_index.row_index)) {
-      ++position;
-    } else if (kCachedCellIndex.section_index > cell_index.section_index ||
-               (cell_index.section_index == kCachedCellIndex.section_index &&
-                cell_index.row_index == kCachedCellIndex.row_index)) {
-      break;
-    }
-  }  // end of `cell_indexes_for_selected_rows_` iterator.
-
   // Updates the states of the corresponded cell.
   TableViewCell* cell = GetCell(cell_index);
   if (cell != nullptr) {
@@ -452,13 +1514,31 @@ void TableView::SelectRow(const CellIndex cell_index) {
     BringChildToFront(cell);
   }
 
-  // Inserts the cell index to `cell_indexes_for_selected_rows_`.
-  cell_indexes_for_selected_rows_.insert(
-      cell_indexes_for_selected_rows_.begin() + position, cell_index);
+  selected_rows_.Insert(cell_index);
   if (delegate_ != nullptr)
     delegate_->TableViewDidSelectRow(this, cell_index);
 }
 
+void TableView::SelectRows(const int section_index, const int first_row_index,
+                           const int last_row_index) {
+  if (delegate_ == nullptr) {
+    selected_rows_.InsertRange(section_index, std::max(0, first_row_index),
+                               last_row_index);
+  } else {
+    for (int row_index = std::max(0, first_row_index);
+         row_index <= last_row_index;
+         ++row_index) {
+      const CellIndex kCellIndex = {section_index, row_index};
+      if (!selected_rows_.Contains(kCellIndex) &&
+          delegate_->TableViewShouldSelectRow(this, kCellIndex)) {
+        selected_rows_.Insert(kCellIndex);
+        delegate_->TableViewDidSelectRow(this, kCellIndex);
+      }
+    }
+  }
+  UpdateSelectedStateOfVisibleCells();
+}
+
 void TableView::SetCellHighlighted(TableViewCell* cell,
                                    const bool highlighted) {
   if (cell->highlighted() == highlighted)
@@ -486,10 +1566,20 @@ void TableView::SetCellHighlighted(TableViewCell* cell,
   }
 }
 
+void TableView::SetReusableCellCapacity(const int reuse_identifier_handle,
+                                        const int capacity) {
+  reusable_cell_pool_.SetCapacity(reuse_identifier_handle, capacity);
+}
+
 bool TableView::ShouldHandleEvent(const Point location) {
   if (!ScrollView::ShouldHandleEvent(location))
     return false;
 
+  // Touches on the index bar are not meant for the rows under it.
+  if (index_bar_ != nullptr && !index_bar_->IsHidden() &&
+      index_bar_->CollidePoint(location, 0)) {
+    return true;
+  }
   for (TableViewCell* cell : visible_cells_) {
     if (cell->CollidePoint(location, 0))
       down_event_cell_ = cell;
@@ -497,9 +1587,27 @@ bool TableView::ShouldHandleEvent(const Point location) {
   return true;
 }
 
+bool TableView::ShouldReplaceVisibleCell(TableViewCell* cell,
+                                         const Size size) const {
+  const int kHandle = cell->reuse_identifier_handle();
+  if (kHandle == placeholder_cell_handle_)
+    return !is_scrubbing_;
+  if (kHandle != snapshot_cell_handle_)
+    return false;
+
+  Size snapshot_size;
+  if (cell_snapshot_cache_.GetSnapshot(
+          GetCellIndexKey(cell->section_index_, cell->row_index_),
+          &snapshot_size) == nullptr) {
+    return true;
+  }
+  return snapshot_size.width != size.width ||
+         snapshot_size.height != size.height;
+}
+
 bool TableView::UpdateLayout() {
   if (data_source_ == nullptr || IsHidden() || widget_view() == nullptr ||
-      (GetWidth() == 0 && GetHeight() == 0)) {
+      (GetWidth() == 0 && GetHeight() == 0) || update_level_ > 0) {
     return false;
   }
 
@@ -514,166 +1622,407 @@ bool TableView::UpdateLayout() {
     return false;
   }
   should_update_layout_ = false;
+
+  // Measures the scrolling velocity for prefetching.
+  const double kTimestamp = Clock::GetTimestamp();
+  if (last_layout_timestamp_ >= 0 && kTimestamp > last_layout_timestamp_) {
+    const float kVelocity = \
+        (kTopmostContentViewOffset - last_topmost_content_view_offset_) /
+        (kTimestamp - last_layout_timestamp_);
+    scroll_velocity_ = (scroll_velocity_ + kVelocity) / 2;
+  }
+  last_layout_timestamp_ = kTimestamp;
   last_topmost_content_view_offset_ = kTopmostContentViewOffset;
   last_bottommost_content_view_offset_ = kBottommostContentViewOffset;
 
-  float content_view_offset = -1;
-  int index_of_visible_cells = -1;
-  bool previous_cell_is_visible = false;
-  bool done_processing_visible_cells = false;
+  UpdateSectionLayouts();
   const float kLeftPadding = left_padding();
   const float kTableWidth = GetWidth() - kLeftPadding - right_padding();
 
+  // Determines the remaining fraction of the displacement of sliding cells.
+  float displacement_ratio = 0;
+  if (!displaced_cells_.empty()) {
+    const double kProgress = \
+        (Clock::GetTimestamp() - update_animation_timestamp_) /
+        kUpdateAnimationDuration;
+    if (kProgress >= 1)
+      displaced_cells_.clear();
+    else
+      displacement_ratio = std::pow(1 - kProgress, 3);  // ease out
+  }
+  if (displaced_cells_.empty() && layout_view_->IsAnimating())
+    layout_view_->StopAnimation(true);
+
   // Table header view.
   if (table_header_view_ != nullptr) {
     table_header_view_->SetX(kLeftPadding);
     table_header_view_->SetY(0);
     table_header_view_->SetWidth(kTableWidth);
     AddChild(table_header_view_);
-    content_view_offset = table_header_view_->GetHeight();
   }
 
-  const int kNumberOfSections = data_source_->GetNumberOfSections(this);
+  const int kNumberOfSections = static_cast<int>(section_layouts_.size());
+  int position = 0;  // the position in `visible_cells_`
+  moui::Widget* pinned_section_header = nullptr;
+  float pinned_section_header_offset = 0;
   for (int section_index = 0;
        section_index < kNumberOfSections;
        ++section_index) {
-    const int kNumberOfRows = data_source_->GetNumberOfRowsInSection(
-        this, section_index);
+    const SectionLayout& kLayout = section_layouts_[section_index];
+    const int kNumberOfRows = static_cast<int>(kLayout.row_heights.size());
     if (kNumberOfRows == 0) {
       continue;
     }
-    if (section_index > 0) {
-      content_view_offset += height_between_sections_;
-    }
 
-    // Section header.
+    // Section header and footer.
     if (delegate_ != nullptr) {
-      const float kHeaderHeight = delegate_->GetTableViewSectionHeaderHeight(
-          this, section_index);
       moui::Widget* header = delegate_->GetTableViewSectionHeader(
           this, section_index);
+      const float kHeaderHeight = \
+          delegate_->GetTableViewSectionHeaderHeight(this, section_index);
       if (header != nullptr) {
-        header->SetBounds(kLeftPadding, content_view_offset, kTableWidth,
+        header->SetBounds(kLeftPadding, kLayout.header_offset, kTableWidth,
                           kHeaderHeight);
         AddChild(header);
       }
-      content_view_offset = content_view_offset < 0 ?
-                            kHeaderHeight :
-                            content_view_offset + kHeaderHeight;
+      moui::Widget* footer = delegate_->GetTableViewSectionFooter(
+          this, section_index);
+      const float kFooterHeight = \
+          delegate_->GetTableViewSectionFooterHeight(this, section_index);
+      if (footer != nullptr) {
+        footer->SetBounds(kLeftPadding, kLayout.footer_offset, kTableWidth,
+                          kFooterHeight);
+        AddChild(footer);
+      }
+
+      // Pins the header of the section crossing the top of the table view,
+      // which is pushed up by the end of the section.
+      const float kSectionBottomOffset = kLayout.footer_offset + kFooterHeight;
+      if (pins_section_headers_ && header != nullptr &&
+          kLayout.header_offset < kTopmostContentViewOffset &&
+          kSectionBottomOffset > kTopmostContentViewOffset) {
+        pinned_section_header = header;
+        pinned_section_header_offset = std::min(
+            0.0f,
+            kSectionBottomOffset - kHeaderHeight - kTopmostContentViewOffset);
+      }
     }
 
-    // Rows.
-    for (int row_index = 0; row_index < kNumberOfRows; ++row_index) {
-      const float kRowHeight = GetRowHeight({section_index, row_index});
-      const float kCellTopOffset = content_view_offset <= 0 ?
-                                   0 : content_view_offset - 1;
-      const float kCellBottomOffset = kCellTopOffset + kRowHeight - 1;
-      content_view_offset = kCellTopOffset + kRowHeight;
-
-      if (done_processing_visible_cells)
-        continue;
+    // Skips the rows if none of them is visible.
+    if (kLayout.row_offset + kLayout.row_offsets[kNumberOfRows] <
+            kTopmostContentViewOffset ||
+        kLayout.row_offset >= kBottommostContentViewOffset) {
+      continue;
+    }
 
-      const bool kCellIsVisible = \
-          kCellBottomOffset >= kTopmostContentViewOffset &&
-          kBottommostContentViewOffset > kCellTopOffset;
+    // Rows. The first visible row is the first one whose bottom offset is
+    // not above the topmost content view offset.
+    const int kFirstVisibleRowIndex = static_cast<int>(
+        std::lower_bound(kLayout.row_offsets.begin() + 1,
+                         kLayout.row_offsets.end(),
+                         kTopmostContentViewOffset - kLayout.row_offset)
+        - kLayout.row_offsets.begin()) - 1;
+    for (int row_index = kFirstVisibleRowIndex;
+         row_index < kNumberOfRows;
+         ++row_index) {
+      const float kCellTopOffset = \
+          kLayout.row_offset + kLayout.row_offsets[row_index];
+      if (kCellTopOffset >= kBottommostContentViewOffset)
+        break;
 
-      // Skips if the both the current and previous cells are invisible.
-      if (!kCellIsVisible && !previous_cell_is_visible) {
-        continue;
+      // Reuses the cells of rows that are no longer visible ahead of the
+      // current row.
+      const CellIndex kCellIndex = {section_index, row_index};
+      int last_invisible_position = position;
+      while (last_invisible_position <
+                 static_cast<int>(cell_indexes_for_visible_rows_.size()) &&
+             CellIndexPrecedes(
+                 cell_indexes_for_visible_rows_[last_invisible_position],
+                 kCellIndex)) {
+        ++last_invisible_position;
       }
+      ReuseVisibleCells(position, last_invisible_position);
 
-      // Deals with the first visible cell. Removes all previous visible cells
-      // ahead of which.
-      if (kCellIsVisible && !previous_cell_is_visible) {
-        previous_cell_is_visible = kCellIsVisible;
-        int erase_last_index = 0;
-        for (CellIndex& cell_index : cell_indexes_for_visible_rows_) {
-          if (cell_index.section_index < section_index ||
-              (cell_index.section_index == section_index &&
-               cell_index.row_index < row_index)) {
-             ++erase_last_index;
-             continue;
-          }
-          break;
+      const Size kCellSize = {kTableWidth, kLayout.row_heights[row_index]};
+      TableViewCell* cell = nullptr;
+      if (position < static_cast<int>(visible_cells_.size()) &&
+          !CellIndexPrecedes(kCellIndex,
+                             cell_indexes_for_visible_rows_[position])) {
+        cell = visible_cells_[position];
+        if (ShouldReplaceVisibleCell(cell, kCellSize)) {
+          ReuseVisibleCells(position, position + 1);
+          cell = nullptr;
         }
-        ReuseVisibleCells(0, erase_last_index);
-      }  // end of dealing with the first visible cell.
-
-      ++index_of_visible_cells;
-      bool cell_was_visible = false;
-      if (index_of_visible_cells < cell_indexes_for_visible_rows_.size()) {
-        const CellIndex kCellIndex = \
-            cell_indexes_for_visible_rows_[index_of_visible_cells];
-        cell_was_visible = kCellIndex.section_index == section_index &&
-                           kCellIndex.row_index == row_index;
       }
-
-      TableViewCell* cell = nullptr;
-      if (cell_was_visible) {
-        cell = visible_cells_[index_of_visible_cells];
-      } else {
-        cell = data_source_->GetTableViewCell(this, section_index, row_index);
-        visible_cells_.insert(visible_cells_.begin() + index_of_visible_cells,
-                              cell);
-        cell_indexes_for_visible_rows_.insert(
-            cell_indexes_for_visible_rows_.begin() + index_of_visible_cells,
-            {section_index, row_index});
-
-        // Updates the selected state of the cell.
-        bool cell_is_selected = false;
-        for (CellIndex& cell_index : cell_indexes_for_selected_rows_) {
-          if (cell_index.section_index == section_index &&
-              cell_index.row_index == row_index) {
-             cell_is_selected = true;
-             break;
+      const bool kIsNewCell = cell == nullptr;
+      if (kIsNewCell)
+        cell = DequeueCellSnapshot(kCellIndex, kCellSize);
+      if (cell == nullptr && is_scrubbing_) {
+        // Rows only flashing past while scrubbing are not worth configuring.
+        cell = reusable_cell_pool_.DequeueCell(placeholder_cell_handle_);
+      } else if (cell == nullptr) {
+        // Records whether the row's prefetching was done in time.
+        if (prefetch_data_source_ != nullptr) {
+          const int kRowNumber = kLayout.row_number_offset + row_index;
+          ++prefetching_statistics_.number_of_displayed_rows;
+          if (kRowNumber < first_prefetching_row_number_ ||
+              kRowNumber > last_prefetching_row_number_) {
+            ++prefetching_statistics_.number_of_displayed_rows_not_prefetched;
+          } else if (!prefetch_data_source_->TableViewHasPrefetchedRow(
+                         this, kCellIndex)) {
+            ++prefetching_statistics_
+                .number_of_displayed_rows_pending_prefetching;
           }
         }
-        cell->set_selected(cell_is_selected);
+        cell = data_source_->GetTableViewCell(this, section_index, row_index);
+        cell->set_selected(selected_rows_.Contains(kCellIndex));
+        should_capture_cell_snapshots_ = true;
+      }
+      if (kIsNewCell) {
+        InsertVisibleCell(position, kCellIndex, cell);
         AddChild(cell);
       }
       if (cell->highlighted())
         BringChildToFront(cell);
       else
         SendChildToBack(cell);
-      cell->SetBounds(kLeftPadding, kCellTopOffset, kTableWidth, kRowHeight);
 
-      if (kCellBottomOffset >= kBottommostContentViewOffset) {
-        ReuseVisibleCells(
-            index_of_visible_cells + 1,
-            static_cast<int>(cell_indexes_for_visible_rows_.size()));
-        done_processing_visible_cells = true;
+      float cell_top_offset = kCellTopOffset;
+      for (const DisplacedCell& displaced_cell : displaced_cells_) {
+        if (displaced_cell.cell == cell &&
+            displaced_cell.cell_index.section_index == section_index &&
+            displaced_cell.cell_index.row_index == row_index) {
+          cell_top_offset += displaced_cell.displacement * displacement_ratio;
+          break;
+        }
       }
+      cell->SetBounds(kLeftPadding, cell_top_offset, kTableWidth,
+                      kLayout.row_heights[row_index]);
+      ++position;
     }  // end of row
-
-    // Section footer.
-    if (delegate_ != nullptr) {
-      const float kFooterHeight = delegate_->GetTableViewSectionFooterHeight(
-          this, section_index);
-      moui::Widget* footer = delegate_->GetTableViewSectionFooter(
-          this, section_index);
-      if (footer != nullptr) {
-        footer->SetBounds(kLeftPadding, content_view_offset, kTableWidth,
-                          kFooterHeight);
-        AddChild(footer);
-      }
-      content_view_offset += kFooterHeight;
-    }
   }  // end of section
+  ReuseVisibleCells(position,
+                    static_cast<int>(cell_indexes_for_visible_rows_.size()));
+  if (pinned_section_header != pinned_section_header_) {
+    pinned_section_header_ = pinned_section_header;
+    should_render_pinned_section_header_ = true;
+  }
+  pinned_section_header_offset_ = pinned_section_header_offset;
 
   // Table footer view.
   if (table_footer_view_ != nullptr) {
     table_footer_view_->SetX(kLeftPadding);
-    table_footer_view_->SetY(content_view_offset);
+    table_footer_view_->SetY(table_footer_offset_);
     table_footer_view_->SetWidth(kTableWidth);
-    content_view_offset += table_footer_view_->GetHeight();
     AddChild(table_footer_view_);
   }
 
-  SetContentViewSize(-1, content_view_offset);
+  UpdatePrefetchingRows();
   layout_view_->Redraw();
   return true;
 }
 
+// The range covers at least one screen beyond the visible rows, extended to
+// the distance scrolled in `kPrefetchingLookaheadDuration` at the current
+// velocity. Rows leaving the range are cancelled unless they became visible.
+void TableView::UpdatePrefetchingRows() {
+  if (prefetch_data_source_ == nullptr)
+    return;
+  // Rows passed while scrubbing are unlikely to be displayed for long.
+  if (cell_indexes_for_visible_rows_.empty() || is_scrubbing_) {
+    CancelPrefetchingRows();
+    return;
+  }
+
+  const CellIndex& kFirstVisibleCellIndex = \
+      cell_indexes_for_visible_rows_.front();
+  const CellIndex& kLastVisibleCellIndex = \
+      cell_indexes_for_visible_rows_.back();
+  const int kFirstVisibleRowNumber = \
+      section_layouts_[kFirstVisibleCellIndex.section_index].row_number_offset
+      + kFirstVisibleCellIndex.row_index;
+  const int kLastVisibleRowNumber = \
+      section_layouts_[kLastVisibleCellIndex.section_index].row_number_offset
+      + kLastVisibleCellIndex.row_index;
+
+  // Determines the new range of prefetched rows.
+  const float kDistance = std::min(
+      kMaximumPrefetchingDistance * GetHeight(),
+      std::max(GetHeight(),
+               std::abs(scroll_velocity_) * kPrefetchingLookaheadDuration));
+  int first_row_number = -1;
+  int last_row_number = -1;
+  if (scroll_velocity_ >= 0) {
+    first_row_number = kLastVisibleRowNumber + 1;
+    last_row_number = GetRowNumberAtOffset(
+        last_bottommost_content_view_offset_ + kDistance);
+  } else {
+    first_row_number = GetRowNumberAtOffset(
+        last_topmost_content_view_offset_ - kDistance);
+    last_row_number = kFirstVisibleRowNumber - 1;
+  }
+  if (first_row_number > last_row_number) {
+    first_row_number = -1;
+    last_row_number = -1;
+  }
+
+  // Cancels the rows leaving the range except those that became visible.
+  auto cancel = [this, kFirstVisibleRowNumber, kLastVisibleRowNumber](
+      const int first_row_number, const int last_row_number) {
+    NotifyPrefetchingRows(
+        first_row_number,
+        std::min(last_row_number, kFirstVisibleRowNumber - 1), true);
+    NotifyPrefetchingRows(
+        std::max(first_row_number, kLastVisibleRowNumber + 1),
+        last_row_number, true);
+  };
+  if (first_row_number < 0) {
+    cancel(first_prefetching_row_number_, last_prefetching_row_number_);
+  } else if (first_prefetching_row_number_ >= 0) {
+    cancel(first_prefetching_row_number_,
+           std::min(last_prefetching_row_number_, first_row_number - 1));
+    cancel(std::max(first_prefetching_row_number_, last_row_number + 1),
+           last_prefetching_row_number_);
+  }
+
+  // Prefetches the rows entering the range.
+  if (first_prefetching_row_number_ < 0) {
+    NotifyPrefetchingRows(first_row_number, last_row_number, false);
+  } else if (first_row_number >= 0) {
+    NotifyPrefetchingRows(
+        first_row_number,
+        std::min(last_row_number, first_prefetching_row_number_ - 1), false);
+    NotifyPrefetchingRows(
+        std::max(first_row_number, last_prefetching_row_number_ + 1),
+        last_row_number, false);
+  }
+  first_prefetching_row_number_ = first_row_number;
+  last_prefetching_row_number_ = last_row_number;
+}
+
+void TableView::UpdateRowOffsets(const int section_index,
+                                 SectionLayout* layout) {
+  const int kNumberOfRows = static_cast<int>(layout->row_heights.size());
+  layout->row_offsets.resize(kNumberOfRows + 1);
+  layout->row_offsets[0] = 0;
+  for (int row_index = layout->first_invalid_row;
+       row_index < kNumberOfRows;
+       ++row_index) {
+    float* row_height = &layout->row_heights[row_index];
+    if (*row_height < 0) {
+      *row_height = GetRowHeight({section_index, row_index});
+      layout->estimated_rows[row_index] = \
+          *row_height == TableView::kAutomaticDimenstion;
+      if (layout->estimated_rows[row_index])
+        *row_height = estimated_row_height_;
+    }
+    layout->row_offsets[row_index + 1] = \
+        layout->row_offsets[row_index] + *row_height - 1;
+  }
+  layout->first_invalid_row = kNumberOfRows;
+}
+
+// Row heights are kept until invalidated, so this takes time proportional to
+// the number of sections plus the number of rows to measure. The heights of
+// section headers and footers are always asked again.
+void TableView::UpdateSectionLayouts() {
+  if (data_source_ == nullptr || update_level_ > 0)
+    return;
+
+  float content_view_offset = -1;
+  if (table_header_view_ != nullptr)
+    content_view_offset = table_header_view_->GetHeight();
+  int row_number_offset = 0;
+
+  const int kNumberOfSections = data_source_->GetNumberOfSections(this);
+  section_layouts_.resize(kNumberOfSections);
+  for (int section_index = 0;
+       section_index < kNumberOfSections;
+       ++section_index) {
+    SectionLayout* layout = &section_layouts_[section_index];
+    const int kNumberOfRows = data_source_->GetNumberOfRowsInSection(
+        this, section_index);
+    // Measures the section from scratch if the number of rows changed without
+    // going through the update methods.
+    if (kNumberOfRows != static_cast<int>(layout->row_heights.size())) {
+      layout->row_heights.assign(kNumberOfRows, -1);
+      layout->estimated_rows.assign(kNumberOfRows, false);
+      layout->first_invalid_row = 0;
+    }
+    layout->header_offset = content_view_offset;
+    layout->row_offset = content_view_offset;
+    layout->footer_offset = content_view_offset;
+    layout->row_number_offset = row_number_offset;
+    row_number_offset += kNumberOfRows;
+    if (kNumberOfRows == 0) {
+      continue;
+    }
+    UpdateRowOffsets(section_index, layout);
+    if (section_index > 0) {
+      content_view_offset += height_between_sections_;
+    }
+
+    // Section header.
+    layout->header_offset = content_view_offset;
+    if (delegate_ != nullptr) {
+      const float kHeaderHeight = delegate_->GetTableViewSectionHeaderHeight(
+          this, section_index);
+      content_view_offset = content_view_offset < 0 ?
+                            kHeaderHeight :
+                            content_view_offset + kHeaderHeight;
+    }
+
+    // Rows.
+    layout->row_offset = content_view_offset <= 0 ?
+                         0 : content_view_offset - 1;
+    content_view_offset = \
+        layout->row_offset + layout->row_offsets[kNumberOfRows] + 1;
+
+    // Section footer.
+    layout->footer_offset = content_view_offset;
+    if (delegate_ != nullptr) {
+      content_view_offset += delegate_->GetTableViewSectionFooterHeight(
+          this, section_index);
+    }
+  }
+
+  // Table footer view.
+  table_footer_offset_ = content_view_offset;
+  if (table_footer_view_ != nullptr)
+    content_view_offset += table_footer_view_->GetHeight();
+
+  SetContentViewSize(-1, content_view_offset);
+}
+
+void TableView::UpdateSelectedStateOfVisibleCells() {
+  int vector_index = 0;
+  for (const CellIndex cell_index : cell_indexes_for_visible_rows_) {
+    visible_cells_[vector_index]->set_selected(
+        selected_rows_.Contains(cell_index));
+    ++vector_index;
+  }
+}
+
+void TableView::UpdateVisibleCellIndexes(
+    std::function<CellIndex(const CellIndex cell_index)> adjust) {
+  std::vector<TableViewCell*> cells;
+  cells.swap(visible_cells_);
+  cell_indexes_for_visible_rows_.clear();
+  visible_cells_by_index_.clear();
+  for (TableViewCell* cell : cells) {
+    const CellIndex kCellIndex = adjust({cell->section_index_,
+                                         cell->row_index_});
+    if (kCellIndex.section_index >= 0) {
+      InsertVisibleCell(static_cast<int>(visible_cells_.size()), kCellIndex,
+                        cell);
+      continue;
+    }
+    if (cell == down_event_cell_)
+      down_event_cell_ = nullptr;
+    ReuseCell(cell);
+  }
+}
+
 bool TableView::ValidateCellIndex(const CellIndex cell_index) {
   if (data_source_ == nullptr) {
     return false;
@@ -691,14 +2040,40 @@ bool TableView::ValidateCellIndex(const CellIndex cell_index) {
 }
 
 bool TableView::WidgetViewWillRender(NVGcontext* context) {
+  // Applies the last scrubbing request since the previous frame.
+  if (pending_scrubbing_offset_ >= 0) {
+    if (IsAnimating())
+      StopAnimation();
+    SetContentViewOffset({GetContentViewOffset().x,
+                          pending_scrubbing_offset_});
+    pending_scrubbing_offset_ = -1;
+  }
+
   const bool kResult = ScrollView::WidgetViewWillRender(context);
   if (!kResult)
     return false;
 
+  if (!displaced_cells_.empty())
+    should_update_layout_ = true;
   UpdateLayout();
+  // Measuring rows may bring more rows into view, which are measured in the
+  // following passes.
+  for (int pass = 0;
+       pass < kMaximumMeasuringPasses && MeasureVisibleRows(context);
+       ++pass) {
+    should_update_layout_ = true;
+    UpdateLayout();
+  }
   return true;
 }
 
+void TableView::set_cell_snapshot_cache_capacity(const int capacity) {
+  cell_snapshot_cache_.set_capacity(capacity);
+  should_update_layout_ = true;
+  if (widget_view() != nullptr)
+    widget_view()->Redraw();
+}
+
 void TableView::set_data_source(TableViewDataSource* data_source) {
   if (data_source != data_source_) {
     data_source_ = data_source;
@@ -706,6 +2081,18 @@ void TableView::set_data_source(TableViewDataSource* data_source) {
   }
 }
 
+void TableView::set_estimated_row_height(const float estimated_row_height) {
+  if (estimated_row_height == estimated_row_height_) {
+    return;
+  }
+  CancelPrefetchingRows();
+  estimated_row_height_ = estimated_row_height;
+  section_layouts_.clear();
+  should_update_layout_ = true;
+  if (widget_view() != nullptr)
+    widget_view()->Redraw();
+}
+
 void TableView::set_height_between_sections(
     const float height_between_sections) {
   if (height_between_sections != height_between_sections_) {
@@ -714,11 +2101,53 @@ void TableView::set_height_between_sections(
   }
 }
 
+void TableView::set_index_bar(TableViewIndexBar* index_bar) {
+  if (index_bar == index_bar_)
+    return;
+
+  if (index_bar_ != nullptr) {
+    index_bar_->table_view_ = nullptr;
+    index_bar_->RemoveFromParent();
+    EndScrubbing();
+  }
+  index_bar_ = index_bar;
+  if (index_bar == nullptr)
+    return;
+
+  if (index_bar->table_view_ != nullptr)
+    index_bar->table_view_->set_index_bar(nullptr);
+  index_bar->table_view_ = this;
+  index_bar->SetX(Widget::Alignment::kRight, Widget::Unit::kPoint, 0);
+  index_bar->SetY(0);
+  index_bar->SetHeight(Widget::Unit::kPercent, 100);
+  Widget::InsertChildAboveSibling(index_bar, pinned_section_header_view_);
+}
+
+void TableView::set_pins_section_headers(const bool pins_section_headers) {
+  if (pins_section_headers != pins_section_headers_) {
+    pins_section_headers_ = pins_section_headers;
+    should_update_layout_ = true;
+    UpdateLayout();
+  }
+}
+
+void TableView::set_prefetch_data_source(
+    TableViewDataSourcePrefetching* prefetch_data_source) {
+  if (prefetch_data_source != prefetch_data_source_) {
+    CancelPrefetchingRows();
+    prefetch_data_source_ = prefetch_data_source;
+    should_update_layout_ = true;
+    UpdateLayout();
+  }
+}
+
 void TableView::set_row_height(const float row_height) {
   if (row_height == row_height_) {
     return;
   }
+  CancelPrefetchingRows();
   row_height_ = row_height;
+  section_layouts_.clear();
   should_update_layout_ = true;
   if (widget_view() != nullptr)
     widget_view()->Redraw();
@@ -19,13 +19,16 @@
 #define MOUI_WIDGETS_TABLE_VIEW_H_
 
 #include <cstdint>
-#include <map>
+#include <functional>
 #include <string>
-#include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include "moui/base.h"
+#include "moui/core/clock.h"
 #include "moui/nanovg_hook.h"
+#include "moui/widgets/cell_snapshot_cache.h"
+#include "moui/widgets/reusable_cell_pool.h"
 #include "moui/widgets/scroll_view.h"
 
 namespace moui {
@@ -33,7 +36,9 @@ namespace moui {
 // Forward declaration.
 class TableViewCell;
 class TableViewDataSource;
+class TableViewDataSourcePrefetching;
 class TableViewDelegate;
+class TableViewIndexBar;
 
 // The `TableView` widget is a means for displaying and editing hierachical
 // lists of information.
@@ -48,6 +53,114 @@ class TableView : public ScrollView {
     int row_index;
   };
 
+  // The `RowSelection` class keeps the selected rows of a table view as one
+  // bitset per section. Testing, adding and removing a single row takes
+  // constant time, and range operations touch one word per 64 rows.
+  class RowSelection {
+   public:
+    // Iterates selected rows in ascending order of section and row.
+    class Iterator {
+     public:
+      Iterator(const RowSelection* selection, const int section_index,
+               const int row_index);
+
+      CellIndex operator*() const { return {section_index_, row_index_}; }
+      Iterator& operator++();
+      bool operator!=(const Iterator& other) const {
+        return section_index_ != other.section_index_ ||
+               row_index_ != other.row_index_;
+      }
+
+     private:
+      // Moves the iterator to the first selected row at or after the
+      // specified location, or to the end if there is none.
+      void Seek(int section_index, int row_index);
+
+      // The weak reference to the iterated selection.
+      const RowSelection* selection_;
+
+      // The section index of the current row. -1 indicates the end.
+      int section_index_;
+
+      // The row index of the current row. -1 indicates the end.
+      int row_index_;
+    };
+
+    RowSelection();
+    ~RowSelection();
+
+    // Iterators for range-based for loops.
+    Iterator begin() const { return Iterator(this, 0, 0); }
+    Iterator end() const { return Iterator(this, -1, -1); }
+
+    // Removes all selected rows.
+    void Clear();
+
+    // Returns `true` if the specified row is selected.
+    bool Contains(const CellIndex cell_index) const;
+
+    // Returns the number of selected rows.
+    int GetCount() const { return count_; }
+
+    // Adds the specified row. Returns `false` if the row was already selected.
+    bool Insert(const CellIndex cell_index);
+
+    // Moves the selected rows of the section at `from_section_index` to
+    // `to_section_index`. Sections in between shift by one.
+    void MoveSection(const int from_section_index, const int to_section_index);
+
+    // Adds the rows from `first_row_index` to `last_row_index` inclusively in
+    // the specified section. Returns the number of newly selected rows.
+    int InsertRange(const int section_index, const int first_row_index,
+                    const int last_row_index);
+
+    // Removes the specified row. Returns `false` if the row was not selected.
+    bool Remove(const CellIndex cell_index);
+
+    // Removes the rows from `first_row_index` to `last_row_index` inclusively
+    // in the specified section. Returns the number of deselected rows.
+    int RemoveRange(const int section_index, const int first_row_index,
+                    const int last_row_index);
+
+    // Moves the rows at or after `row_index` in the specified section by
+    // `offset` rows. If `offset` is negative, the rows from
+    // `row_index + offset` to `row_index - 1` are dropped first.
+    void ShiftRows(const int section_index, const int row_index,
+                   const int offset);
+
+    // Moves the sections at or after `section_index` by `offset` sections.
+    // If `offset` is negative, the sections from `section_index + offset` to
+    // `section_index - 1` are dropped first.
+    void ShiftSections(const int section_index, const int offset);
+
+   private:
+    // The number of selected rows.
+    int count_;
+
+    // The bitsets of selected rows indexed by section. Each bitset grows on
+    // demand and bit `n` of word `w` represents row `w * 64 + n`.
+    std::vector<std::vector<uint64_t>> sections_;
+
+    DISALLOW_COPY_AND_ASSIGN(RowSelection);
+  };
+
+  // Counters describing how well prefetching keeps ahead of scrolling.
+  struct PrefetchingStatistics {
+    // The number of rows passed to the prefetching data source.
+    int number_of_prefetched_rows;
+    // The number of rows whose prefetching was cancelled.
+    int number_of_cancelled_rows;
+    // The number of rows that became visible while a prefetching data source
+    // was set.
+    int number_of_displayed_rows;
+    // The number of displayed rows that were never prefetched, which usually
+    // happens after jumping to another location.
+    int number_of_displayed_rows_not_prefetched;
+    // The number of displayed rows whose prefetching had not finished yet.
+    // Each of these likely blocked the main thread in `GetTableViewCell()`.
+    int number_of_displayed_rows_pending_prefetching;
+  };
+
   // The position in the table view (top, middle, bottom) to which a given row
   // is scrolled.
   enum class ScrollPosition {
@@ -68,53 +181,192 @@ class TableView : public ScrollView {
   TableView();
   ~TableView();
 
+  // Begins a series of method calls that insert, delete, reload or move rows
+  // and sections. Calls can be nested and each call must be balanced by a
+  // call to `EndUpdates()`. Indexes passed to each update are relative to
+  // the state left by the previous one, and the data source must reflect all
+  // of the changes by the time the outermost `EndUpdates()` is called.
+  void BeginUpdates();
+
+  // Deletes `number_of_rows` rows starting at `row_index` in the specified
+  // section.
+  void DeleteRows(const int section_index, const int row_index,
+                  const int number_of_rows);
+
+  // Deletes `number_of_sections` sections starting at `section_index`.
+  void DeleteSections(const int section_index, const int number_of_sections);
+
+  // Deselects all selected rows in the table view.
+  void DeselectAllRows();
+
   // Deselects a row in the table view identified by `cell_index`.
   void DeselectRow(const CellIndex cell_index);
 
-  // Returns a reusable table-view cell object located by its identifier.
-  TableViewCell* DequeueReusableCell(const std::string identifier);
+  // Deselects the rows from `first_row_index` to `last_row_index` inclusively
+  // in the specified section.
+  void DeselectRows(const int section_index, const int first_row_index,
+                    const int last_row_index);
+
+  // Returns a reusable table-view cell object located by its identifier
+  // handle in constant time. If no cell is reusable, a new cell is created by
+  // the function registered with `RegisterReuseIdentifier()`, or `nullptr`
+  // is returned if there is none.
+  TableViewCell* DequeueReusableCell(const int reuse_identifier_handle);
+
+  // Returns a reusable table-view cell object located by its identifier. This
+  // is a convenient wrapper of the handle version at the cost of interning
+  // the identifier.
+  TableViewCell* DequeueReusableCell(const std::string& reuse_identifier);
+
+  // Ends scrubbing started by `ScrubToCellIndex()`. The placeholders of
+  // visible rows are replaced by cells from the data source in the next
+  // refresh cycle.
+  void EndScrubbing();
+
+  // Concludes a series of updates started by `BeginUpdates()`. Only the rows
+  // affected by the updates are measured again and only the affected visible
+  // cells are requested from the data source. The topmost visible row stays
+  // at the same position on screen unless the table view is scrolled to the
+  // top. If `animating` is `true`, visible cells displaced by the updates
+  // slide to their new positions.
+  void EndUpdates(const bool animating);
 
   // Returns the cell object at the specified cell index, or `nullptr` if the
   // cell is not visible or `cell_index` is out of range.
   TableViewCell* GetCell(const CellIndex cell_index) const;
 
   // Returns a cell index representing the row and section of the given
-  // table-view cell. `nullptr` is returned if the cell index is invalid.
+  // table-view cell. `{-1, -1}` is returned if the cell is not visible in the
+  // table view.
   CellIndex GetCellIndex(TableViewCell* cell) const;
 
+  // Returns the cell index of the last row whose top is at or above the
+  // specified content view offset, or the first row if there is none. The
+  // row is located by binary searches of the cumulative row offsets, which
+  // takes O(log N) time once rows are measured. `{-1, -1}` is returned if the
+  // table view has no rows.
+  CellIndex GetCellIndexAtOffset(const float offset);
+
+  // Returns the cell indexes of all selected rows in ascending order.
+  std::vector<CellIndex> GetCellIndexesForSelectedRows() const;
+
+  // Inserts `number_of_rows` rows at `row_index` in the specified section.
+  void InsertRows(const int section_index, const int row_index,
+                  const int number_of_rows);
+
+  // Inserts `number_of_sections` sections at `section_index`.
+  void InsertSections(const int section_index, const int number_of_sections);
+
+  // Moves the row at `from_cell_index` to `to_cell_index`.
+  void MoveRow(const CellIndex from_cell_index, const CellIndex to_cell_index);
+
+  // Moves the section at `from_section_index` to `to_section_index`.
+  void MoveSection(const int from_section_index, const int to_section_index);
+
+  // Creates cells for the specified reuse identifier handle in idle time
+  // until `number_of_cells` cells are reusable, so the first scroll does not
+  // have to create them. Cells are created one at a time by the function
+  // registered with `RegisterReuseIdentifier()` and never while scrolling.
+  void PrewarmReusableCells(const int reuse_identifier_handle,
+                            const int number_of_cells);
+
+  // Registers a function that creates new cells with the specified reuse
+  // identifier, and returns the identifier's handle to use with
+  // `DequeueReusableCell()`.
+  int RegisterReuseIdentifier(const std::string& reuse_identifier,
+                              std::function<TableViewCell*()> create_cell);
+
   // Reloads the rows and sections of the table view.
   void ReloadData();
 
+  // Resets all counters of `prefetching_statistics()` to zero.
+  void ResetPrefetchingStatistics();
+
+  // Reloads `number_of_rows` rows starting at `row_index` in the specified
+  // section. The selected state of the rows is kept.
+  void ReloadRows(const int section_index, const int row_index,
+                  const int number_of_rows);
+
+  // Reloads `number_of_sections` sections starting at `section_index`. The
+  // rows in the sections are deselected.
+  void ReloadSections(const int section_index, const int number_of_sections);
+
   // Refreshes the layout.
   void RefreshLayout();
 
+  // Renders the pinned section header again in the next refresh cycle. This
+  // must be called after changing the appearance of a section header widget
+  // while it is pinned, since the pinned header is composited from a cached
+  // rendering.
+  void RedrawPinnedSectionHeader();
+
   // Scrolls through the table view until a row identified by cell index is at
   // a particular location on the screen.
   void ScrollToCellIndex(const CellIndex cell_index,
                          const ScrollPosition scroll_position,
                          const bool animating);
 
+  // Scrolls the row identified by cell index to the top of the table view as
+  // part of scrubbing, typically driven by a `TableViewIndexBar`. Calls made
+  // within a frame are coalesced and only the last one is applied right
+  // before the next layout, so scrubbing updates the layout at most once per
+  // frame. Rows that become visible while scrubbing display lightweight
+  // placeholders instead of cells from the data source until
+  // `EndScrubbing()` is called.
+  void ScrubToCellIndex(const CellIndex cell_index);
+
+  // Sets the maximum number of reusable cells kept for the specified reuse
+  // identifier handle. Cells beyond the capacity are released instead of
+  // being kept for reuse.
+  void SetReusableCellCapacity(const int reuse_identifier_handle,
+                               const int capacity);
+
+  // Selects all rows in the table view.
+  void SelectAllRows();
+
   // Selects a row in the table view identified by `cell_index`.
   void SelectRow(const CellIndex cell_index);
 
+  // Selects the rows from `first_row_index` to `last_row_index` inclusively in
+  // the specified section.
+  void SelectRows(const int section_index, const int first_row_index,
+                  const int last_row_index);
+
   // Returns `true` if the specified cell index is valid.
   bool ValidateCellIndex(const CellIndex cell_index);
 
   // Setters and accessors.
-  std::vector<CellIndex>* cell_indexes_for_selected_rows() {
-    return &cell_indexes_for_selected_rows_;
-  }
   std::vector<CellIndex>* cell_indexes_for_visible_rows() {
     return &cell_indexes_for_visible_rows_;
   }
+  int cell_snapshot_cache_capacity() const {
+    return cell_snapshot_cache_.capacity();
+  }
+  void set_cell_snapshot_cache_capacity(const int capacity);
   TableViewDataSource* data_source() const { return data_source_; }
   void set_data_source(TableViewDataSource* data_source);
   TableViewDelegate* delegate() const { return delegate_; }
   void set_delegate(TableViewDelegate* delegate) { delegate_ = delegate; }
+  float estimated_row_height() const { return estimated_row_height_; }
+  void set_estimated_row_height(const float estimated_row_height);
   float height_between_sections() const { return height_between_sections_; }
+  TableViewIndexBar* index_bar() const { return index_bar_; }
+  void set_index_bar(TableViewIndexBar* index_bar);
+  bool is_scrubbing() const { return is_scrubbing_; }
+  bool pins_section_headers() const { return pins_section_headers_; }
+  void set_pins_section_headers(const bool pins_section_headers);
+  TableViewDataSourcePrefetching* prefetch_data_source() const {
+    return prefetch_data_source_;
+  }
+  void set_prefetch_data_source(
+      TableViewDataSourcePrefetching* prefetch_data_source);
+  const PrefetchingStatistics& prefetching_statistics() const {
+    return prefetching_statistics_;
+  }
   void set_height_between_sections(const float height_between_sections);
   float row_height() const { return row_height_; }
   void set_row_height(const float row_height);
+  const RowSelection* selected_rows() const { return &selected_rows_; }
   NVGcolor separator_color() const { return separator_color_; }
   void set_separator_color(const NVGcolor separator_color);
   EdgeInsets separator_insets() const { return separator_insets_; }
@@ -126,11 +378,90 @@ class TableView : public ScrollView {
   std::vector<TableViewCell*>* visible_cells() { return &visible_cells_; }
 
  protected:
+  // Inherited from `Widget` class.
+  void ContextWillChange(NVGcontext* context) override;
+
+  // Inherited from `Widget` class. Releases all reusable cells.
+  void HandleMemoryWarning(NVGcontext* context) override;
+
+  // Inherited from `Widget` class. Renders the pinned section header in
+  // `pinned_section_header_framebuffer_` if necessary.
+  void RenderFramebuffer(NVGcontext* context) override;
+
   // Inherited from `Widget` class.
   bool WidgetViewWillRender(NVGcontext* context) override;
 
  private:
-  // Returns the height to use for a row in a specified location.
+  // A visible cell that is sliding to its position after updates.
+  struct DisplacedCell {
+    // The weak reference to the sliding cell.
+    TableViewCell* cell;
+    // The index of the row the cell displayed when it started sliding. The
+    // cell stops sliding if it is reused for another row.
+    CellIndex cell_index;
+    // The vertical distance in points between the cell's initial position
+    // and its laid out position.
+    float displacement;
+  };
+
+  // Keeps the measured layout of a section in the content view.
+  struct SectionLayout {
+    // The vertical offset of the section header.
+    float header_offset;
+    // The vertical offset of the first row.
+    float row_offset;
+    // The vertical offset of the section footer.
+    float footer_offset;
+    // The total number of rows in all previous sections, which turns cell
+    // indexes into row numbers counting from the first section.
+    int row_number_offset;
+    // The height of each row. A negative value indicates the row is not
+    // measured yet.
+    std::vector<float> row_heights;
+    // Indicates whether each row's height in `row_heights` is only an
+    // estimate, which is replaced once the row is displayed and measured.
+    std::vector<bool> estimated_rows;
+    // The cumulative offsets of rows relative to `row_offset`. Rows overlap
+    // by 1 point so their separators coincide, and the last element is the
+    // total height of rows minus 1.
+    std::vector<float> row_offsets;
+    // The index of the first row whose following element in `row_offsets` is
+    // out of date. It equals the number of rows if all offsets are valid.
+    int first_invalid_row;
+  };
+
+  // Starts an implicit update if no update is in progress. Returns `true` if
+  // a matching call to `EndUpdates()` is required.
+  bool BeginImplicitUpdates();
+
+  // Tells the prefetching data source to cancel prefetching all rows that are
+  // still pending, and forgets about them.
+  void CancelPrefetchingRows();
+
+  // Captures snapshots of the visible cells whose rows have content versions
+  // and are not captured with the current versions yet. At most
+  // `kMaximumCellSnapshotsPerFrame` cells are captured in a call.
+  void CaptureCellSnapshots();
+
+  // Returns a cell displaying the snapshot of the specified row if the
+  // snapshot matches the row's content version and size, or `nullptr` if
+  // there is none.
+  TableViewCell* DequeueCellSnapshot(const CellIndex cell_index,
+                                     const Size size);
+
+  // Returns the number of the last row whose top is at or above the specified
+  // content view offset, or the first row if there is none. Returns -1 if the
+  // table view has no rows.
+  int GetRowNumberAtOffset(const float offset) const;
+
+  // Determines the vertical offset and height of the specified row according
+  // to `section_layouts_`. Returns `false` if the row does not exist.
+  bool GetRowBounds(const CellIndex cell_index, float* offset,
+                    float* height) const;
+
+  // Returns the height to use for a row in a specified location. Returns
+  // `kAutomaticDimenstion` if the row is self-sizing and has to be measured
+  // once displayed.
   float GetRowHeight(const CellIndex cell_index);
 
   // Inherited from `Widget` class.
@@ -140,33 +471,93 @@ class TableView : public ScrollView {
   // This method exists for the purpose of delay highlighting.
   void HighlightDownEventCell();
 
-  // Adds the specified cell to the `reusable_cells_` vector if the cell's
-  // reusable identifier is not empty.
+  // Adds the specified cell to `visible_cells_` at the specified position and
+  // registers it in `visible_cells_by_index_`.
+  void InsertVisibleCell(const int position, const CellIndex cell_index,
+                         TableViewCell* cell);
+
+  // Measures the visible rows whose heights are estimated and replaces their
+  // estimates. Returns `true` if any row is measured, in which case the
+  // layout has to be updated again.
+  bool MeasureVisibleRows(NVGcontext* context);
+
+  // Replaces the placeholder or snapshot displayed at the specified position
+  // in `visible_cells_` with a cell from the data source, and returns the
+  // new cell.
+  TableViewCell* MaterializeVisibleCell(const int position);
+
+  // Tells the prefetching data source to prefetch, or to cancel prefetching,
+  // the rows numbered from `first_row_number` to `last_row_number`
+  // inclusively. One call is made for each section involved.
+  void NotifyPrefetchingRows(const int first_row_number,
+                             const int last_row_number, const bool cancels);
+
+  // Forgets the row displayed by the specified cell and passes the cell to
+  // `reusable_cell_pool_`.
   void ReuseCell(TableViewCell* cell);
 
   // Reuses visible cells.
   void ReuseVisibleCells(const int begin, const int last);
 
+  // Renders a cell returned by `DequeueCellSnapshot()` by compositing the
+  // snapshot of its row.
+  void RenderCellSnapshot(moui::Widget* widget, NVGcontext* context);
+
   // Renders the `layout_view_`.
   void RenderLayoutView(moui::Widget* widget, NVGcontext* context);
 
+  // Renders the `pinned_section_header_view_` by compositing the cached
+  // rendering of the pinned section header.
+  void RenderPinnedSectionHeaderView(moui::Widget* widget,
+                                     NVGcontext* context);
+
   // Sets the highlighted state of a table-view cell.
   void SetCellHighlighted(TableViewCell* cell, const bool highlighted);
 
   // Inherited from `Widget` class.
   bool ShouldHandleEvent(const Point location) final;
 
+  // Returns `true` if the specified visible cell, which displays a row of
+  // the specified size, is a placeholder or snapshot that should be replaced
+  // in the next layout.
+  bool ShouldReplaceVisibleCell(TableViewCell* cell, const Size size) const;
+
   // Updates the layout of displayed cells. Returns `true` if the layout did
   // update.
   bool UpdateLayout();
 
-  // The cell indexes representing the selected rows.
-  std::vector<CellIndex> cell_indexes_for_selected_rows_;
+  // Moves the range of prefetched rows ahead of the visible rows in the
+  // direction of scrolling, and notifies the prefetching data source of the
+  // rows entering and leaving the range.
+  void UpdatePrefetchingRows();
+
+  // Measures the rows of the specified section from its first invalid row
+  // offset and brings `row_offsets` up to date.
+  void UpdateRowOffsets(const int section_index, SectionLayout* layout);
+
+  // Brings `section_layouts_` in sync with the data source and updates the
+  // offsets of sections. Only rows that are not measured yet are measured.
+  void UpdateSectionLayouts();
+
+  // Updates the selected state of visible cells to match `selected_rows_`.
+  void UpdateSelectedStateOfVisibleCells();
+
+  // Replaces the index of each visible cell with the one returned by
+  // `adjust`. Cells whose adjusted section index is -1 are reused.
+  void UpdateVisibleCellIndexes(
+      std::function<CellIndex(const CellIndex cell_index)> adjust);
 
   // Indicates a list of cell indexes each identifying a visible row in the
   // table view.
   std::vector<CellIndex> cell_indexes_for_visible_rows_;
 
+  // Keeps the snapshots of cells whose rows have content versions provided
+  // by `TableViewDelegate::GetTableViewRowContentVersion()`. A row
+  // reappearing with the same version is displayed by its snapshot until
+  // interacted with. The cache is disabled until its capacity is set by
+  // `set_cell_snapshot_cache_capacity()`.
+  CellSnapshotCache cell_snapshot_cache_;
+
   // The weak reference to the `TableViewDataSource` delegate instance.
   TableViewDataSource* data_source_;
 
@@ -180,26 +571,120 @@ class TableView : public ScrollView {
   // coordinate system when receiving the `Event::Type::kDown` event.
   Point down_event_origin_;
 
+  // The visible cells sliding to their positions after the last animated
+  // updates.
+  std::vector<DisplacedCell> displaced_cells_;
+
+  // The height in points used for rows that are not measured yet when the
+  // row height is `kAutomaticDimenstion`. Rows are self-sizing, each asking
+  // its cell for `TableViewCell::GetFittingHeight()` once displayed, if the
+  // value is greater than 0. The default value is 0, which disables
+  // self-sizing rows.
+  float estimated_row_height_;
+
+  // The number of the first row in the range of prefetched rows. The range is
+  // empty if the value is -1.
+  int first_prefetching_row_number_;
+
   // Indicates the height in points between sections.
   float height_between_sections_;
 
+  // The handle of the scheduled callback that highlights `down_event_cell_`.
+  // The callback is cancelled when the view is destroyed. The value is 0 if
+  // there is none.
+  Clock::Handle highlight_callback_handle_;
+
+  // The weak reference to the index bar displayed along the right edge of
+  // the table view. The default value is `nullptr`.
+  TableViewIndexBar* index_bar_;
+
+  // Indicates whether the table view is scrubbing, in which case rows that
+  // become visible display placeholders.
+  bool is_scrubbing_;
+
   // Keeps the bottommost content view offset last time updated layout.
   float last_bottommost_content_view_offset_;
 
+  // The timestamp of the last time updated layout.
+  double last_layout_timestamp_;
+
+  // The number of the last row in the range of prefetched rows. The range is
+  // empty if the value is -1.
+  int last_prefetching_row_number_;
+
   // Keeps the topmost content view offset last time updated layout.
   float last_topmost_content_view_offset_;
 
   // The strong reference to the view sitting above the content view to display
-  // the layout such as separators.
+  // the layout such as separators. It does not cache its rendering since the
+  // layout changes in every scrolling frame, and drawing all separators as a
+  // single path is cheaper than rendering a framebuffer of the table view's
+  // size.
   moui::Widget* layout_view_;
 
-  // Keeps strong reference to the cell objects that are marked as reusable.
-  // The key indicates the cells' `reuse_identifier` property.
-  std::map<std::string, std::queue<TableViewCell*>> reusable_cells_;
+  // The content view offset requested by the last `ScrubToCellIndex()` call
+  // that is not applied yet. A negative value indicates there is none.
+  float pending_scrubbing_offset_;
+
+  // The weak reference to the section header that is currently pinned at the
+  // top of the table view, or `nullptr` if there is none.
+  moui::Widget* pinned_section_header_;
+
+  // The framebuffer caching the rendering of `pinned_section_header_`.
+  NVGframebuffer* pinned_section_header_framebuffer_;
+
+  // The scale factor `pinned_section_header_framebuffer_` was rendered at.
+  float pinned_section_header_framebuffer_scale_factor_;
+
+  // The vertical offset of the pinned section header relative to the table
+  // view's top. It is negative while the header is pushed up by the end of
+  // its section.
+  float pinned_section_header_offset_;
+
+  // The strong reference to the view sitting above `layout_view_` to display
+  // the pinned section header.
+  moui::Widget* pinned_section_header_view_;
+
+  // Indicates whether the header of the topmost visible section stays at the
+  // top of the table view until pushed up by the end of its section. The
+  // default value is `false`.
+  bool pins_section_headers_;
+
+  // The reuse identifier handle of placeholder cells displayed while
+  // scrubbing.
+  int placeholder_cell_handle_;
+
+  // The weak reference to the `TableViewDataSourcePrefetching` instance.
+  TableViewDataSourcePrefetching* prefetch_data_source_;
+
+  // Keeps the counters of prefetching.
+  PrefetchingStatistics prefetching_statistics_;
+
+  // Keeps the reusable cells.
+  ReusableCellPool reusable_cell_pool_;
 
   // Indicates the height of each row in the table view.
   float row_height_;
 
+  // Keeps the measured layout of each section. It is cleared whenever row
+  // heights may have changed altogether.
+  std::vector<SectionLayout> section_layouts_;
+
+  // The vertical scrolling velocity in points per second measured between
+  // layouts. A positive value indicates scrolling toward the bottom.
+  float scroll_velocity_;
+
+  // Keeps the selected rows.
+  RowSelection selected_rows_;
+
+  // Indicates whether cells from the data source were displayed since the
+  // last time capturing cell snapshots.
+  bool should_capture_cell_snapshots_;
+
+  // Indicates whether `pinned_section_header_` should be rendered again in
+  // `pinned_section_header_framebuffer_`.
+  bool should_render_pinned_section_header_;
+
   // Indicates whether the layout should update.
   bool should_update_layout_;
 
@@ -210,6 +695,13 @@ class TableView : public ScrollView {
   // right insets are honered.
   EdgeInsets separator_insets_;
 
+  // The reuse identifier handle of cells displaying snapshots.
+  int snapshot_cell_handle_;
+
+  // The vertical offset of the table footer view, which is also the bottom
+  // of the last section.
+  float table_footer_offset_;
+
   // The weak reference to the accessory view that is displayed below the table.
   // The default value is `nullptr`. The table view is different from a section
   // footer.
@@ -220,9 +712,19 @@ class TableView : public ScrollView {
   // header.
   moui::Widget* table_header_view_;
 
+  // The timestamp at which the displaced cells started sliding.
+  double update_animation_timestamp_;
+
+  // The nesting level of `BeginUpdates()` calls.
+  int update_level_;
+
   // The table cells that are visible in the table view.
   std::vector<TableViewCell*> visible_cells_;
 
+  // Maps the packed section and row indexes of each visible row to its cell
+  // for constant-time lookups. It always mirrors `visible_cells_`.
+  std::unordered_map<uint64_t, TableViewCell*> visible_cells_by_index_;
+
   DISALLOW_COPY_AND_ASSIGN(TableView);
 };
 
@@ -254,6 +756,43 @@ class TableViewDataSource {
   DISALLOW_COPY_AND_ASSIGN(TableViewDataSource);
 };
 
+// The `TableViewDataSourcePrefetching` class is adopted by an object that
+// prepares the data of rows before the table view asks for their cells, such
+// as loading remote content or decoding images on worker threads. All methods
+// are called on the main thread and should return quickly.
+class TableViewDataSourcePrefetching {
+ public:
+  TableViewDataSourcePrefetching() {}
+  virtual ~TableViewDataSourcePrefetching() {}
+
+  // Tells the data source to start preparing the data of the rows from
+  // `first_row_index` to `last_row_index` inclusively in the specified
+  // section. The rows are likely to become visible soon.
+  virtual void TableViewPrefetchRows(TableView* table_view,
+                                     const int section_index,
+                                     const int first_row_index,
+                                     const int last_row_index) = 0;
+
+  // Tells the data source that the rows from `first_row_index` to
+  // `last_row_index` inclusively in the specified section are no longer
+  // expected to become visible, so their pending preparation can be
+  // cancelled.
+  virtual void TableViewCancelPrefetchingRows(TableView* table_view,
+                                              const int section_index,
+                                              const int first_row_index,
+                                              const int last_row_index) {}
+
+  // Asks the data source whether the data of the specified row is ready. The
+  // table view asks this only for statistics when the row becomes visible.
+  virtual bool TableViewHasPrefetchedRow(
+      TableView* table_view, const TableView::CellIndex cell_index) {
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TableViewDataSourcePrefetching);
+};
+
 // The `TableViewDelegate` class allows the table view delegate to manage
 // selections, configure section headings and footers, and perform other
 // actions.
@@ -292,7 +831,22 @@ class TableViewDelegate {
     return 0;
   }
 
+  // Asks the delegate for the version of the content displayed by the
+  // specified row. If the table view's cell snapshot cache is enabled, rows
+  // with versions of 0 or greater are captured once displayed, and the
+  // snapshots are composited instead of requesting cells from the data
+  // source when the rows reappear with the same versions. The version must
+  // change whenever the row's cell would look different. Returns -1 by
+  // default, which never captures the row.
+  virtual int GetTableViewRowContentVersion(
+      TableView* table_view, const TableView::CellIndex cell_index) {
+    return -1;
+  }
+
   // Asks the delegate for the height to use for a row in a specified location.
+  // Returning `kAutomaticDimenstion` falls back to the table view's row
+  // height, or makes the row self-sizing if the table view has an estimated
+  // row height.
   virtual float GetTableViewRowHeight(TableView* table_view,
                                       const TableView::CellIndex cell_index) {
     return TableView::kAutomaticDimenstion;
@@ -18,6 +18,9 @@
 #include "moui/widgets/table_view_cell.h"
 
 #include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
 
 #include "moui/widgets/label.h"
 #include "moui/widgets/table_view.h"
@@ -32,6 +35,8 @@ const float kAccessoryCheckmarkVectorWidth = 13;
 const float kDefaultCellHorizontalPadding = 20;
 // The default text color of the detail text label.
 const NVGcolor kDefaultDetailTextLabelTextColor = nvgRGB(170, 170, 170);
+// The default vertical padding in points of a cell that fits its content.
+const float kDefaultCellVerticalPadding = 11;
 // The default width and height of the cell's image view.
 const float kDefaultImageViewLength = 30;
 // The default padding in points between accessory indicator and detail text
@@ -49,8 +54,9 @@ namespace moui {
 TableViewCell::TableViewCell(const Style style,
                              const std::string& reuse_identifier)
     : accessory_type_(AccessoryType::kNone), detail_text_label_(nullptr),
-      highlighted_(false), reuse_identifier_(reuse_identifier),
-      selected_(false), style_(style) {
+      highlighted_(false), row_index_(-1), reuse_identifier_(reuse_identifier),
+      reuse_identifier_handle_(GetReuseIdentifierHandle(reuse_identifier)),
+      section_index_(-1), selected_(false), style_(style) {
   set_auto_release_children(true);
 
   // Initializes content view.
@@ -94,6 +100,51 @@ TableViewCell::~TableViewCell() {
   moui::Widget::SmartRelease(detail_text_label_);
 }
 
+float TableViewCell::GetFittingHeight(NVGcontext* context,
+                                       const float width) {
+  SetWidth(width);
+  UpdateLayout(context);
+
+  // The built-in widgets are vertically centered.
+  float content_height = text_label_->MeasureTextHeight(
+      context, text_label_->GetWidth());
+  if (detail_text_label_ != nullptr) {
+    content_height = std::max(
+        content_height,
+        detail_text_label_->MeasureTextHeight(context,
+                                              detail_text_label_->GetWidth()));
+  }
+  if (!image_view_->IsHidden())
+    content_height = std::max(content_height, image_view_->GetHeight());
+  float height = content_height + kDefaultCellVerticalPadding * 2;
+
+  // Other widgets occupy the space from the top of the content view.
+  for (Widget* child : *content_view_->children()) {
+    if (child == text_label_ || child == detail_text_label_ ||
+        child == image_view_ || child->IsHidden())
+      continue;
+    Size occupied_space;
+    child->GetOccupiedSpace(&occupied_space);
+    height = std::max(height,
+                      occupied_space.height + kDefaultCellVerticalPadding);
+  }
+  return std::ceil(height);
+}
+
+int TableViewCell::GetReuseIdentifierHandle(
+    const std::string& reuse_identifier) {
+  if (reuse_identifier.empty())
+    return -1;
+
+  static std::unordered_map<std::string, int> handles;
+  auto match = handles.find(reuse_identifier);
+  if (match != handles.end())
+    return match->second;
+  const int kHandle = static_cast<int>(handles.size());
+  handles[reuse_identifier] = kHandle;
+  return kHandle;
+}
+
 void TableViewCell::PrepareForReuse() {
 }
 
@@ -60,6 +60,19 @@ class TableViewCell : public Widget {
   explicit TableViewCell(const Style style);
   ~TableViewCell();
 
+  // Returns the height that fits the cell's content when the cell is laid out
+  // with the specified `width`. `TableView` calls this method to measure rows
+  // whose heights are estimated. The default implementation wraps the text
+  // of the built-in labels, which are vertically centered, and takes the
+  // space occupied by other visible widgets in `content_view_` as they are
+  // positioned from the top. Subclasses with custom layouts may override it.
+  virtual float GetFittingHeight(NVGcontext* context, const float width);
+
+  // Returns the handle interned for the specified reuse identifier. The same
+  // identifier always maps to the same handle so handles can be compared and
+  // used as indexes instead of strings. Returns -1 if the identifier is empty.
+  static int GetReuseIdentifierHandle(const std::string& reuse_identifier);
+
   // Prepares a reusable cell for reuse by the table view's delegate. This
   // method is invoked just before the object is returned from the
   // `TableView::DequeueReusableCell()` method. If the cell object does not
@@ -75,6 +88,7 @@ class TableViewCell : public Widget {
   void set_highlighted(const bool highlighted);
   Widget* image_view() const { return image_view_; }
   std::string reuse_identifier() const { return reuse_identifier_; }
+  int reuse_identifier_handle() const { return reuse_identifier_handle_; }
   bool selected() const { return selected_; }
   void set_selected(const bool selected);
   Style style() const { return style_; }
@@ -85,6 +99,9 @@ class TableViewCell : public Widget {
   bool WidgetViewWillRender(NVGcontext* context) override;
 
  private:
+  // Allows `TableView` to maintain `section_index_` and `row_index_`.
+  friend class TableView;
+
   // Renders the content view.
   void RenderContentView(moui::Widget* widget, NVGcontext* context);
 
@@ -110,11 +127,23 @@ class TableViewCell : public Widget {
   // the left side of the cell, before any label.
   Widget* image_view_;
 
+  // The row index of the row the cell currently displays in its table view.
+  // The value is -1 if the cell is not visible in any table view.
+  int row_index_;
+
   // Indicates a string used to identify the cell object if it is to be reused
   // for drawing multiple rows of a table view. Pass an empty string if the
   // cell object is not to be reused.
   std::string reuse_identifier_;
 
+  // The handle interned for `reuse_identifier_`, or -1 if the identifier is
+  // empty.
+  int reuse_identifier_handle_;
+
+  // The section index of the row the cell currently displays in its table
+  // view. The value is -1 if the cell is not visible in any table view.
+  int section_index_;
+
   // Indicates whether the cell is selected.
   bool selected_;
 
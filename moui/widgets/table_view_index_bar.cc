@@ -0,0 +1,178 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/table_view_index_bar.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include "moui/base.h"
+#include "moui/core/clock.h"
+#include "moui/core/event.h"
+#include "moui/nanovg_hook.h"
+#include "moui/widgets/table_view.h"
+#include "moui/widgets/widget.h"
+
+namespace {
+
+// The default width of the index bar in points.
+const float kDefaultWidth = 24;
+// The duration in seconds the finger has to rest before the rows scrubbed to
+// are configured by the data source.
+const double kScrubbingPauseDuration = 0.15;
+// The height of the thumb in points.
+const float kThumbHeight = 36;
+// The horizontal inset of the thumb in points.
+const float kThumbInset = 8;
+// The vertical padding in points between the track and the index bar's edges.
+const float kTrackPadding = 4;
+
+}  // namespace
+
+namespace moui {
+
+TableViewIndexBar::TableViewIndexBar()
+    : Widget(false), last_scrubbing_timestamp_(0),
+      scrubbing_cell_index_({-1, -1}),
+      scrubbing_reference_(std::make_shared<TableViewIndexBar*>(this)),
+      table_view_(nullptr),
+      thumb_color_(nvgRGBA(0, 0, 0, 90)),
+      track_color_(nvgRGBA(175, 175, 175, 60)) {
+  set_is_opaque(false);
+  SetWidth(kDefaultWidth);
+}
+
+TableViewIndexBar::~TableViewIndexBar() {
+  if (table_view_ != nullptr)
+    table_view_->set_index_bar(nullptr);
+}
+
+void TableViewIndexBar::EndScrubbingIfPaused() {
+  if (table_view_ == nullptr || !table_view_->is_scrubbing())
+    return;
+
+  const double kElapsedTime = \
+      Clock::GetTimestamp() - last_scrubbing_timestamp_;
+  if (kElapsedTime >= kScrubbingPauseDuration) {
+    table_view_->EndScrubbing();
+    return;
+  }
+  // Checks again when the pause would be long enough.
+  ScheduleEndScrubbingIfPaused(kScrubbingPauseDuration - kElapsedTime);
+}
+
+bool TableViewIndexBar::HandleEvent(Event* event) {
+  if (table_view_ == nullptr)
+    return false;
+
+  if (event->type() == Event::Type::kDown ||
+      event->type() == Event::Type::kMove) {
+    ScrubToLocation(event->locations()->at(0));
+  } else {
+    table_view_->EndScrubbing();
+    scrubbing_cell_index_ = {-1, -1};
+    Redraw();
+  }
+  // Stops propagating the event so the table view does not scroll.
+  return false;
+}
+
+void TableViewIndexBar::Render(NVGcontext* context) {
+  if (table_view_ == nullptr)
+    return;
+  const float kMaximumOffset = \
+      table_view_->GetContentViewSize().height - table_view_->GetHeight();
+  if (kMaximumOffset <= 0)
+    return;
+
+  const float kWidth = GetWidth();
+  const float kTrackHeight = GetHeight() - kTrackPadding * 2;
+  if (scrubbing_cell_index_.section_index >= 0) {
+    nvgBeginPath(context);
+    nvgRoundedRect(context, 0, kTrackPadding, kWidth, kTrackHeight,
+                   kWidth / 2);
+    nvgFillColor(context, track_color_);
+    nvgFill(context);
+  }
+
+  const float kFraction = std::max(
+      0.0f,
+      std::min(1.0f, table_view_->GetContentViewOffset().y / kMaximumOffset));
+  const float kThumbWidth = kWidth - kThumbInset * 2;
+  nvgBeginPath(context);
+  nvgRoundedRect(context, kThumbInset,
+                 kTrackPadding + kFraction * (kTrackHeight - kThumbHeight),
+                 kThumbWidth, kThumbHeight, kThumbWidth / 2);
+  nvgFillColor(context, thumb_color_);
+  nvgFill(context);
+}
+
+void TableViewIndexBar::ScheduleEndScrubbingIfPaused(const double delay) {
+  std::weak_ptr<TableViewIndexBar*> reference = scrubbing_reference_;
+  Clock::ExecuteCallbackOnMainThread(delay, [reference]() {
+    std::shared_ptr<TableViewIndexBar*> index_bar = reference.lock();
+    if (index_bar != nullptr)
+      (*index_bar)->EndScrubbingIfPaused();
+  });
+}
+
+void TableViewIndexBar::ScrubToLocation(const Point location) {
+  const float kMaximumOffset = \
+      table_view_->GetContentViewSize().height - table_view_->GetHeight();
+  if (kMaximumOffset <= 0)
+    return;
+
+  // Maps the location to the content view offset at which the thumb's center
+  // would be at the location.
+  Point origin;
+  GetMeasuredBounds(&origin, nullptr);
+  const float kTrackHeight = GetHeight() - kTrackPadding * 2 - kThumbHeight;
+  const float kFraction = kTrackHeight <= 0 ? 0 : std::max(
+      0.0f,
+      std::min(1.0f, (location.y - origin.y - kTrackPadding
+                      - kThumbHeight / 2) / kTrackHeight));
+  const TableView::CellIndex kCellIndex = \
+      table_view_->GetCellIndexAtOffset(kFraction * kMaximumOffset);
+  last_scrubbing_timestamp_ = Clock::GetTimestamp();
+  if (kCellIndex.section_index == scrubbing_cell_index_.section_index &&
+      kCellIndex.row_index == scrubbing_cell_index_.row_index) {
+    return;
+  }
+
+  const bool kWasScrubbing = table_view_->is_scrubbing();
+  scrubbing_cell_index_ = kCellIndex;
+  table_view_->ScrubToCellIndex(kCellIndex);
+  if (!kWasScrubbing)
+    ScheduleEndScrubbingIfPaused(kScrubbingPauseDuration);
+}
+
+bool TableViewIndexBar::ShouldHandleEvent(const Point location) {
+  return table_view_ != nullptr && CollidePoint(location, 0);
+}
+
+void TableViewIndexBar::set_thumb_color(const NVGcolor thumb_color) {
+  thumb_color_ = thumb_color;
+  Redraw();
+}
+
+void TableViewIndexBar::set_track_color(const NVGcolor track_color) {
+  track_color_ = track_color;
+  Redraw();
+}
+
+}  // namespace moui
@@ -0,0 +1,110 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_TABLE_VIEW_INDEX_BAR_H_
+#define MOUI_WIDGETS_TABLE_VIEW_INDEX_BAR_H_
+
+#include <memory>
+
+#include "moui/base.h"
+#include "moui/nanovg_hook.h"
+#include "moui/widgets/table_view.h"
+#include "moui/widgets/widget.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+
+// The `TableViewIndexBar` widget lets users jump through a long table view by
+// dragging a finger along it. The finger's position along the bar maps
+// proportionally to a content view offset, which is turned into a row in
+// O(log N) time by `TableView::GetCellIndexAtOffset()`. The table view then
+// scrubs to the row at most once per frame and displays placeholders for
+// rows that only flash past until the finger pauses or lifts.
+//
+// The index bar is attached with `TableView::set_index_bar()`, which places
+// it along the right edge of the table view. The default width is 24 points.
+class TableViewIndexBar : public Widget {
+ public:
+  TableViewIndexBar();
+  ~TableViewIndexBar();
+
+  // Setters and accessors.
+  TableView::CellIndex scrubbing_cell_index() const {
+    return scrubbing_cell_index_;
+  }
+  TableView* table_view() const { return table_view_; }
+  NVGcolor thumb_color() const { return thumb_color_; }
+  void set_thumb_color(const NVGcolor thumb_color);
+  NVGcolor track_color() const { return track_color_; }
+  void set_track_color(const NVGcolor track_color);
+
+ private:
+  // Allows `TableView` to maintain `table_view_`.
+  friend class TableView;
+
+  // Ends scrubbing of the table view if the finger has not moved for
+  // `kScrubbingPauseDuration` seconds. This method exists for the purpose
+  // of delay checking.
+  void EndScrubbingIfPaused();
+
+  // Inherited from `Widget` class.
+  bool HandleEvent(Event* event) final;
+
+  // Inherited from `Widget` class. Renders the track while scrubbing and the
+  // thumb indicating the current position of the table view.
+  void Render(NVGcontext* context) final;
+
+  // Calls `EndScrubbingIfPaused()` after the delay in seconds unless the
+  // index bar is destroyed by then.
+  void ScheduleEndScrubbingIfPaused(const double delay);
+
+  // Scrubs the table view to the row corresponding to the specified location
+  // in the widget view's coordinate system.
+  void ScrubToLocation(const Point location);
+
+  // Inherited from `Widget` class.
+  bool ShouldHandleEvent(const Point location) final;
+
+  // The timestamp of the last time the finger moved while scrubbing.
+  double last_scrubbing_timestamp_;
+
+  // The cell index of the row scrubbed to last time, or `{-1, -1}` if not
+  // scrubbing.
+  TableView::CellIndex scrubbing_cell_index_;
+
+  // Keeps a reference to this index bar that the delayed pause check holds
+  // weakly, so the check does nothing once the index bar is destroyed.
+  std::shared_ptr<TableViewIndexBar*> scrubbing_reference_;
+
+  // The weak reference to the table view the index bar is attached to.
+  TableView* table_view_;
+
+  // The color of the thumb. The default color is translucent black.
+  NVGcolor thumb_color_;
+
+  // The color of the track displayed while scrubbing. The default color is
+  // translucent gray.
+  NVGcolor track_color_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableViewIndexBar);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_TABLE_VIEW_INDEX_BAR_H_
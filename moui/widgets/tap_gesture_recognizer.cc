@@ -0,0 +1,67 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#include "moui/widgets/tap_gesture_recognizer.h"
+
+#include <cmath>
+
+#include "moui/base.h"
+#include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace {
+
+// The default maximum distance in points a tap could move.
+const float kDefaultAllowableMovement = 10;
+
+}  // namespace
+
+namespace moui {
+
+TapGestureRecognizer::TapGestureRecognizer()
+    : allowable_movement_(kDefaultAllowableMovement) {
+}
+
+TapGestureRecognizer::~TapGestureRecognizer() {
+}
+
+void TapGestureRecognizer::HandleEvent(Event* event) {
+  if (GetNumberOfPointers() > 1) {
+    SetState(State::kFailed);
+    return;
+  }
+
+  const Point kLocation = GetLocation();
+  switch (event->type()) {
+    case Event::Type::kDown:
+      down_location_ = kLocation;
+      break;
+    case Event::Type::kMove:
+      if (std::hypot(kLocation.x - down_location_.x,
+                     kLocation.y - down_location_.y) > allowable_movement_) {
+        SetState(State::kFailed);
+      }
+      break;
+    case Event::Type::kUp:
+      SetState(State::kEnded);
+      break;
+    default:
+      SetState(State::kFailed);
+  }
+}
+
+}  // namespace moui
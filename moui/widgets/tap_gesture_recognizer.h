@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Ollix. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ---
+// Author: olliwang@ollix.com (Olli Wang)
+
+#ifndef MOUI_WIDGETS_TAP_GESTURE_RECOGNIZER_H_
+#define MOUI_WIDGETS_TAP_GESTURE_RECOGNIZER_H_
+
+#include "moui/base.h"
+#include "moui/widgets/gesture_recognizer.h"
+
+namespace moui {
+
+// Forward declaration.
+class Event;
+
+// The `TapGestureRecognizer` class recognizes a discrete tap of a single
+// pointer. The tap fails if the pointer moves farther than
+// `allowable_movement()` or another pointer touches down.
+class TapGestureRecognizer : public GestureRecognizer {
+ public:
+  TapGestureRecognizer();
+  ~TapGestureRecognizer();
+
+  // Accessors and setters.
+  float allowable_movement() const { return allowable_movement_; }
+  void set_allowable_movement(const float allowable_movement) {
+    allowable_movement_ = allowable_movement;
+  }
+
+ protected:
+  // Inherited from `GestureRecognizer` class.
+  void HandleEvent(Event* event) override;
+
+ private:
+  // The maximum distance in points the pointer could move before the tap
+  // fails. The default value is 10.
+  float allowable_movement_;
+
+  // The location where the pointer touched down.
+  Point down_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(TapGestureRecognizer);
+};
+
+}  // namespace moui
+
+#endif  // MOUI_WIDGETS_TAP_GESTURE_RECOGNIZER_H_
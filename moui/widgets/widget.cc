@@ -21,15 +21,20 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
-#include <stack>
 #include <vector>
 
 #include "moui/core/device.h"
 #include "moui/core/event.h"
+#include "moui/widgets/gesture_recognizer.h"
 #include "moui/widgets/widget_view.h"
 
 namespace {
 
+// The distance in binary logarithm the measured scale has to move past the
+// midpoint between two powers of two before cached results are rendered at
+// the other power of two while the scale is changing.
+const float kRasterScaleHysteresis = 0.1;
+
 // Returns the actual length in points of the specified value and unit.
 float CalculatePoints(const moui::Widget::Unit unit, const float value,
                       const float parent_length) {
@@ -52,16 +57,26 @@ float CalculatePoints(const moui::Widget::Unit unit, const float value,
 namespace moui {
 
 Widget::Widget(const bool caches_rendering)
-    : alpha_(1), animation_count_(0), auto_release_children_(false),
+    : alpha_(1), animation_count_(0), atlas_slot_(nullptr),
+      auto_release_children_(false),
       background_color_(nvgRGBA(255, 255, 255, 255)), bottom_padding_(0),
       box_sizing_(BoxSizing::kContentBox), caches_rendering_(caches_rendering),
-      default_framebuffer_(nullptr), height_unit_(Unit::kPoint),
-      height_value_(0), hidden_(false), is_opaque_(true), is_visible_(false),
-      left_padding_(0), measured_scale_(-1), parent_(nullptr),
-      paused_animation_(false), real_parent_(nullptr), render_function_(NULL),
+      default_framebuffer_(nullptr), default_framebuffer_scale_factor_(0),
+      height_unit_(Unit::kPoint),
+      height_value_(0), hidden_(false), is_effective_responder_(false),
+      is_hovered_(false), is_layer_(false), is_opaque_(true),
+      is_visible_(false), layer_change_frequency_(0),
+      layer_framebuffer_(nullptr), layer_is_outdated_(false),
+      layer_rendering_cost_(0), layer_scale_factor_(0), left_padding_(0),
+      measured_scale_(-1), measured_scale_frame_number_(-1),
+      number_of_observed_frames_(0), parent_(nullptr),
+      paused_animation_(false), prefers_layer_(false),
+      raster_scale_(-1), rasterizes_after_scaling_(true),
+      real_parent_(nullptr), render_function_(NULL),
       rendering_offset_({0, 0}), rendering_scale_(1), right_padding_(0),
-      scale_(1), should_redraw_default_framebuffer_(false), tag_(0),
-      top_padding_(0), widget_view_(nullptr), width_unit_(Unit::kPoint),
+      scale_(1), should_redraw_default_framebuffer_(false),
+      subtree_did_change_(false), tag_(0), top_padding_(0),
+      tracks_hover_(false), widget_view_(nullptr), width_unit_(Unit::kPoint),
       width_value_(0), x_alignment_(Alignment::kLeft), x_unit_(Unit::kPoint),
       x_value_(0), y_alignment_(Alignment::kTop), y_unit_(Unit::kPoint),
       y_value_(0) {
@@ -72,6 +87,11 @@ Widget::Widget() : Widget(false) {
 
 Widget::~Widget() {
   StopAnimation(true);
+  ReleaseAtlasSlot();
+  if (is_layer_ && widget_view_ != nullptr)
+    widget_view_->DemoteLayer(this);
+  for (GestureRecognizer* recognizer : gesture_recognizers_)
+    delete recognizer;
 }
 
 void Widget::AddChild(Widget* child) {
@@ -82,16 +102,21 @@ void Widget::AddChild(Widget* child) {
   child->real_parent_ = this;
   child->set_widget_view(widget_view_);
   children_.push_back(child);
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr && !child->IsHidden())
     widget_view_->Redraw();
 }
 
+void Widget::AddGestureRecognizer(GestureRecognizer* recognizer) {
+  recognizer->widget_ = this;
+  gesture_recognizers_.push_back(recognizer);
+}
+
 bool Widget::BeginFramebufferUpdates(NVGcontext* context,
                                      NVGframebuffer** framebuffer,
                                      const float width, const float height,
                                      float* scale_factor) {
-  const float kScaleFactor = \
-      Device::GetScreenScaleFactor() * GetMeasuredScale();
+  const float kScaleFactor = GetRasterScaleFactor();
   const int kWidth = static_cast<int>(width * kScaleFactor);
   const int kHeight = static_cast<int>(height * kScaleFactor);
   if (kWidth < 0 || kHeight < 0)
@@ -143,6 +168,7 @@ bool Widget::BringChildToFront(Widget* child) {
   }
 
   children_.push_back(child);
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr && !child->IsHidden())
     widget_view_->Redraw();
   return true;
@@ -177,8 +203,11 @@ bool Widget::CollidePoint(const Point point, const float top_padding,
 }
 
 void Widget::ContextWillChange(NVGcontext* context) {
+  ReleaseAtlasSlot();
   nvgDeleteFramebuffer(default_framebuffer_);
   default_framebuffer_ = nullptr;
+  nvgDeleteFramebuffer(layer_framebuffer_);
+  layer_framebuffer_ = nullptr;
 }
 
 void Widget::EndFramebufferUpdates() {
@@ -225,25 +254,20 @@ void Widget::GetMeasuredBounds(Point* origin, Size* size) {
   if (origin == nullptr && size == nullptr)
     return;
 
-  std::stack<Widget*> widget_chain;
-  widget_chain.push(this);
-  Widget* parent = real_parent_;
-  while (parent != nullptr) {
-    widget_chain.push(parent);
-    parent = parent->real_parent_;
+  // Walks up the parents without allocating memory as this method is called
+  // for hit testing. Each parent scales the origin measured so far and
+  // offsets it by the parent's own origin.
+  Point measured_origin = {GetX(), GetY()};
+  float scale = this->scale();
+  for (Widget* parent = real_parent_; parent != nullptr;
+       parent = parent->real_parent_) {
+    const float kParentScale = parent->scale();
+    measured_origin.x = parent->GetX() + measured_origin.x * kParentScale;
+    measured_origin.y = parent->GetY() + measured_origin.y * kParentScale;
+    scale *= kParentScale;
   }
-  float scale = 1;
   if (origin != nullptr)
-    *origin = {0.0f, 0.0f};
-  while (!widget_chain.empty()) {
-    Widget* widget = widget_chain.top();
-    widget_chain.pop();
-    if (origin != nullptr) {
-      origin->x += widget->GetX() * scale;
-      origin->y += widget->GetY() * scale;
-    }
-    scale *= widget->scale();
-  }
+    *origin = measured_origin;
   if (size != nullptr) {
     size->width = GetWidth() * scale;
     size->height = GetHeight() * scale;
@@ -262,6 +286,17 @@ float Widget::GetMeasuredScale() {
   return measured_scale_;
 }
 
+float Widget::GetRasterScaleFactor() {
+  const float kMeasuredScale = GetMeasuredScale();
+  if (raster_scale_ <= 0 || !IsScaling()) {
+    raster_scale_ = kMeasuredScale;
+  } else if (std::abs(std::log2(kMeasuredScale / raster_scale_)) >
+             0.5 + kRasterScaleHysteresis) {
+    raster_scale_ = std::exp2(std::round(std::log2(kMeasuredScale)));
+  }
+  return Device::GetScreenScaleFactor() * raster_scale_;
+}
+
 void Widget::GetOccupiedSpace(Size* size) const {
   size->width = GetWidth();
   size->height = GetHeight();
@@ -391,7 +426,12 @@ float Widget::GetY() const {
   return y;
 }
 
+bool Widget::HandleEvent(Event* event) {
+  return !gesture_recognizers_.empty();
+}
+
 void Widget::HandleMemoryWarning(NVGcontext* context) {
+  ReleaseAtlasSlot();
   nvgDeleteFramebuffer(default_framebuffer_);
   default_framebuffer_ = nullptr;
 }
@@ -408,6 +448,7 @@ bool Widget::InsertChildAboveSibling(Widget* child, Widget* sibling) {
   child->real_parent_ = this;
   child->set_widget_view(widget_view_);
   children_.insert(iterator + 1, child);
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr && !child->IsHidden())
     widget_view_->Redraw();
   return true;
@@ -425,6 +466,7 @@ bool Widget::InsertChildBelowSibling(Widget* child, Widget* sibling) {
   child->real_parent_ = this;
   child->set_widget_view(widget_view_);
   children_.insert(iterator, child);
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr && !child->IsHidden())
     widget_view_->Redraw();
   return true;
@@ -449,14 +491,41 @@ bool Widget::IsHidden() const {
   return hidden_;
 }
 
+bool Widget::IsScaling() const {
+  return widget_view_ != nullptr &&
+         measured_scale_frame_number_ == widget_view_->frame_number_;
+}
+
+// The whole chain is always visited since the flags of widgets invisible in
+// the last refresh cycle are not reset.
+void Widget::MarkSubtreeChanged() {
+  for (Widget* widget = this; widget != nullptr;
+       widget = widget->real_parent_) {
+    widget->subtree_did_change_ = true;
+    if (widget->is_layer_)
+      widget->layer_is_outdated_ = true;
+  }
+  // The widget under the cursor may be different now.
+  if (widget_view_ != nullptr)
+    widget_view_->hover_region_is_valid_ = false;
+}
+
 void Widget::Redraw() {
   if (caches_rendering_) {
     should_redraw_default_framebuffer_ = true;
   }
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr)
     widget_view_->Redraw(this);
 }
 
+void Widget::ReleaseAtlasSlot() {
+  if (atlas_slot_ == nullptr)
+    return;
+  widget_view_->raster_atlas_.Release(atlas_slot_);
+  atlas_slot_ = nullptr;
+}
+
 void Widget::ReleaseSelfAndChildrenOnDemand() {
   if (auto_release_children_) {
     while (!children_.empty()) {
@@ -487,38 +556,79 @@ bool Widget::RemoveFromParent() {
   return true;
 }
 
+bool Widget::RemoveGestureRecognizer(GestureRecognizer* recognizer) {
+  auto match = std::find(gesture_recognizers_.begin(),
+                         gesture_recognizers_.end(), recognizer);
+  if (match == gesture_recognizers_.end())
+    return false;
+  gesture_recognizers_.erase(match);
+  delete recognizer;
+  return true;
+}
+
 void Widget::RenderDefaultFramebuffer(NVGcontext* context) {
   if (!caches_rendering_)
     return;
 
-  // Resets the default framebuffer if the widget's size has been changed.
+  // Redraws the cached rendering result if the widget's size has been changed
+  // or its atlas slot has been outdated. Scale changes alone keep the
+  // stretched result until the scale stops changing.
   const float kWidth = GetWidth();
   const float kHeight = GetHeight();
-  if (default_framebuffer_ != nullptr) {
-    const float kScaleFactor = \
-        Device::GetScreenScaleFactor() * GetMeasuredScale();
-    const int kFramebufferWidth = static_cast<int>(kWidth * kScaleFactor);
-    const int kFramebufferHeight = static_cast<int>(kHeight * kScaleFactor);
-    int framebuffer_width = 0;
-    int framebuffer_height = 0;
-    nvgImageSize(default_framebuffer_->ctx, default_framebuffer_->image,
-                 &framebuffer_width, &framebuffer_height);
-    if (kFramebufferWidth != framebuffer_width ||
-        kFramebufferHeight != framebuffer_height) {
-      nvgDeleteFramebuffer(default_framebuffer_);
-      default_framebuffer_ = nullptr;
+  const bool kHasCachedResult = \
+      default_framebuffer_ != nullptr || atlas_slot_ != nullptr;
+  if (kHasCachedResult) {
+    int result_width = 0;
+    int result_height = 0;
+    if (atlas_slot_ != nullptr) {
+      result_width = atlas_slot_->width;
+      result_height = atlas_slot_->height;
+    } else {
+      nvgImageSize(default_framebuffer_->ctx, default_framebuffer_->image,
+                   &result_width, &result_height);
+    }
+    if ((atlas_slot_ != nullptr && atlas_slot_->is_outdated) ||
+        static_cast<int>(kWidth * default_framebuffer_scale_factor_) !=
+            result_width ||
+        static_cast<int>(kHeight * default_framebuffer_scale_factor_) !=
+            result_height ||
+        ShouldRasterizeAgain(default_framebuffer_scale_factor_)) {
       should_redraw_default_framebuffer_ = true;
     }
   }
 
-  if (default_framebuffer_ != nullptr && !should_redraw_default_framebuffer_ &&
+  if (kHasCachedResult && !should_redraw_default_framebuffer_ &&
       !IsAnimating()) {
     return;
   }
   should_redraw_default_framebuffer_ = false;
 
+  // Small results are rendered in the widget view's raster atlas along with
+  // other pending slots once all widgets are prepared.
+  const float kScaleFactor = GetRasterScaleFactor();
+  const int kPixelWidth = static_cast<int>(kWidth * kScaleFactor);
+  const int kPixelHeight = static_cast<int>(kHeight * kScaleFactor);
+  RasterAtlas* atlas = &widget_view_->raster_atlas_;
+  if (atlas_slot_ == nullptr || atlas_slot_->is_outdated ||
+      atlas_slot_->width != kPixelWidth ||
+      atlas_slot_->height != kPixelHeight ||
+      atlas_slot_->scale_factor != kScaleFactor) {
+    ReleaseAtlasSlot();
+    atlas_slot_ = atlas->Allocate(context, this, kPixelWidth, kPixelHeight,
+                                  kScaleFactor);
+  }
+  if (atlas_slot_ != nullptr) {
+    nvgDeleteFramebuffer(default_framebuffer_);
+    default_framebuffer_ = nullptr;
+    default_framebuffer_scale_factor_ = kScaleFactor;
+    default_framebuffer_paint_ = atlas->GetPaint(context, atlas_slot_);
+    atlas->RequestRendering(atlas_slot_);
+    return;
+  }
+
   float scale_factor;
   if (BeginFramebufferUpdates(context, &default_framebuffer_, &scale_factor)) {
+    default_framebuffer_scale_factor_ = scale_factor;
     nvgBeginFrame(context, kWidth, kHeight, scale_factor);
     ExecuteRenderFunction(context);
     nvgEndFrame(context);
@@ -535,7 +645,8 @@ bool Widget::RenderFunctionIsBinded() const {
 }
 
 void Widget::RenderOnDemand(NVGcontext* context) {
-  if (caches_rendering_ && default_framebuffer_ != nullptr) {
+  if (caches_rendering_ &&
+      (default_framebuffer_ != nullptr || atlas_slot_ != nullptr)) {
     nvgBeginPath(context);
     nvgRect(context, 0, 0, GetWidth(), GetHeight());
     nvgFillPaint(context, default_framebuffer_paint_);
@@ -545,6 +656,21 @@ void Widget::RenderOnDemand(NVGcontext* context) {
   }
 }
 
+bool Widget::RenderToFramebuffer(NVGframebuffer** framebuffer) {
+  if (widget_view_ == nullptr)
+    return false;
+
+  NVGcontext* context = widget_view_->context();
+  if (context == nullptr)
+    return false;
+
+  if (!BeginFramebufferUpdates(context, framebuffer, nullptr))
+    return false;
+  const bool kResult = widget_view_->Render(this, *framebuffer);
+  EndFramebufferUpdates();
+  return kResult;
+}
+
 void Widget::ResetContext(NVGcontext* context) {
   for (Widget* child : *children()) {
     child->ResetContext(context);
@@ -556,7 +682,8 @@ void Widget::ResetContext(NVGcontext* context) {
 
 void Widget::ResetMeasuredScale() {
   measured_scale_ = -1;
-  Redraw();
+  if (widget_view_ != nullptr)
+    measured_scale_frame_number_ = widget_view_->frame_number_;
 }
 
 void Widget::ResetMeasuredScaleRecursively(Widget* widget) {
@@ -577,6 +704,7 @@ bool Widget::SendChildToBack(Widget* child) {
     children_.erase(iterator);
   }
   children_.insert(children_.begin(), child);
+  MarkSubtreeChanged();
   if (widget_view_ != nullptr && !child->IsHidden())
     widget_view_->Redraw();
   return true;
@@ -607,6 +735,8 @@ void Widget::SetHeight(const Unit unit, const float height) {
 void Widget::SetHidden(const bool hidden) {
   if (hidden != hidden_) {
     hidden_ = hidden;
+    if (real_parent_ != nullptr)
+      real_parent_->MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw();
   }
@@ -645,6 +775,8 @@ void Widget::SetX(const Alignment alignment, const Unit unit, const float x) {
   x_alignment_ = alignment;
   x_unit_ = unit;
   x_value_ = x;
+  if (real_parent_ != nullptr)
+    real_parent_->MarkSubtreeChanged();
   if (widget_view_ != nullptr)
     widget_view_->Redraw(this);
 }
@@ -660,6 +792,8 @@ void Widget::SetY(const Alignment alignment, const Unit unit, const float y) {
   y_alignment_ = alignment;
   y_unit_ = unit;
   y_value_ = y;
+  if (real_parent_ != nullptr)
+    real_parent_->MarkSubtreeChanged();
   if (widget_view_ != nullptr)
     widget_view_->Redraw(this);
 }
@@ -669,7 +803,17 @@ void Widget::SetY(const float y) {
 }
 
 bool Widget::ShouldHandleEvent(const Point location) {
-  return false;
+  return !gesture_recognizers_.empty() && CollidePoint(location, 0);
+}
+
+bool Widget::ShouldRasterizeAgain(const float scale_factor) {
+  if (!rasterizes_after_scaling_)
+    return false;
+
+  const float kRasterScaleFactor = GetRasterScaleFactor();
+  if (raster_scale_ != GetMeasuredScale() && widget_view_ != nullptr)
+    widget_view_->Redraw();
+  return scale_factor != kRasterScaleFactor;
 }
 
 void Widget::SmartRelease(moui::Widget* widget) {
@@ -677,6 +821,8 @@ void Widget::SmartRelease(moui::Widget* widget) {
 }
 
 void Widget::StartAnimation() {
+  if (animation_count_ == 0)
+    MarkSubtreeChanged();
   if (animation_count_++ == 0 && !paused_animation_) {
     if (is_visible_ && widget_view_ != nullptr)
       widget_view_->StartAnimation();
@@ -689,6 +835,8 @@ void Widget::StopAnimation(const bool force) {
   const bool kIsAnimating = IsAnimating();
   animation_count_ = force ? 0 : std::max(0, animation_count_ - 1);
   if (kIsAnimating && animation_count_ == 0) {
+    // The final state of the animation may be rendered without redrawing.
+    MarkSubtreeChanged();
     if (paused_animation_)
       paused_animation_ = false;
     else
@@ -711,6 +859,8 @@ void Widget::set_alpha(const float alpha) {
     return;
 
   alpha_ = revised_alpha;
+  if (real_parent_ != nullptr)
+    real_parent_->MarkSubtreeChanged();
   if (widget_view_ != nullptr)
     widget_view_->Redraw(this);
 }
@@ -725,6 +875,7 @@ void Widget::set_background_color(const NVGcolor background_color) {
 void Widget::set_bottom_padding(const float padding) {
   if (padding != bottom_padding_) {
     bottom_padding_ = padding;
+    MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw(this);
   }
@@ -733,6 +884,7 @@ void Widget::set_bottom_padding(const float padding) {
 void Widget::set_box_sizing(const BoxSizing box_sizing) {
   if (box_sizing != box_sizing_) {
     box_sizing_ = box_sizing;
+    MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw(this);
   }
@@ -741,6 +893,7 @@ void Widget::set_box_sizing(const BoxSizing box_sizing) {
 void Widget::set_left_padding(const float padding) {
   if (padding != left_padding_) {
     left_padding_ = padding;
+    MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw(this);
   }
@@ -780,6 +933,7 @@ void Widget::set_rendering_scale(const float rendering_scale) {
 void Widget::set_right_padding(const float padding) {
   if (padding != right_padding_) {
     right_padding_ = padding;
+    MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw(this);
   }
@@ -789,19 +943,31 @@ void Widget::set_scale(const float scale) {
   if (scale == scale_)
     return;
 
+  // Only changes how the widget is composited. Cached rendering results of
+  // the widget and its descendants are stretched until rendered again.
   scale_ = scale;
   ResetMeasuredScaleRecursively(this);
-  Redraw();
+  if (real_parent_ != nullptr)
+    real_parent_->MarkSubtreeChanged();
+  if (widget_view_ != nullptr)
+    widget_view_->Redraw(this);
 }
 
 void Widget::set_top_padding(const float padding) {
   if (padding != top_padding_) {
     top_padding_ = padding;
+    MarkSubtreeChanged();
     if (widget_view_ != nullptr)
       widget_view_->Redraw(this);
   }
 }
 
+void Widget::set_tracks_hover(const bool tracks_hover) {
+  tracks_hover_ = tracks_hover;
+  if (widget_view_ != nullptr)
+    widget_view_->hover_region_is_valid_ = false;
+}
+
 void Widget::set_widget_view(WidgetView* widget_view) {
   if (widget_view_ == widget_view)
     return;
@@ -812,6 +978,10 @@ void Widget::set_widget_view(WidgetView* widget_view) {
     old_context = widget_view_->context();
   }
   set_is_visible(false);
+  ReleaseAtlasSlot();
+  if (is_layer_ && widget_view_ != nullptr)
+    widget_view_->DemoteLayer(this);
+  number_of_observed_frames_ = 0;
   widget_view_ = widget_view;
 
   if (widget_view == nullptr || widget_view->should_notify_context_change()) {
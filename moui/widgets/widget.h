@@ -24,10 +24,12 @@
 
 #include "moui/base.h"
 #include "moui/nanovg_hook.h"
+#include "moui/widgets/raster_atlas.h"
 
 namespace moui {
 
 class Event;
+class GestureRecognizer;
 class WidgetView;
 
 // The `Widget` class represents a graphical element that can be displayed on
@@ -64,6 +66,11 @@ class Widget {
   // Adds child widget.
   virtual void AddChild(Widget* child);
 
+  // Attaches the passed gesture recognizer to the widget, which takes the
+  // ownership of the recognizer. Widgets with gesture recognizers respond to
+  // events within their bounds by default.
+  void AddGestureRecognizer(GestureRecognizer* recognizer);
+
   // Binds a function or class method for rendering the widget. Calling this
   // method repeatedly will replace the previous binded one.
   //
@@ -117,6 +124,14 @@ class Widget {
   // coordinate system.
   float GetMeasuredScale();
 
+  // Returns the scale factor for rendering cached results of the widget such
+  // as framebuffers, which includes the screen's scale factor. The value
+  // matches the measured scale exactly unless the scale is changing. While
+  // the scale is changing, the value snaps to powers of two and only moves to
+  // another power of two once the measured scale is well past the midpoint
+  // between them, so cached results are not rendered again every frame.
+  float GetRasterScaleFactor();
+
   // Gets the minimum space required to render the enitre widget including the
   // configured horizontal and vertical offsets.
   void GetOccupiedSpace(Size* size) const;
@@ -165,6 +180,11 @@ class Widget {
   // Returns true if the widget is hidden.
   bool IsHidden() const;
 
+  // Returns `true` if the widget and its descendants are currently promoted
+  // to a cached layer by the corresponded widget view. See
+  // `WidgetView::GetLayers()` for details.
+  bool IsLayer() const { return is_layer_; }
+
   // Resets the `default_framebuffer_` and asks the corresponded `widget_view_`
   // to redraw. This widget will actually be drawn immediately if it's
   // currently visible.
@@ -174,9 +194,21 @@ class Widget {
   // chain. Returns `false` on failure.
   bool RemoveFromParent();
 
+  // Detaches and deletes the passed gesture recognizer. Returns `false` if
+  // the recognizer is not attached to the widget.
+  bool RemoveGestureRecognizer(GestureRecognizer* recognizer);
+
   // Returns `true` if the render function is binded.
   bool RenderFunctionIsBinded() const;
 
+  // Renders the widget and all of its descendants to the passed framebuffer,
+  // which is created if `*framebuffer` is `nullptr` and recreated if its size
+  // no longer fits the widget. The widget is rendered even if it is hidden or
+  // not visible on screen. Returns `false` on failure. Widgets can call this
+  // method in `RenderFramebuffer()` to composite another widget's rendering
+  // result without rendering that widget every frame.
+  bool RenderToFramebuffer(NVGframebuffer** framebuffer);
+
   // Resets the context for the widget and its descendants.
   void ResetContext(NVGcontext* context);
 
@@ -222,6 +254,14 @@ class Widget {
   // Sets the vertical position to the parent's origin in points.
   void SetY(const float y);
 
+  // Returns `true` if a cached rendering result rendered at `scale_factor`
+  // should be rendered again at `GetRasterScaleFactor()`. While the scale
+  // keeps changing, another refresh cycle is requested so the result is
+  // rendered again at the exact scale once the scale stops changing. Widgets
+  // caching renderings of their own or of other widgets should check their
+  // caches with this method.
+  bool ShouldRasterizeAgain(const float scale_factor);
+
   // Releases the specified widget and its children if `auto_release_children`
   // is `true`.
   static void SmartRelease(moui::Widget* widget);
@@ -255,13 +295,25 @@ class Widget {
   virtual BoxSizing box_sizing() const { return box_sizing_; }
   virtual void set_box_sizing(const BoxSizing box_sizing);
   std::vector<Widget*>* children() { return &children_; }
+  const std::vector<GestureRecognizer*>* gesture_recognizers() const {
+    return &gesture_recognizers_;
+  }
   virtual float left_padding() const { return left_padding_; }
   virtual void set_left_padding(const float padding);
+  bool is_hovered() const { return is_hovered_; }
   bool is_opaque() const { return is_opaque_; }
   void set_is_opaque(const bool is_opaque) { is_opaque_ = is_opaque; }
   bool is_visible() const { return is_visible_; }
   Widget* parent() const { return parent_; }
   void set_parent(Widget* parent) { parent_ = parent; }
+  bool prefers_layer() const { return prefers_layer_; }
+  void set_prefers_layer(const bool prefers_layer) {
+    prefers_layer_ = prefers_layer;
+  }
+  bool rasterizes_after_scaling() const { return rasterizes_after_scaling_; }
+  void set_rasterizes_after_scaling(const bool value) {
+    rasterizes_after_scaling_ = value;
+  }
   Point rendering_offset() const { return rendering_offset_; }
   void set_rendering_offset(const Point offset);
   float rendering_scale() const { return rendering_scale_; }
@@ -274,6 +326,8 @@ class Widget {
   void set_tag(const int tag) { tag_ = tag; }
   virtual float top_padding() const { return top_padding_; }
   virtual void set_top_padding(const float padding);
+  bool tracks_hover() const { return tracks_hover_; }
+  void set_tracks_hover(const bool tracks_hover);
   WidgetView* widget_view() const { return widget_view_; }
 
  protected:
@@ -318,11 +372,32 @@ class Widget {
   // receive an event, the `ShouldHandleEvent()` method must return `true`.
   // The actual implementation should be done in subclass and the passed event
   // object will be deallocated automatically. If the returned value is
-  // `false`, the event will stop propagating to the next responder.
+  // `false`, the event will stop propagating to the next responder and its
+  // gesture recognizers. By default it returns `true` only if the widget has
+  // gesture recognizers, which then handle the event instead.
   //
   // Note that this method should only be called in the
   // `WidgetView::HandleEvent()` method.
-  virtual bool HandleEvent(Event* event) { return false; }
+  virtual bool HandleEvent(Event* event);
+
+  // This method gets called when the cursor entered, moved over or left the
+  // widget while no button is pressed, which is indicated by the event type
+  // of `Event::Type::kHoverEnter`, `kHoverMove` or `kHoverLeave`. Only widgets
+  // whose `tracks_hover()` is `true` receive hover events, and only the
+  // innermost one under the cursor is hovered at a time.
+  //
+  // Note that this method should only be called by the corresponded widget
+  // view.
+  virtual void HandleHoverEvent(Event* event) {}
+
+  // This method gets called when the widget received an `Event::Type::kScroll`
+  // event. In order to receive scroll events, the `ShouldHandleScrollEvent()`
+  // method must return `true`. Unlike touch events, a scroll event is only
+  // passed to the innermost widget under the cursor that accepts it.
+  //
+  // Note that this method should only be called in the
+  // `WidgetView::HandleEvent()` method.
+  virtual void HandleScrollEvent(Event* event) {}
 
   // Releases the widget ifself and its direct children on demand.
   void ReleaseSelfAndChildrenOnDemand();
@@ -349,10 +424,16 @@ class Widget {
 
   // This method gets called when an event is about to occur. The returned
   // boolean indicates whether the widget should handle the event. By default
-  // it returns `false` and simply ignores any event. This method could be
-  // implemented in the subclass to change the default behavior.
+  // it returns `true` only if the widget has gesture recognizers and the
+  // location is within its bounds. This method could be implemented in the
+  // subclass to change the default behavior.
   virtual bool ShouldHandleEvent(const Point location);
 
+  // Returns `true` if the widget could be scrolled by a scroll event of the
+  // passed delta at the moment. A zero delta asks whether the widget could be
+  // scrolled in any direction. By default it returns `false`.
+  virtual bool ShouldHandleScrollEvent(const Point delta) { return false; }
+
   // This method gets called when the widget itself and all of its child
   // widgets did finish rendering in a refresh cycle. It's a good place to
   // restore the context state if changed in `WidgetWillRender()`. However,
@@ -387,6 +468,7 @@ class Widget {
   virtual void WidgetWillRender(NVGcontext* context) {}
 
  private:
+  friend class RasterAtlas;
   friend class WidgetView;
 
   // Executes either the binded `render_function_` or `Render()` if no render
@@ -394,22 +476,38 @@ class Widget {
   // also fills the background color if the widget is opaque.
   void ExecuteRenderFunction(NVGcontext* context);
 
+  // Returns `true` if the widget's measured scale has changed in the current
+  // refresh cycle of the corresponded widget view.
+  bool IsScaling() const;
+
+  // Marks the widget and all of its ancestors as changed in the current
+  // refresh cycle, which outdates the layers of any of them. This method
+  // should be called whenever the rendering result of the widget's subtree
+  // is changed. Changes that only affect how the widget is composited into
+  // its parent should call this method on `real_parent_` instead.
+  void MarkSubtreeChanged();
+
   // Notifies that the corresponded context has been changed. This method
   // would call `ContextWillChange()` and `ContextDidChange()` on demand.
   void NotifyContextChange(NVGcontext* old_context, NVGcontext* new_context);
 
+  // Releases `atlas_slot_` back to the corresponded widget view's raster
+  // atlas if there is one.
+  void ReleaseAtlasSlot();
+
   // Returns `true` if the passed widget is removed from children. This method
   // is designed for internal use. To remove a child from a parent widget.
   // Calls the child widget's `RemoveFromParent()` method instead.
   bool RemoveChild(Widget* child);
 
-  // Renders `Render()` in `default_framebuffer_` if `caches_rendering_` is
-  // true. Note that this method should only be called by
-  // `WidgetView::RenderWidget()`.
+  // Renders `Render()` in `atlas_slot_` or `default_framebuffer_` if
+  // `caches_rendering_` is true. Rendering in `atlas_slot_` is deferred until
+  // the widget view renders all pending slots of the atlas. Note that this
+  // method should only be called by `WidgetView::RenderWidget()`.
   void RenderDefaultFramebuffer(NVGcontext* context);
 
-  // Either renders `Render()` directly or renders `default_framebuffer_` if
-  // `caches_rendering_` is true.
+  // Either renders `Render()` directly or renders `atlas_slot_` or
+  // `default_framebuffer_` if `caches_rendering_` is true.
   void RenderOnDemand(NVGcontext* context);
 
   // Resets the `measured_scale_` property so the value will be re-calculated
@@ -433,6 +531,12 @@ class Widget {
   // `StopAnimation()`. The widget is animating if this value is greater than 0.
   int animation_count_;
 
+  // The slot in the corresponded widget view's raster atlas holding the
+  // rendering result of `Render()` instead of `default_framebuffer_`. Small
+  // widgets that cache their rendering results use the atlas whenever
+  // possible.
+  RasterAtlas::Slot* atlas_slot_;
+
   // Indicates whether release children when calling `SmartRelease()`.
   // The default value is `false`.
   bool auto_release_children_;
@@ -461,9 +565,16 @@ class Widget {
   // `caches_rendering_` is set to `true`.
   NVGframebuffer* default_framebuffer_;
 
-  // The `NVGpaint` object corresonded to the `default_framebuffer_`.
+  // The `NVGpaint` object corresonded to the `default_framebuffer_` or
+  // `atlas_slot_`.
   NVGpaint default_framebuffer_paint_;
 
+  // The scale factor `default_framebuffer_` or `atlas_slot_` was rendered at.
+  float default_framebuffer_scale_factor_;
+
+  // The strong references to the attached gesture recognizers.
+  std::vector<GestureRecognizer*> gesture_recognizers_;
+
   // The unit of the `height_value_`.
   Unit height_unit_;
 
@@ -473,6 +584,20 @@ class Widget {
   // Indicates whether the widget is hidden.
   bool hidden_;
 
+  // Indicates whether the widget received events of the current touch
+  // sequence and still expects the sequence to end. This value is maintained
+  // by the corresponded widget view.
+  bool is_effective_responder_;
+
+  // Indicates whether the cursor is over the widget. This value is maintained
+  // by the corresponded widget view.
+  bool is_hovered_;
+
+  // Indicates whether the widget and its descendants are rendered in
+  // `layer_framebuffer_` and composited as a whole. This value is maintained
+  // by the corresponded widget view.
+  bool is_layer_;
+
   // Indicates whether the widget is opaque. If `true`, the background color
   // will be filled to the entire bounding rectangle. The default value is
   // `true`.
@@ -481,6 +606,24 @@ class Widget {
   // Indicates if the widget is visible to the corresponded widget view.
   bool is_visible_;
 
+  // The exponential moving average of how often the widget's subtree changes
+  // per refresh cycle, ranging from 0 to 1.
+  float layer_change_frequency_;
+
+  // The framebuffer that holds the rendering result of the widget and its
+  // descendants when `is_layer_` is `true`.
+  NVGframebuffer* layer_framebuffer_;
+
+  // Indicates whether `layer_framebuffer_` should be rendered again.
+  bool layer_is_outdated_;
+
+  // The exponential moving average in seconds of the time taken to render the
+  // widget and its descendants without a layer.
+  double layer_rendering_cost_;
+
+  // The scale factor `layer_framebuffer_` was rendered at.
+  float layer_scale_factor_;
+
   // The padding in points on the left side of the widget.
   float left_padding_;
 
@@ -490,6 +633,14 @@ class Widget {
   // and calling `ResetMeasuredScale()` to reset this value.
   float measured_scale_;
 
+  // The frame number of the corresponded widget view when `measured_scale_`
+  // was reset last time.
+  int measured_scale_frame_number_;
+
+  // The number of refresh cycles the widget has been visible in, which is
+  // capped once enough to make layer decisions.
+  int number_of_observed_frames_;
+
   // Keeps the pointer to the logical parent widget of the current widget. The
   // logical parent can be changed through `set_parent()` in inherited widgets
   // whenever needed.
@@ -499,6 +650,25 @@ class Widget {
   // currently invisible to the corresponded widget view..
   bool paused_animation_;
 
+  // Indicates whether the widget should be promoted to a layer whenever it is
+  // visible regardless of its layer statistics, as long as the memory budget
+  // allows. Changing the position, opacity or scale of a layer only changes
+  // how it is composited, so this is useful for widgets about to be animated
+  // that way. The widget's own animation is assumed to only change these
+  // properties, and `Redraw()` must be called for other changes. The default
+  // value is `false`.
+  bool prefers_layer_;
+
+  // The measured scale cached results of the widget are rendered at. See
+  // `GetRasterScaleFactor()` for details.
+  float raster_scale_;
+
+  // Indicates whether cached rendering results stretched by scale changes are
+  // rendered again at the new scale once the scale stops changing. If
+  // `false`, they are only rendered again on `Redraw()`. The default value is
+  // `true`.
+  bool rasterizes_after_scaling_;
+
   // Keeps the real parent widget of the current widget. Unlike the logical
   // `parent_` property. This value is always pointing to the real parent
   // widget and cannot be changed manually.
@@ -526,6 +696,10 @@ class Widget {
   // Indicates whether the `default_framebuffer_` should be drawn.
   bool should_redraw_default_framebuffer_;
 
+  // Indicates whether the widget or any of its descendants has changed in the
+  // current refresh cycle.
+  bool subtree_did_change_;
+
   // This property can be set to an arbitrary integer and use that number to
   // identify the widget later. The default value is 0.
   int tag_;
@@ -533,6 +707,10 @@ class Widget {
   // The padding in points on the top side of the widget.
   float top_padding_;
 
+  // Indicates whether the widget receives hover events in
+  // `HandleHoverEvent()`. The default value is `false`.
+  bool tracks_hover_;
+
   // The `WidgetView` that manages this widget instance.
   WidgetView* widget_view_;
 
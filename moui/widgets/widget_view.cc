@@ -18,73 +18,210 @@
 #include "moui/widgets/widget_view.h"
 
 #include <algorithm>
+#include <functional>
 #include <stack>
 #include <string>
 #include <vector>
 
+#include "moui/core/clock.h"
 #include "moui/core/device.h"
 #include "moui/core/event.h"
+#include "moui/core/input_recording.h"
 #include "moui/defines.h"
 #include "moui/native/native_view.h"
 #include "moui/nanovg_hook.h"
 #include "moui/ui/view.h"
-#include "moui/widgets/scroll_view.h"
+#include "moui/widgets/gesture_recognizer.h"
 #include "moui/widgets/widget.h"
 
+namespace {
+
+// The default maximum number of bytes taken by all layers.
+const int kDefaultLayerMemoryBudget = 16 * 1024 * 1024;
+// The default duration in seconds to predict touches ahead.
+const double kDefaultTouchPredictionInterval = 1.0 / 60;
+// The weight of the current refresh cycle in the moving averages of layer
+// statistics.
+const float kLayerStatisticsWeight = 0.1;
+// Layers whose subtrees change more often than this per refresh cycle are
+// demoted.
+const float kMaximumLayerChangeFrequency = 0.3;
+// Widgets whose subtrees change more often than this per refresh cycle are
+// not promoted to layers.
+const float kMaximumPromotionChangeFrequency = 0.05;
+// Widgets whose subtrees take less time in seconds than this to render are
+// not worth promoting to layers.
+const double kMinimumLayerRenderingCost = 0.0005;
+// The number of refresh cycles a widget has to be visible in before it can
+// be promoted to a layer.
+const int kMinimumObservedFrames = 30;
+// The duration in seconds the scroll target stays latched since the latest
+// scroll event.
+const double kScrollLatchingDuration = 0.5;
+
+// Narrows the region specified by `minimum` and `maximum` so it no longer
+// overlaps the passed bounds, which do not contain the passed location. The
+// region is cut along one of the bounds' edges between them and the
+// location, and the cut keeping the largest area is chosen.
+void ExcludeBoundsFromRegion(const moui::Point location,
+                             const moui::Point origin, const moui::Size size,
+                             moui::Point* minimum, moui::Point* maximum) {
+  const float kLeft = origin.x;
+  const float kTop = origin.y;
+  const float kRight = origin.x + size.width;
+  const float kBottom = origin.y + size.height;
+  if (size.width <= 0 || size.height <= 0 || kRight <= minimum->x ||
+      kLeft >= maximum->x || kBottom <= minimum->y || kTop >= maximum->y) {
+    return;
+  }
+
+  const moui::Point kCuts[4][2] = {
+      {{kRight, minimum->y}, *maximum},  // the bounds are on the left
+      {*minimum, {kLeft, maximum->y}},  // the bounds are on the right
+      {{minimum->x, kBottom}, *maximum},  // the bounds are above
+      {*minimum, {maximum->x, kTop}},  // the bounds are below
+  };
+  const bool kCutIsAvailable[4] = {kRight <= location.x, kLeft > location.x,
+                                   kBottom <= location.y, kTop > location.y};
+  int chosen_cut = -1;
+  float largest_area = -1;
+  for (int i = 0; i < 4; ++i) {
+    const float kArea = (kCuts[i][1].x - kCuts[i][0].x) *
+                        (kCuts[i][1].y - kCuts[i][0].y);
+    if (kCutIsAvailable[i] && kArea > largest_area) {
+      chosen_cut = i;
+      largest_area = kArea;
+    }
+  }
+  // Empties the region if the bounds contain the location after all.
+  if (chosen_cut < 0) {
+    *maximum = *minimum;
+    return;
+  }
+  *minimum = kCuts[chosen_cut][0];
+  *maximum = kCuts[chosen_cut][1];
+}
+
+}  // namespace
+
 namespace moui {
 
 WidgetView::WidgetView(const int context_flags)
-    : context_(nullptr), context_flags_(context_flags), is_ready_(false),
-      preparing_for_rendering_(false), requests_redraw_(false),
-      root_widget_(new Widget) {
+    : context_(nullptr), context_flags_(context_flags), frame_number_(0),
+      handling_event_timestamp_(-1), hover_location_({0, 0}),
+      hover_region_is_valid_(false), hover_region_maximum_({0, 0}),
+      hover_region_minimum_({0, 0}), hovered_widget_(nullptr),
+      input_recording_(nullptr), is_hovering_(false), is_ready_(false),
+      layer_memory_budget_(kDefaultLayerMemoryBudget),
+      number_of_hover_tests_(0), number_of_responder_chain_updates_(0),
+      number_of_scroll_target_updates_(0), pending_move_event_(nullptr),
+      predicts_touches_(false), preparing_for_rendering_(false),
+      rasterizing_layer_(nullptr), requests_redraw_(false),
+      responder_chain_is_frozen_(false), root_widget_(new Widget),
+      scroll_gesture_is_ongoing_(false), scroll_target_(nullptr),
+      scroll_target_is_committed_(false), scroll_target_timestamp_(0),
+      submitted_event_timestamp_(-1),
+      touch_prediction_interval_(kDefaultTouchPredictionInterval),
+      unrendered_event_timestamp_(-1) {
 #ifdef MOUI_ANDROID
   should_notify_context_change_ = false;
 #else
   should_notify_context_change_ = true;
 #endif  // MOUI_ANDROID
   root_widget_->set_widget_view(this);
+  for (PointerPredictor& touch_predictor : touch_predictors_)
+    ReleaseTouchPredictor(&touch_predictor);
+  gesture_arena_.set_resolution_callback(
+      std::bind(&WidgetView::CancelEventResponders, this,
+                std::placeholders::_1));
 }
 
 WidgetView::WidgetView() : WidgetView(nvgContextFlags(true, true, 3)) {
 }
 
 WidgetView::~WidgetView() {
+  delete pending_move_event_;
+  for (Event* event : reusable_events_)
+    delete event;
+  while (!layers_.empty())
+    DemoteLayer(layers_.back());
   moui::Widget::SmartRelease(root_widget_);
+  raster_atlas_.Clear();
   if (context_ != nullptr)
     nvgDeleteContext(context_);
 }
 
-void WidgetView::HandleEvent(Event* event) {
+// Iterates by index because responders could be removed while handling the
+// `cancel` event.
+void WidgetView::CancelEventResponders(GestureRecognizer* winner) {
+  Event* cancel_event = DequeueReusableEvent(Event::Type::kCancel,
+                                             Clock::GetTimestamp());
+  *(cancel_event->locations()) = *(winner->locations());
+  for (int i = 0; i < static_cast<int>(effective_event_responders_.size());
+       ++i) {
+    Widget* responder = effective_event_responders_[i];
+    if (responder == nullptr || responder == winner->widget())
+      continue;
+    effective_event_responders_[i] = nullptr;
+    responder->is_effective_responder_ = false;
+    responder->HandleEvent(cancel_event);
+  }
+  RecycleEvent(cancel_event);
+}
+
+void WidgetView::DemoteLayer(Widget* widget) {
+  auto match = std::find(layers_.begin(), layers_.end(), widget);
+  if (match == layers_.end())
+    return;
+
+  layers_.erase(match);
+  widget->is_layer_ = false;
+  widget->layer_is_outdated_ = false;
+  nvgDeleteFramebuffer(widget->layer_framebuffer_);
+  widget->layer_framebuffer_ = nullptr;
+}
+
+Event* WidgetView::DequeueReusableEvent(const Event::Type type,
+                                       const double timestamp) {
+  if (reusable_events_.empty())
+    return new Event(type, timestamp);
+  Event* event = reusable_events_.back();
+  reusable_events_.pop_back();
+  event->Reset(type, timestamp);
+  return event;
+}
+
+void WidgetView::DidPresentFrame(const double timestamp) {
+  if (submitted_event_timestamp_ < 0)
+    return;
+  input_to_present_latency_.AddSample(timestamp - submitted_event_timestamp_);
+  submitted_event_timestamp_ = -1;
+}
+
+void WidgetView::DispatchEvent(Event* event) {
+  PredictTouches(event);
   const bool kEventTypeIsUpOrCancel = event->type() == Event::Type::kUp ||
                                       event->type() == Event::Type::kCancel;
+  if (event->type() == Event::Type::kDown)
+    responder_chain_is_frozen_ = true;
 
-  bool scroll_view_horizontal_scrolling_is_acceptable = true;
-  bool scroll_view_vertical_scrolling_is_acceptable = true;
-
-  for (Widget* responder : event_responders_) {
-    // Determines if the responder is a instance of the `ScrollView` class.
-    const bool kResponderIsScrollView = \
-        dynamic_cast<ScrollView*>(responder) != nullptr;
-    // Skips the current scroll view responder if its acceptable scrolling
-    // directions are already handled by another scroll view responder.
-    if (kResponderIsScrollView) {
-      auto scroll_view = reinterpret_cast<ScrollView*>(responder);
-      if ((!scroll_view_horizontal_scrolling_is_acceptable &&
-           scroll_view->HorizontalScrollingIsAcceptable()) ||
-          (!scroll_view_vertical_scrolling_is_acceptable &&
-           scroll_view->VerticalScrollingIsAcceptable())) {
-        continue;
-      }
-    }
+  // Iterates by index because responders could be removed while handling
+  // the event.
+  for (int i = 0; i < static_cast<int>(event_responders_.size()); ++i) {
+    Widget* responder = event_responders_[i];
+    if (responder == nullptr)
+      continue;
+    gesture_arena_.HandleEvent(event, responder);
+    // Skips the responders cancelled by the winner of the gesture arena.
+    const GestureRecognizer* kWinner = gesture_arena_.winner();
+    if (kWinner != nullptr && kWinner->widget() != responder)
+      continue;
 
     // Updates `effective_event_responders_` for the current responder.
-    auto match = std::find(effective_event_responders_.begin(),
-                           effective_event_responders_.end(), responder);
-    const bool kIsEffective = match != effective_event_responders_.end();
     if (kEventTypeIsUpOrCancel) {
-      if (kIsEffective)
-        effective_event_responders_.erase(match);
-    } else if (!kIsEffective) {
+      responder->is_effective_responder_ = false;
+    } else if (!responder->is_effective_responder_) {
+      responder->is_effective_responder_ = true;
       effective_event_responders_.push_back(responder);
     }
 
@@ -94,44 +231,197 @@ void WidgetView::HandleEvent(Event* event) {
     if (!kPropagatesEvent) {
       break;
     }
-
-    // Marks the scrolling directions of the current scroll view responder
-    // no longer acceptable.
-    if (kResponderIsScrollView) {
-      auto scroll_view = reinterpret_cast<ScrollView*>(responder);
-      if (scroll_view->HorizontalScrollingIsAcceptable())
-        scroll_view_horizontal_scrolling_is_acceptable = false;
-      if (scroll_view->VerticalScrollingIsAcceptable())
-        scroll_view_vertical_scrolling_is_acceptable = false;
-    }
   }
 
+  if (!kEventTypeIsUpOrCancel)
+    return;
+  responder_chain_is_frozen_ = false;
+  gesture_arena_.Clear();
+
   // Sends a `cancel` event to all effective responders that does not handle
   // the `up` or `cancel` event.
-  if (!kEventTypeIsUpOrCancel || effective_event_responders_.empty()) {
+  if (effective_event_responders_.empty())
     return;
-  }
   // Creates a `cancel` event if the received one is not.
-  Event* cancel_event;
-  bool creates_cancel_event = false;
-  if (event->type() == Event::Type::kCancel) {
-    cancel_event = event;
-  } else {
-    creates_cancel_event = true;
-    cancel_event = new Event(Event::Type::kCancel);
-    for (Point location : *(event->locations()))
-      cancel_event->locations()->push_back(location);
+  Event* cancel_event = event;
+  if (event->type() != Event::Type::kCancel) {
+    cancel_event = DequeueReusableEvent(Event::Type::kCancel,
+                                        event->timestamp());
+    *(cancel_event->locations()) = *(event->locations());
+    *(cancel_event->pointer_ids()) = *(event->pointer_ids());
   }
   for (Widget* responder : effective_event_responders_) {
+    if (responder == nullptr || !responder->is_effective_responder_)
+      continue;
+    responder->is_effective_responder_ = false;
     responder->HandleEvent(cancel_event);
   }
-  if (creates_cancel_event)
-    delete cancel_event;
+  if (cancel_event != event)
+    RecycleEvent(cancel_event);
   effective_event_responders_.clear();
 }
 
+void WidgetView::DispatchHoverEvent(Event* event) {
+  if (event->type() == Event::Type::kHoverLeave) {
+    is_hovering_ = false;
+    SetHoveredWidget(nullptr, hover_location_, event->timestamp());
+    return;
+  }
+  if (event->locations()->empty())
+    return;
+  Widget* hovered_widget = hovered_widget_;
+  UpdateHoveredWidget(event->locations()->front(), event->timestamp());
+  // Moves within the same hovered widget are passed along as is.
+  if (event->type() == Event::Type::kHoverMove &&
+      hovered_widget_ != nullptr && hovered_widget_ == hovered_widget) {
+    hovered_widget_->HandleHoverEvent(event);
+  }
+}
+
+void WidgetView::DispatchPendingMoveEvent() {
+  if (pending_move_event_ == nullptr)
+    return;
+  // Resets `pending_move_event_` first so moves received while dispatching
+  // are coalesced into a new event.
+  Event* event = pending_move_event_;
+  pending_move_event_ = nullptr;
+  DispatchEvent(event);
+  RecycleEvent(event);
+}
+
+void WidgetView::DispatchScrollEvent(Event* event) {
+  if (event->locations()->empty())
+    return;
+  const Point kLocation = event->locations()->front();
+  const Point kDelta = event->scroll_delta();
+  const Event::ScrollPhase kPhase = event->scroll_phase();
+  // A new trackpad gesture is only latched to the previous target if the
+  // cursor is still over it.
+  if (kPhase == Event::ScrollPhase::kBegan)
+    scroll_gesture_is_ongoing_ = false;
+  if (!ScrollTargetIsLatched(kLocation, kDelta, event->timestamp())) {
+    scroll_target_ = FindScrollTarget(kLocation, kDelta, root_widget_);
+    scroll_target_is_committed_ = false;
+    ++number_of_scroll_target_updates_;
+  }
+  scroll_gesture_is_ongoing_ = kPhase != Event::ScrollPhase::kNone &&
+                               kPhase != Event::ScrollPhase::kMomentumEnded;
+  if (!scroll_gesture_is_ongoing_)
+    scroll_target_is_committed_ = false;
+  else if (kDelta.x != 0 || kDelta.y != 0)
+    scroll_target_is_committed_ = true;
+  scroll_target_timestamp_ = event->timestamp();
+  if (scroll_target_ != nullptr)
+    scroll_target_->HandleScrollEvent(event);
+}
+
+// Only the topmost visible child under the location is walked into. The
+// region is narrowed to the bounds of that child since the cursor leaving it
+// exposes the widgets below, and the children above it are excluded from the
+// region since the cursor moving into them changes the hovered widget.
+Widget* WidgetView::FindHoveredWidget(const Point location, Widget* widget,
+                                      Point* region_minimum,
+                                      Point* region_maximum) {
+  Widget* hovered_widget = nullptr;
+  for (auto it = widget->children()->rbegin();
+       it != widget->children()->rend(); it++) {
+    Widget* child = *it;
+    if (child->IsHidden())
+      continue;
+    Point origin;
+    Size size;
+    child->GetMeasuredBounds(&origin, &size);
+    if (location.x < origin.x || location.y < origin.y ||
+        location.x >= origin.x + size.width ||
+        location.y >= origin.y + size.height) {
+      ExcludeBoundsFromRegion(location, origin, size, region_minimum,
+                              region_maximum);
+      continue;
+    }
+    region_minimum->x = std::max(region_minimum->x, origin.x);
+    region_minimum->y = std::max(region_minimum->y, origin.y);
+    region_maximum->x = std::min(region_maximum->x, origin.x + size.width);
+    region_maximum->y = std::min(region_maximum->y, origin.y + size.height);
+    hovered_widget = FindHoveredWidget(location, child, region_minimum,
+                                       region_maximum);
+    break;
+  }
+  if (hovered_widget == nullptr && widget->tracks_hover_)
+    hovered_widget = widget;
+  return hovered_widget;
+}
+
+// Only the topmost visible child under the location is walked into, since
+// children are clipped by their parents.
+Widget* WidgetView::FindScrollTarget(const Point location, const Point delta,
+                                     Widget* widget) {
+  Widget* target = nullptr;
+  for (auto it = widget->children()->rbegin();
+       it != widget->children()->rend(); it++) {
+    Widget* child = *it;
+    if (child->IsHidden() || !child->CollidePoint(location, 0))
+      continue;
+    target = FindScrollTarget(location, delta, child);
+    break;
+  }
+  if (target == nullptr && widget->ShouldHandleScrollEvent(delta))
+    target = widget;
+  return target;
+}
+
+int WidgetView::GetLayerBytes(Widget* widget) const {
+  const float kScaleFactor = widget->GetRasterScaleFactor();
+  return static_cast<int>(widget->GetWidth() * kScaleFactor) *
+         static_cast<int>(widget->GetHeight() * kScaleFactor) * 4;
+}
+
+int WidgetView::GetLayerMemoryUsage() const {
+  int usage = 0;
+  for (Widget* widget : layers_)
+    usage += GetLayerBytes(widget);
+  return usage;
+}
+
+void WidgetView::GetLayers(std::vector<LayerInfo>* layers) const {
+  layers->clear();
+  for (Widget* widget : layers_) {
+    layers->push_back({widget, GetLayerBytes(widget),
+                       widget->layer_change_frequency_,
+                       widget->layer_rendering_cost_, widget->is_visible()});
+  }
+}
+
+void WidgetView::HandleEvent(Event* event) {
+  if (input_recording_ != nullptr)
+    input_recording_->RecordEvent(event);
+  // Frames redrawn because of the event are tagged with its timestamp.
+  handling_event_timestamp_ = event->timestamp();
+  if (event->type() == Event::Type::kScroll) {
+    DispatchScrollEvent(event);
+  } else if (event->type() == Event::Type::kHoverEnter ||
+             event->type() == Event::Type::kHoverMove ||
+             event->type() == Event::Type::kHoverLeave) {
+    DispatchHoverEvent(event);
+  } else if (event->type() == Event::Type::kMove) {
+    if (pending_move_event_ == nullptr) {
+      pending_move_event_ = DequeueReusableEvent(Event::Type::kMove,
+                                                 event->timestamp());
+    }
+    pending_move_event_->Coalesce(*event);
+    Redraw();
+  } else {
+    DispatchPendingMoveEvent();
+    DispatchEvent(event);
+  }
+  handling_event_timestamp_ = -1;
+}
+
 void WidgetView::HandleMemoryWarning() {
+  while (!layers_.empty())
+    DemoteLayer(layers_.back());
   HandleMemoryWarningRecursively(root_widget_);
+  // Deletes the atlas pages no longer holding any slot.
+  raster_atlas_.Compact();
 }
 
 void WidgetView::HandleMemoryWarningRecursively(moui::Widget* widget) {
@@ -145,6 +435,7 @@ void WidgetView::OnSurfaceDestroyed() {
     return;
 
   SetWidgetContextRecursively(root_widget_, context_, nullptr);
+  raster_atlas_.Clear();
   nvgDeleteContext(context_);
   context_ = nullptr;
 }
@@ -157,7 +448,12 @@ void WidgetView::PopAndFinalizeWidgetItems(const int level,
       break;
 
     stack->pop();
-    top_item->widget->WidgetDidRender(context_);
+    // A composited layer's widgets already finished rendering in its
+    // framebuffer.
+    if (!top_item->composites_layer)
+      top_item->widget->WidgetDidRender(context_);
+    if (top_item->parent_item != nullptr)
+      top_item->parent_item->rendering_cost += top_item->rendering_cost;
     reusable_widget_items_.push(top_item);
     nvgRestore(context_);
   }
@@ -172,8 +468,11 @@ void WidgetView::PopulateWidgetList(const int level, const float scale,
   static float widget_view_width;
   static float widget_view_height;
   if (level == 0) {
-    widget_view_width = GetWidth();
-    widget_view_height = GetHeight();
+    // Widgets rendered offscreen are only bounded by themselves.
+    widget_view_width = \
+        widget == root_widget_ ? GetWidth() : widget->GetWidth();
+    widget_view_height = \
+        widget == root_widget_ ? GetHeight() : widget->GetHeight();
   } else if (widget->IsHidden()) {
     return SetWidgetAndDescendantsInvisible(widget);
   }
@@ -201,7 +500,8 @@ void WidgetView::PopulateWidgetList(const int level, const float scale,
   item->scissor_width = kScaledWidgetWidth;
   item->scissor_height = kScaledWidgetHeight;
   if (parent_item == nullptr) {
-    item->alpha = widget->alpha();
+    // A layer's own opacity is applied when compositing the layer.
+    item->alpha = widget == rasterizing_layer_ ? 1 : widget->alpha();
   } else {
     item->translated_origin.x = parent_item->translated_origin.x
                                 + item->origin.x * scale;
@@ -255,6 +555,19 @@ void WidgetView::PopulateWidgetList(const int level, const float scale,
   item->widget = widget;
   item->level = level;
   item->parent_item = parent_item;
+  item->layer_item = parent_item == nullptr ? nullptr : parent_item->layer_item;
+  if (item->layer_item == nullptr && level > 0 &&
+      rasterizing_layer_ == nullptr &&
+      (widget->is_layer_ || (widget->prefers_layer_ && PromoteLayer(widget)))) {
+    item->layer_item = item;
+  }
+  item->composites_layer = false;
+  item->rasterizes_layer = false;
+  item->rendering_cost = 0;
+  // Animating widgets may change without redrawing, except that widgets
+  // preferring layers are assumed to only animate how they are composited.
+  if (widget->IsAnimating() && !widget->prefers_layer_)
+    widget->MarkSubtreeChanged();
   reusable_widget_items_.pop();
   widget_list->push_back(item);
   for (Widget* child : *(widget->children())) {
@@ -267,7 +580,104 @@ void WidgetView::PopulateWidgetList(const int level, const float scale,
   }
 }
 
+// Each pointer keeps its predictor for as long as it is down, so another
+// pointer going down or up does not discard its samples.
+void WidgetView::PredictTouches(Event* event) {
+  if (!predicts_touches_)
+    return;
+
+  const int kNumberOfLocations = static_cast<int>(event->locations()->size());
+  // Releases the predictors of the pointers that are no longer down.
+  for (PointerPredictor& touch_predictor : touch_predictors_) {
+    if (!touch_predictor.is_assigned)
+      continue;
+    bool is_present = false;
+    for (int i = 0; i < kNumberOfLocations && !is_present; ++i)
+      is_present = event->GetPointerId(i) == touch_predictor.pointer_id;
+    if (!is_present ||
+        (touch_predictor.is_lifted && event->type() == Event::Type::kDown)) {
+      ReleaseTouchPredictor(&touch_predictor);
+    }
+    touch_predictor.is_lifted = false;
+  }
+
+  const bool kIsLifting = event->type() == Event::Type::kUp ||
+                          event->type() == Event::Type::kCancel;
+  const double kTargetTimestamp = \
+      Clock::GetTimestamp() + touch_prediction_interval_;
+  for (int i = 0; i < kNumberOfLocations; ++i) {
+    const int kPointerId = event->GetPointerId(i);
+    PointerPredictor* free_predictor = nullptr;
+    PointerPredictor* touch_predictor = nullptr;
+    for (PointerPredictor& candidate : touch_predictors_) {
+      if (!candidate.is_assigned) {
+        if (free_predictor == nullptr)
+          free_predictor = &candidate;
+      } else if (candidate.pointer_id == kPointerId) {
+        touch_predictor = &candidate;
+        break;
+      }
+    }
+    if (touch_predictor == nullptr && free_predictor != nullptr) {
+      touch_predictor = free_predictor;
+      touch_predictor->pointer_id = kPointerId;
+      touch_predictor->is_assigned = true;
+    }
+
+    Point location = event->locations()->at(i);
+    if (touch_predictor != nullptr) {
+      prediction_samples_.clear();
+      event->GetSamples(kPointerId, &prediction_samples_);
+      for (const Event::Sample& sample : prediction_samples_)
+        touch_predictor->predictor.AddSample(sample.location, sample.timestamp);
+      touch_predictor->predictor.Predict(kTargetTimestamp, &location);
+      touch_predictor->is_lifted = kIsLifting;
+    }
+    event->predicted_locations()->push_back(location);
+  }
+}
+
+bool WidgetView::PromoteLayer(Widget* widget) {
+  const int kBytes = GetLayerBytes(widget);
+  if (kBytes <= 0 || kBytes > layer_memory_budget_)
+    return false;
+
+  int usage = GetLayerMemoryUsage();
+  for (int index = 0; index < static_cast<int>(layers_.size()) &&
+                      usage + kBytes > layer_memory_budget_;) {
+    Widget* layer = layers_[index];
+    if (layer->is_visible()) {
+      ++index;
+      continue;
+    }
+    usage -= GetLayerBytes(layer);
+    DemoteLayer(layer);
+  }
+  if (usage + kBytes > layer_memory_budget_)
+    return false;
+
+  layers_.push_back(widget);
+  widget->is_layer_ = true;
+  widget->layer_is_outdated_ = true;
+  return true;
+}
+
+void WidgetView::RecycleEvent(Event* event) {
+  reusable_events_.push_back(event);
+}
+
+void WidgetView::ReleaseTouchPredictor(PointerPredictor* touch_predictor) {
+  touch_predictor->predictor.Reset();
+  touch_predictor->is_assigned = false;
+  touch_predictor->is_lifted = false;
+}
+
 void WidgetView::Redraw() {
+  if (handling_event_timestamp_ >= 0 &&
+      (unrendered_event_timestamp_ < 0 ||
+       handling_event_timestamp_ < unrendered_event_timestamp_)) {
+    unrendered_event_timestamp_ = handling_event_timestamp_;
+  }
   if (!IsAnimating() && preparing_for_rendering_) {
     requests_redraw_ = true;
   } else {
@@ -283,27 +693,54 @@ void WidgetView::Redraw(Widget* widget) {
   }
 }
 
+// Replaces the widget by `nullptr` instead of erasing it so the indexes of
+// other responders stay the same while dispatching events.
 void WidgetView::RemoveResponder(Widget* widget) {
-  for (auto iterator = event_responders_.begin();
-       iterator != event_responders_.end();
-       ++iterator) {
-    if (*iterator == widget) {
-      event_responders_.erase(iterator);
-      break;
-    }
+  std::replace(event_responders_.begin(), event_responders_.end(), widget,
+               static_cast<Widget*>(nullptr));
+  if (widget->is_effective_responder_) {
+    std::replace(effective_event_responders_.begin(),
+                 effective_event_responders_.end(), widget,
+                 static_cast<Widget*>(nullptr));
   }
-  for (auto iterator = effective_event_responders_.begin();
-       iterator != effective_event_responders_.end();
-       ++iterator) {
-    if (*iterator == widget) {
-      effective_event_responders_.erase(iterator);
-      break;
-    }
+  widget->is_effective_responder_ = false;
+  for (GestureRecognizer* recognizer : widget->gesture_recognizers_)
+    gesture_arena_.Remove(recognizer);
+  if (scroll_target_ == widget)
+    scroll_target_ = nullptr;
+  if (hovered_widget_ == widget) {
+    hovered_widget_ = nullptr;
+    hover_region_is_valid_ = false;
   }
+  widget->is_hovered_ = false;
 }
 
 bool WidgetView::Render() {
-  return Render(root_widget_, nullptr);
+  const double kEventTimestamp = unrendered_event_timestamp_;
+  unrendered_event_timestamp_ = -1;
+  const double kRenderTimestamp = Clock::GetTimestamp();
+
+  DispatchPendingMoveEvent();
+  const bool kResult = Render(root_widget_, nullptr);
+  // Widgets may have moved under the cursor without the cursor moving.
+  if (is_hovering_ && !hover_region_is_valid_)
+    UpdateHoveredWidget(hover_location_, Clock::GetTimestamp());
+  if (kEventTimestamp < 0)
+    return kResult;
+  // Keeps the tag for the next frame if nothing was rendered.
+  if (!kResult) {
+    if (unrendered_event_timestamp_ < 0 ||
+        kEventTimestamp < unrendered_event_timestamp_) {
+      unrendered_event_timestamp_ = kEventTimestamp;
+    }
+    return false;
+  }
+  // Both samples are only added for rendered frames so an event tagging
+  // several attempts is measured once.
+  input_to_render_latency_.AddSample(kRenderTimestamp - kEventTimestamp);
+  input_to_submit_latency_.AddSample(Clock::GetTimestamp() - kEventTimestamp);
+  submitted_event_timestamp_ = kEventTimestamp;
+  return true;
 }
 
 bool WidgetView::Render(Widget* widget, NVGframebuffer* framebuffer) {
@@ -316,13 +753,18 @@ bool WidgetView::Render(Widget* widget, NVGframebuffer* framebuffer) {
 
   preparing_for_rendering_ = true;
   NVGcontext* context = this->context();
-  visible_widgets_.clear();
+  // Widgets rendered offscreen during a refresh cycle are added to the ones
+  // visible on screen.
+  if (widget == root_widget_)
+    visible_widgets_.clear();
 
   // Determines widgets to render in order and filters invisible onces.
   requests_redraw_ = true;
   int count = 0;
-  const float kScreenScaleFactor = \
-      Device::GetScreenScaleFactor() * widget->GetMeasuredScale();
+  // Widgets rendered offscreen match the size of their framebuffers.
+  const float kScreenScaleFactor = framebuffer == nullptr ?
+      Device::GetScreenScaleFactor() * widget->GetMeasuredScale() :
+      widget->GetRasterScaleFactor();
   while (requests_redraw_) {
     if (++count == 1000) {
 #ifdef DEBUG
@@ -339,16 +781,44 @@ bool WidgetView::Render(Widget* widget, NVGframebuffer* framebuffer) {
   }
   preparing_for_rendering_ = false;
   std::vector<WidgetItem*> widget_list;
-  PopulateWidgetList(0, widget->GetMeasuredScale(), &widget_list, widget,
-                     nullptr);
+  // The scale of a widget rendered offscreen is already reflected in the
+  // framebuffer's size so it is not applied again.
+  PopulateWidgetList(0, framebuffer == nullptr ? widget->GetMeasuredScale() :
+                                                 1 / widget->scale(),
+                     &widget_list, widget, nullptr);
 
   // Renders offscreen stuff here so it won't interfere the onscreen rendering.
+  // Outdated layers are rendered along with their descendants at this point,
+  // and the descendants of other layers are skipped.
   if (framebuffer != nullptr)
     nvgBindFramebuffer(NULL);
   for (WidgetItem* item : widget_list) {
-    item->widget->RenderFramebuffer(context);
-    item->widget->RenderDefaultFramebuffer(context);
+    if (item->layer_item != nullptr && item->layer_item != item &&
+        item->layer_item->composites_layer) {
+      continue;
+    }
+    const double kStartTimestamp = Clock::GetTimestamp();
+    Widget* layer = item->layer_item == item ? item->widget : nullptr;
+    if (layer == nullptr) {
+      item->widget->RenderFramebuffer(context);
+      item->widget->RenderDefaultFramebuffer(context);
+    } else if (layer->layer_is_outdated_ ||
+               layer->layer_framebuffer_ == nullptr ||
+               layer->ShouldRasterizeAgain(layer->layer_scale_factor_)) {
+      layer->layer_is_outdated_ = false;
+      layer->layer_scale_factor_ = layer->GetRasterScaleFactor();
+      rasterizing_layer_ = layer;
+      item->composites_layer = \
+          layer->RenderToFramebuffer(&layer->layer_framebuffer_);
+      rasterizing_layer_ = nullptr;
+      item->rasterizes_layer = true;
+    } else {
+      item->composites_layer = true;
+    }
+    item->rendering_cost = Clock::GetTimestamp() - kStartTimestamp;
   }
+  // Renders the atlas slots requested above in as few passes as possible.
+  raster_atlas_.RenderPendingSlots(context);
   if (framebuffer != nullptr)
     nvgBindFramebuffer(framebuffer);
 
@@ -377,20 +847,45 @@ bool WidgetView::Render(Widget* widget, NVGframebuffer* framebuffer) {
   nvgBeginFrame(context, kWidth , kHeight, kScreenScaleFactor);
   WidgetItemStack rendering_stack;
   for (WidgetItem* item : widget_list) {
+    if (item->layer_item != nullptr && item->layer_item != item &&
+        item->layer_item->composites_layer) {
+      reusable_widget_items_.push(item);
+      continue;
+    }
     PopAndFinalizeWidgetItems(item->level, &rendering_stack);
     rendering_stack.push(item);
+    const double kStartTimestamp = Clock::GetTimestamp();
+    const float kScale = (item->level == 0 && framebuffer != nullptr) ?
+                         1 : item->widget->scale();
     nvgSave(context);
     nvgGlobalAlpha(context, item->alpha);
     nvgTranslate(context, item->origin.x, item->origin.y);
-    nvgScale(context, item->widget->scale(), item->widget->scale());
+    nvgScale(context, kScale, kScale);
     nvgIntersectScissor(context, 0, 0, item->width, item->height);
-    item->widget->WidgetWillRender(context);
-    nvgSave(context);
-    item->widget->RenderOnDemand(context);
-    nvgRestore(context);
+    if (item->composites_layer) {
+      nvgBeginPath(context);
+      nvgRect(context, 0, 0, item->width, item->height);
+      nvgFillPaint(context, nvgImagePattern(
+          context, 0, 0, item->width, item->height, 0,
+          item->widget->layer_framebuffer_->image, 1));
+      nvgFill(context);
+    } else {
+      item->widget->WidgetWillRender(context);
+      nvgSave(context);
+      item->widget->RenderOnDemand(context);
+      nvgRestore(context);
+    }
+    item->rendering_cost += Clock::GetTimestamp() - kStartTimestamp;
   }
   PopAndFinalizeWidgetItems(0, &rendering_stack);
   nvgEndFrame(context);
+  if (widget == root_widget_ && framebuffer == nullptr) {
+    UpdateLayers(widget_list);
+    // Outdated atlas slots are allocated again in the next refresh cycle.
+    if (raster_atlas_.Compact())
+      Redraw();
+    ++frame_number_;
+  }
 
   // Notifies all attached widgets that the rendering process is done.
   WidgetViewDidRender(widget);
@@ -405,6 +900,29 @@ void WidgetView::ResetContext() {
   root_widget_->ResetContext(context_);
 }
 
+void WidgetView::ResetLatencyHistograms() {
+  input_to_present_latency_.Reset();
+  input_to_render_latency_.Reset();
+  input_to_submit_latency_.Reset();
+}
+
+// A committed target keeps the gesture even if later deltas turn to the
+// direction it cannot scroll, so the gesture never jumps between targets.
+bool WidgetView::ScrollTargetIsLatched(const Point location, const Point delta,
+                                       const double timestamp) const {
+  Point tested_delta = delta;
+  if (scroll_gesture_is_ongoing_ && scroll_target_is_committed_)
+    tested_delta = {0, 0};
+  if (scroll_target_ == nullptr ||
+      timestamp - scroll_target_timestamp_ > kScrollLatchingDuration ||
+      !scroll_target_->is_visible() ||
+      !scroll_target_->ShouldHandleScrollEvent(tested_delta)) {
+    return false;
+  }
+  return scroll_gesture_is_ongoing_ ||
+         scroll_target_->CollidePoint(location, 0);
+}
+
 void WidgetView::SetBounds(const float x, const float y, const float width,
                            const float height) {
   NativeView::SetBounds(x, y, width, height);
@@ -412,6 +930,28 @@ void WidgetView::SetBounds(const float x, const float y, const float width,
   Redraw();
 }
 
+void WidgetView::SetHoveredWidget(Widget* widget, const Point location,
+                                  const double timestamp) {
+  if (widget == hovered_widget_)
+    return;
+  Widget* previous_widget = hovered_widget_;
+  hovered_widget_ = widget;
+  Event* event = DequeueReusableEvent(Event::Type::kHoverLeave, timestamp);
+  event->locations()->push_back(location);
+  if (previous_widget != nullptr) {
+    previous_widget->is_hovered_ = false;
+    previous_widget->HandleHoverEvent(event);
+  }
+  // The widget may be removed while the previous one handles the event.
+  if (widget != nullptr && hovered_widget_ == widget) {
+    widget->is_hovered_ = true;
+    event->Reset(Event::Type::kHoverEnter, timestamp);
+    event->locations()->push_back(location);
+    widget->HandleHoverEvent(event);
+  }
+  RecycleEvent(event);
+}
+
 void WidgetView::SetWidgetAndDescendantsInvisible(Widget* widget) {
   widget->set_is_visible(false);
   for (Widget* child : *widget->children())
@@ -427,16 +967,41 @@ void WidgetView::SetWidgetContextRecursively(Widget* widget,
 }
 
 bool WidgetView::ShouldHandleEvent(const Point location) {
+  if (input_recording_ != nullptr)
+    input_recording_->RecordHitTest(location, Clock::GetTimestamp());
+  // Platforms may ask again in the middle of a touch sequence such as when
+  // another pointer touches down. The frozen responder chain keeps handling
+  // the sequence.
+  if (responder_chain_is_frozen_)
+    return true;
+  // Moves of the previous touch sequence belong to the previous responders.
+  DispatchPendingMoveEvent();
   UpdateEventResponders(location, nullptr);
   return !event_responders_.empty();
 }
 
+// The resolved target is latched for the scroll event about to occur.
+bool WidgetView::ShouldHandleScrollEvent(const Point location,
+                                         const Point delta) {
+  const double kTimestamp = Clock::GetTimestamp();
+  if (!ScrollTargetIsLatched(location, delta, kTimestamp)) {
+    scroll_gesture_is_ongoing_ = false;
+    scroll_target_ = FindScrollTarget(location, delta, root_widget_);
+    scroll_target_is_committed_ = false;
+    scroll_target_timestamp_ = kTimestamp;
+    ++number_of_scroll_target_updates_;
+  }
+  return scroll_target_ != nullptr;
+}
+
 // Iterates children widgets of the specified widget in reversed order to find
 // the event responder recursively.
 bool WidgetView::UpdateEventResponders(const Point location, Widget* widget) {
   if (widget == nullptr) {
     widget = root_widget_;
     event_responders_.clear();
+    gesture_arena_.Clear();
+    ++number_of_responder_chain_updates_;
   } else if (widget->IsHidden()) {
     return false;
   }
@@ -451,11 +1016,81 @@ bool WidgetView::UpdateEventResponders(const Point location, Widget* widget) {
 
   if (widget->ShouldHandleEvent(location)) {
     event_responders_.push_back(widget);
+    for (GestureRecognizer* recognizer : widget->gesture_recognizers_) {
+      if (recognizer->is_enabled())
+        gesture_arena_.Add(recognizer);
+    }
     return true;
   }
   return result;
 }
 
+void WidgetView::UpdateHoveredWidget(const Point location,
+                                     const double timestamp) {
+  hover_location_ = location;
+  is_hovering_ = true;
+  if (hover_region_is_valid_ &&
+      location.x >= hover_region_minimum_.x &&
+      location.y >= hover_region_minimum_.y &&
+      location.x < hover_region_maximum_.x &&
+      location.y < hover_region_maximum_.y) {
+    return;
+  }
+  hover_region_minimum_ = {0, 0};
+  hover_region_maximum_ = {GetWidth(), GetHeight()};
+  Widget* widget = FindHoveredWidget(location, root_widget_,
+                                     &hover_region_minimum_,
+                                     &hover_region_maximum_);
+  hover_region_is_valid_ = true;
+  ++number_of_hover_tests_;
+  SetHoveredWidget(widget, location, timestamp);
+}
+
+// Widget items are visited in the rendering order, so descendants of a layer
+// always follow the layer. Layers are never nested. Promoting a widget
+// demotes the layers among its descendants.
+void WidgetView::UpdateLayers(const WidgetList& widget_list) {
+  int layer_level = -1;
+  for (WidgetItem* item : widget_list) {
+    Widget* widget = item->widget;
+    const float kDidChange = widget->subtree_did_change_ ? 1 : 0;
+    widget->subtree_did_change_ = false;
+    widget->layer_change_frequency_ += \
+        (kDidChange - widget->layer_change_frequency_) * kLayerStatisticsWeight;
+    if (widget->number_of_observed_frames_ < kMinimumObservedFrames)
+      ++widget->number_of_observed_frames_;
+    // The rendering cost is unknown if composited from an up-to-date layer.
+    if (item->layer_item == nullptr || !item->layer_item->composites_layer ||
+        item->rasterizes_layer) {
+      widget->layer_rendering_cost_ += \
+          (item->rendering_cost - widget->layer_rendering_cost_) *
+          kLayerStatisticsWeight;
+    }
+    if (item->level == 0)
+      continue;
+
+    if (layer_level >= 0 && item->level <= layer_level)
+      layer_level = -1;
+    if (layer_level >= 0) {
+      DemoteLayer(widget);
+    } else if (widget->is_layer_) {
+      if (!widget->prefers_layer_ &&
+          widget->layer_change_frequency_ > kMaximumLayerChangeFrequency) {
+        DemoteLayer(widget);
+      } else {
+        layer_level = item->level;
+      }
+    } else if (layer_memory_budget_ > 0 &&
+               widget->number_of_observed_frames_ >= kMinimumObservedFrames &&
+               widget->layer_change_frequency_ <=
+                   kMaximumPromotionChangeFrequency &&
+               widget->layer_rendering_cost_ >= kMinimumLayerRenderingCost &&
+               !widget->IsAnimating() && PromoteLayer(widget)) {
+      layer_level = item->level;
+    }
+  }
+}
+
 void WidgetView::WidgetViewDidRender(Widget* widget) {
   NVGcontext* context = this->context();
   widget->WidgetViewDidRender(context);
@@ -486,4 +1121,18 @@ NVGcontext* WidgetView::context() {
   return context_;
 }
 
+void WidgetView::set_predicts_touches(const bool value) {
+  predicts_touches_ = value;
+  if (!value) {
+    for (PointerPredictor& touch_predictor : touch_predictors_)
+      ReleaseTouchPredictor(&touch_predictor);
+  }
+}
+
+void WidgetView::set_layer_memory_budget(const int layer_memory_budget) {
+  layer_memory_budget_ = std::max(0, layer_memory_budget);
+  while (!layers_.empty() && GetLayerMemoryUsage() > layer_memory_budget_)
+    DemoteLayer(layers_.back());
+}
+
 }  // namespace moui
@@ -24,25 +24,103 @@
 
 #include "moui/base.h"
 #include "moui/core/event.h"
+#include "moui/core/latency_histogram.h"
+#include "moui/core/touch_predictor.h"
 #include "moui/nanovg_hook.h"
 #include "moui/ui/view.h"
+#include "moui/widgets/gesture_arena.h"
+#include "moui/widgets/raster_atlas.h"
 
 namespace moui {
 
+class GestureRecognizer;
+class InputRecording;
 class Widget;
 
 // The WidgetView class is designed specifically for rendering Widget instances.
 // It sets up the nanovg context for rendering widgets, and comes with a
 // managed widget as the root widget. All other widgets should be added to the
 // managed widget for rendering.
+//
+// The widget view also keeps track of how often each visible widget's subtree
+// changes and how long it takes to render. Subtrees that are expensive to
+// render but rarely change are promoted to layers automatically, which means
+// they are rendered once in a framebuffer and composited as a whole until
+// something in them changes. Layers that turn out to change frequently are
+// demoted again. The total memory taken by layers is bounded by
+// `layer_memory_budget()`.
+//
+// If `predicts_touches()` is `true`, each pointer event carries the locations
+// its pointers are predicted to reach `touch_prediction_interval()` seconds
+// after the event is dispatched, which is when the resulting frame is
+// expected to be presented.
+//
+// The responder chain of a touch sequence is resolved once by hit testing
+// the widget tree when the sequence is about to begin, and stays frozen until
+// the sequence ends. Later events of the sequence are passed along the frozen
+// chain without walking the tree again. Widgets removed from the chain in the
+// middle of a sequence by `RemoveResponder()` simply stop receiving events.
+//
+// Scroll events are passed to the innermost widget under the cursor whose
+// `Widget::ShouldHandleScrollEvent()` returns `true` for the scroll delta,
+// such as a scroll view with content larger than itself along the dominant
+// axis of the delta. The target is resolved by walking the widget tree along
+// the cursor and then latched, so the following events of a trackpad
+// gesture, including its momentum, and wheel steps arriving in quick
+// succession over the same target are delivered without walking the tree
+// again. A trackpad gesture stays latched to its target once the target
+// received a nonzero delta.
+//
+// Hover events are passed to the innermost widget under the cursor whose
+// `Widget::tracks_hover()` is `true`. Hit testing for hover is incremental:
+// each test also determines a region around the cursor in which the hovered
+// widget cannot change, and the cursor moving within that region is passed
+// to the hovered widget right away. The region is discarded whenever the
+// widget tree changes, and tested again after the next refresh cycle so
+// widgets moving under a still cursor are hovered as well.
+//
+// All input received by the widget view is appended to `input_recording()`
+// if one is set, so it could be replayed later by `InputReplayer`.
+//
+// Each frame is tagged with the timestamp of the oldest event that requested
+// redrawing since the previous frame. The latencies from that timestamp to
+// when the frame starts rendering, when it is submitted, and when it is
+// displayed if the platform reports it, are accumulated in histograms.
 class WidgetView : public View {
  public:
+  // Describes a widget currently promoted to a layer.
+  struct LayerInfo {
+    // The widget whose subtree is rendered in the layer.
+    Widget* widget;
+    // The estimated number of bytes taken by the layer's framebuffer.
+    int bytes;
+    // How often the widget's subtree changes per refresh cycle, ranging from
+    // 0 to 1.
+    float change_frequency;
+    // The time in seconds it takes to render the widget's subtree without
+    // the layer.
+    double rendering_cost;
+    // Indicates whether the layer was visible in the last refresh cycle.
+    bool is_visible;
+  };
+
   explicit WidgetView(const int context_flags);
   WidgetView();
   ~WidgetView();
 
-  // Inherited from `View` class. Calls the `HandleMemoryWarning()` method on
-  // all managed widgets recursively.
+  // Inherited from `BaseView` class. Records the latency to present the
+  // latest frame tagged with an event.
+  void DidPresentFrame(const double timestamp) final;
+
+  // Returns the estimated number of bytes taken by all layers.
+  int GetLayerMemoryUsage() const;
+
+  // Populates `layers` with the widgets currently promoted to layers in the
+  // order they were promoted.
+  void GetLayers(std::vector<LayerInfo>* layers) const;
+
+  // Inherited from `View` class. Demotes all layers and calls the
+  // `HandleMemoryWarning()` method on all managed widgets recursively.
   void HandleMemoryWarning() final;
 
   // Inherited from `View` class.
@@ -52,12 +130,17 @@ class WidgetView : public View {
   void Redraw(Widget* widget);
 
   // Removes the specified widget from responder chain or do nothing if not
-  // exists in the chain.
+  // exists in the chain. The widget receives no more events of the current
+  // touch sequence, scroll events or hover events. It's safe to call this
+  // method while dispatching events.
   void RemoveResponder(Widget* widget);
 
   // Resets the context of manages widgets.
   void ResetContext();
 
+  // Removes all samples from the latency histograms.
+  void ResetLatencyHistograms();
+
   // Sets the bounds for the view and its managed widget.
   void SetBounds(const float x, const float y, const float width,
                  const float height) final;
@@ -67,14 +150,46 @@ class WidgetView : public View {
 
   // Accessors and setters.
   NVGcontext* context();
+  InputRecording* input_recording() const { return input_recording_; }
+  void set_input_recording(InputRecording* input_recording) {
+    input_recording_ = input_recording;
+  }
+  const LatencyHistogram* input_to_present_latency() const {
+    return &input_to_present_latency_;
+  }
+  const LatencyHistogram* input_to_render_latency() const {
+    return &input_to_render_latency_;
+  }
+  const LatencyHistogram* input_to_submit_latency() const {
+    return &input_to_submit_latency_;
+  }
   bool is_ready() const { return is_ready_; }
+  int layer_memory_budget() const { return layer_memory_budget_; }
+  void set_layer_memory_budget(const int layer_memory_budget);
+  int number_of_hover_tests() const { return number_of_hover_tests_; }
+  int number_of_responder_chain_updates() const {
+    return number_of_responder_chain_updates_;
+  }
+  int number_of_scroll_target_updates() const {
+    return number_of_scroll_target_updates_;
+  }
+  bool predicts_touches() const { return predicts_touches_; }
+  void set_predicts_touches(const bool value);
   Widget* root_widget() const { return root_widget_; }
   bool should_notify_context_change() const {
     return should_notify_context_change_;
   }
+  double touch_prediction_interval() const {
+    return touch_prediction_interval_;
+  }
+  void set_touch_prediction_interval(const double interval) {
+    touch_prediction_interval_ = interval;
+  }
 
  private:
-  // Allows `Widget::GetSnapshot()` to call the `Render()` method.
+  // Allows `Widget::GetSnapshot()` and `Widget::RenderToFramebuffer()` to call
+  // the `Render()` method, and widgets to invalidate the hover region when
+  // they change.
   friend class Widget;
 
   // A widget item is a wrapper for a widget object and keeps some information
@@ -107,15 +222,95 @@ class WidgetView : public View {
     float scissor_width;
     // The scissor's height in points of the widget.
     float scissor_height;
+    // The pointer to the widget item of the layer containing the widget, or
+    // `nullptr` if the widget is not in a layer. A layer's own widget item
+    // points to itself.
+    WidgetItem* layer_item;
+    // Indicates whether the widget is a layer that is composited from its
+    // framebuffer instead of rendering its subtree.
+    bool composites_layer;
+    // Indicates whether the widget is a layer rendered again in the current
+    // refresh cycle.
+    bool rasterizes_layer;
+    // The time in seconds taken to render the widget and its descendants in
+    // the current refresh cycle.
+    double rendering_cost;
   };
 
+  // A touch predictor and the pointer it is assigned to.
+  struct PointerPredictor {
+    // The identifier of the pointer.
+    int pointer_id;
+    // Indicates whether the predictor is assigned to `pointer_id`.
+    bool is_assigned;
+    // Indicates whether the pointer was listed in an up or cancel event.
+    // Platforms list every pointer in such events, including those still
+    // down, so the predictor is only kept if the pointer keeps moving.
+    bool is_lifted;
+    // The predictor estimating the locations of the pointer.
+    TouchPredictor predictor;
+  };
+
+  // The maximum number of pointers whose locations are predicted at a time.
+  static constexpr int kMaximumNumberOfPredictedPointers = 10;
+
   // Keeps a stack of widget items in the rendering hierarchy.
   typedef std::stack<WidgetItem*> WidgetItemStack;
 
   // Keeps a list of widget items to render in order.
   typedef std::vector<WidgetItem*> WidgetList;
 
-  // Inherited from `BaseView` class.
+  // Sends a `cancel` event to the effective responders other than the widget
+  // of the passed winner of `gesture_arena_`, which receives the rest of the
+  // touch sequence alone.
+  void CancelEventResponders(GestureRecognizer* winner);
+
+  // Demotes the specified layer and deletes its framebuffer. This method
+  // does nothing if the widget is not a layer.
+  void DemoteLayer(Widget* widget);
+
+  // Returns an event of the specified type and timestamp from
+  // `reusable_events_`, or a new one if there is none. The returned event
+  // should be passed to `RecycleEvent()` once it's no longer used.
+  Event* DequeueReusableEvent(const Event::Type type, const double timestamp);
+
+  // Passes the specified event to the event responders and their gesture
+  // recognizers in order.
+  void DispatchEvent(Event* event);
+
+  // Updates the hovered widget for the specified hover event and passes the
+  // event to it.
+  void DispatchHoverEvent(Event* event);
+
+  // Dispatches and recycles `pending_move_event_` if there is one.
+  void DispatchPendingMoveEvent();
+
+  // Passes the specified scroll event to `scroll_target_`, which is resolved
+  // again unless it's latched at the event's location.
+  void DispatchScrollEvent(Event* event);
+
+  // Returns the innermost widget under the passed location that tracks hover,
+  // or `nullptr` if there is none. The region specified by `region_minimum`
+  // and `region_maximum` is narrowed to where the returned widget stays the
+  // same. This is a recursive method, specify `root_widget_` for the `widget`
+  // parameter when calling it.
+  Widget* FindHoveredWidget(const Point location, Widget* widget,
+                            Point* region_minimum, Point* region_maximum);
+
+  // Returns the innermost widget under the passed location that accepts
+  // scroll events of the passed delta, or `nullptr` if there is none. This is
+  // a recursive method, specify `root_widget_` for the `widget` parameter
+  // when calling it.
+  Widget* FindScrollTarget(const Point location, const Point delta,
+                           Widget* widget);
+
+  // Returns the estimated number of bytes taken by the layer of the specified
+  // widget.
+  int GetLayerBytes(Widget* widget) const;
+
+  // Inherited from `BaseView` class. Move events are coalesced into
+  // `pending_move_event_` and dispatched at the beginning of the next refresh
+  // cycle. Other events are dispatched right away after any pending move.
   void HandleEvent(Event* event) final;
 
   // Calls the `HandleMemoryWarning()` method for the specified `widget` and
@@ -132,6 +327,23 @@ class WidgetView : public View {
                           WidgetList* widget_list, Widget* widget,
                           WidgetItem* parent_item);
 
+  // Feeds the samples of the passed event to `touch_predictors_` and
+  // populates the event's predicted locations.
+  void PredictTouches(Event* event);
+
+  // Promotes the specified widget to a layer if the memory budget allows.
+  // The layer is rendered in the next refresh cycle.
+  // Invisible layers are demoted to make room if necessary. Returns `false`
+  // if there is not enough memory.
+  bool PromoteLayer(Widget* widget);
+
+  // Keeps the passed event in `reusable_events_` for reuse.
+  void RecycleEvent(Event* event);
+
+  // Removes the samples of the passed predictor and unassigns it from its
+  // pointer. The storage of its samples is kept for later pointers.
+  void ReleaseTouchPredictor(PointerPredictor* touch_predictor);
+
   // Inherited from `BaseView` class. Renders belonged widgets recursively.
   bool Render() final;
 
@@ -142,22 +354,48 @@ class WidgetView : public View {
   // is set to `true`.
   bool Render(Widget* widget, NVGframebuffer* framebuffer);
 
+  // Returns `true` if `scroll_target_` keeps receiving scroll events of the
+  // passed delta at the passed location and timestamp without being resolved
+  // again.
+  bool ScrollTargetIsLatched(const Point location, const Point delta,
+                             const double timestamp) const;
+
+  // Sends a `kHoverLeave` event to the currently hovered widget and a
+  // `kHoverEnter` event to the specified `widget`, which could be `nullptr`,
+  // and makes it the hovered widget.
+  void SetHoveredWidget(Widget* widget, const Point location,
+                        const double timestamp);
+
   // Sets the specified `widget` and all of its descendants as invisible.
   void SetWidgetAndDescendantsInvisible(Widget* widget);
 
+  // Updates the layer statistics of the widgets in the passed list rendered
+  // in the current refresh cycle and promotes or demotes layers accordingly.
+  void UpdateLayers(const WidgetList& widget_list);
+
   // Sets child widgets' context recursively.
   void SetWidgetContextRecursively(Widget* widget, NVGcontext* oldContext,
                                    NVGcontext* newContext);
 
-  // Inherited from `BaseView` class.
+  // Inherited from `BaseView` class. Resolves the responder chain at the
+  // passed location unless the chain is frozen for an ongoing touch sequence.
   bool ShouldHandleEvent(const Point location) final;
 
+  // Inherited from `BaseView` class. Resolves the scroll target at the passed
+  // location unless the latched one is still effective.
+  bool ShouldHandleScrollEvent(const Point location, const Point delta) final;
+
   // Updates the `event_responders_` instance variable based on the passed
   // location. This is a recursive method, both the returned value and
   // the `widget` parameter are reserved for the recursion purpose.
   // When calling this method, specify `nullptr` for the `widget` parameter.
   bool UpdateEventResponders(const Point location, Widget* widget);
 
+  // Updates `hovered_widget_` for the cursor at the passed location. The
+  // widget tree is only walked if the cursor left the hover region or the
+  // region is no longer valid.
+  void UpdateHoveredWidget(const Point location, const double timestamp);
+
   // Calls the `Widget::WidgetViewDidRender()` method on the passed widget
   // and all of its descendant widgets recursively.
   void WidgetViewDidRender(Widget* widget);
@@ -172,34 +410,170 @@ class WidgetView : public View {
   // Indicates the flags to initialize the nanovg context.
   int context_flags_;
 
-  // Keeps a list of effective event responders.
+  // Keeps a list of effective event responders, which are the responders
+  // that received events of the current touch sequence and still expect the
+  // sequence to end. Responders that no longer expect the sequence to end are
+  // replaced by `nullptr` until the sequence ends.
   std::vector<Widget*> effective_event_responders_;
 
   // Keeps a list of widgets to handle events passed to the `HandleEvent()`
   // method. The list could be updated by `UpdateEventResponders()`.
+  // Responders removed by `RemoveResponder()` are replaced by `nullptr` so
+  // the list could be iterated while dispatching events.
   std::vector<Widget*> event_responders_;
 
+  // The number of refresh cycles rendered on screen so far.
+  int frame_number_;
+
+  // Resolves which gesture recognizer of the event responders wins the
+  // current touch sequence.
+  GestureArena gesture_arena_;
+
+  // The timestamp of the event being handled by `HandleEvent()`, or a
+  // negative value if no event is being handled.
+  double handling_event_timestamp_;
+
+  // The latest location of the cursor over the widget view.
+  Point hover_location_;
+
+  // Indicates whether the hover region is still valid. This value becomes
+  // `false` whenever the widget tree changes.
+  bool hover_region_is_valid_;
+
+  // The bottom right corner of the hover region, which is the region around
+  // the cursor in which `hovered_widget_` stays the same. The corner itself
+  // is excluded.
+  Point hover_region_maximum_;
+
+  // The top left corner of the hover region.
+  Point hover_region_minimum_;
+
+  // The weak reference to the widget under the cursor that receives hover
+  // events, or `nullptr` if there is none.
+  Widget* hovered_widget_;
+
+  // The weak reference to the recording the received input is appended to,
+  // or `nullptr` if the input is not recorded.
+  InputRecording* input_recording_;
+
+  // The latencies from the events tagging frames to when the frames are
+  // displayed as reported by `DidPresentFrame()`.
+  LatencyHistogram input_to_present_latency_;
+
+  // The latencies from the events tagging frames to when the frames start
+  // rendering.
+  LatencyHistogram input_to_render_latency_;
+
+  // The latencies from the events tagging frames to when the frames are
+  // submitted at the end of `Render()`.
+  LatencyHistogram input_to_submit_latency_;
+
+  // Indicates whether the cursor is over the widget view.
+  bool is_hovering_;
+
   // Indicates whether the widget view is ready to display.
   bool is_ready_;
 
+  // The maximum number of bytes taken by all layers. Setting this value to 0
+  // disables layers.
+  int layer_memory_budget_;
+
+  // Keeps the widgets currently promoted to layers in the order they were
+  // promoted.
+  std::vector<Widget*> layers_;
+
+  // The number of times `hovered_widget_` was resolved by walking the widget
+  // tree.
+  int number_of_hover_tests_;
+
+  // The number of times `event_responders_` was resolved by walking the
+  // widget tree. This value stays the same during a touch sequence.
+  int number_of_responder_chain_updates_;
+
+  // The number of times `scroll_target_` was resolved by walking the widget
+  // tree.
+  int number_of_scroll_target_updates_;
+
+  // The move event coalesced from all moves received since the last refresh
+  // cycle, or `nullptr` if there is none.
+  Event* pending_move_event_;
+
+  // Indicates whether pointer events carry predicted locations. The default
+  // value is `false`.
+  bool predicts_touches_;
+
+  // Reused by `PredictTouches()` to collect the samples of each pointer.
+  std::vector<Event::Sample> prediction_samples_;
+
   // Indicating whether the widget view is preparing for rendering in the
   // `Render()` method.
   bool preparing_for_rendering_;
 
+  // Packs the cached rendering results of small widgets into shared
+  // framebuffers.
+  RasterAtlas raster_atlas_;
+
+  // The weak reference to the layer currently being rendered in its
+  // framebuffer, or `nullptr` if there is none.
+  Widget* rasterizing_layer_;
+
   // Indicates whether receiving the redraw request while preparing for
   // rendering. The value is updated in the `Redraw()`. If this value and
   // `preparing_for_rendering_` are both true in the `Render()` method.
   // It won't start another round of the rendering process.
   bool requests_redraw_;
 
+  // Indicates whether `event_responders_` is frozen for the ongoing touch
+  // sequence. This value becomes `true` when the sequence touches down and
+  // `false` when it touches up or gets cancelled.
+  bool responder_chain_is_frozen_;
+
+  // Keeps a list of reusable `Event` instances, so dispatching events
+  // allocates no memory once enough events were created.
+  std::vector<Event*> reusable_events_;
+
   // Keeps a list of reusable `WidgetItem` instances.
   std::queue<WidgetItem*> reusable_widget_items_;
 
   // The root widget for rendering. All its children will be rendered as well.
   Widget* root_widget_;
 
+  // Indicates whether a trackpad scroll gesture, including its momentum, is
+  // ongoing. The latched scroll target receives the events of the gesture
+  // even if the cursor moved out of it.
+  bool scroll_gesture_is_ongoing_;
+
+  // The weak reference to the widget receiving scroll events, or `nullptr`
+  // if there is none.
+  Widget* scroll_target_;
+
+  // Indicates whether `scroll_target_` received a nonzero delta in the
+  // ongoing trackpad gesture. Until then, the gesture may still be passed to
+  // another target that accepts the direction of its deltas.
+  bool scroll_target_is_committed_;
+
+  // The timestamp of the latest scroll event passed to `scroll_target_`.
+  double scroll_target_timestamp_;
+
   bool should_notify_context_change_;
 
+  // The timestamp tagging the latest submitted frame until it is presented,
+  // or a negative value if there is none.
+  double submitted_event_timestamp_;
+
+  // The duration in seconds between dispatching an event and presenting the
+  // resulting frame, which is how far ahead touches are predicted. The
+  // default value is the duration of a refresh cycle at 60 Hz.
+  double touch_prediction_interval_;
+
+  // The predictors of the pointers in the current touch sequence. Pointers
+  // beyond the capacity are not predicted.
+  PointerPredictor touch_predictors_[kMaximumNumberOfPredictedPointers];
+
+  // The timestamp of the oldest event that requested redrawing since the
+  // latest frame started rendering, or a negative value if there is none.
+  double unrendered_event_timestamp_;
+
   // Keeps a list of currently visible widgets. The list will be updated
   // whenever executing the `Render()` method.
   std::vector<Widget*> visible_widgets_;
@@ -20,18 +20,31 @@
 
 #include "moui/widgets/activity_indicator_view.h"
 #include "moui/widgets/button.h"
+#include "moui/widgets/cell_snapshot_cache.h"
+#include "moui/widgets/collection_view.h"
+#include "moui/widgets/collection_view_flow_layout.h"
 #include "moui/widgets/control.h"
+#include "moui/widgets/gesture_arena.h"
+#include "moui/widgets/gesture_recognizer.h"
 #include "moui/widgets/grid_layout.h"
+#include "moui/widgets/input_replayer.h"
 #include "moui/widgets/label.h"
 #include "moui/widgets/layout.h"
 #include "moui/widgets/linear_layout.h"
+#include "moui/widgets/long_press_gesture_recognizer.h"
 #include "moui/widgets/page_control.h"
+#include "moui/widgets/pan_gesture_recognizer.h"
+#include "moui/widgets/pinch_gesture_recognizer.h"
 #include "moui/widgets/progress_view.h"
+#include "moui/widgets/raster_atlas.h"
+#include "moui/widgets/reusable_cell_pool.h"
 #include "moui/widgets/scroll_view.h"
 #include "moui/widgets/scroller.h"
 #include "moui/widgets/switch.h"
 #include "moui/widgets/table_view.h"
 #include "moui/widgets/table_view_cell.h"
+#include "moui/widgets/table_view_index_bar.h"
+#include "moui/widgets/tap_gesture_recognizer.h"
 #include "moui/widgets/widget.h"
 #include "moui/widgets/widget_view.h"
 